@@ -0,0 +1,92 @@
+#include "BenchmarkOptions.h"
+#include <thread>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+BenchmarkOptions::BenchmarkOptions(void) {
+	int sizes[] = {128, 256, 512, 1024};
+	Sizes.assign(sizes, sizes + sizeof(sizes)/sizeof(sizes[0]));
+	Threads.push_back(1);
+	int hardwareThreads = (int)std::thread::hardware_concurrency();
+	if (hardwareThreads > 1) {
+		Threads.push_back(hardwareThreads);
+	}
+	MinSeconds = 0.2;
+	MinCalls = 5;
+	WarmupCalls = 2;
+	Samples = 256;
+	PackageSize = 16;
+	Epochs = 2;
+}
+
+bool BenchmarkOptions::Parse(int argc, char **argv) {
+	for (int i = 1; i < argc; i++) {
+		const char *name = argv[i];
+		if ((i + 1 >= argc) || (strncmp(name, "--", 2) != 0)) {
+			return false;
+		}
+		const char *value = argv[++i];
+		if (strcmp(name, "--sizes") == 0) {
+			if (!ParseList(value, Sizes)) {
+				return false;
+			}
+		}
+		else if (strcmp(name, "--threads") == 0) {
+			if (!ParseList(value, Threads)) {
+				return false;
+			}
+		}
+		else if (strcmp(name, "--min-time") == 0) {
+			MinSeconds = atof(value);
+		}
+		else if (strcmp(name, "--min-calls") == 0) {
+			MinCalls = atoi(value);
+		}
+		else if (strcmp(name, "--warmup") == 0) {
+			WarmupCalls = atoi(value);
+		}
+		else if (strcmp(name, "--samples") == 0) {
+			Samples = atoi(value);
+		}
+		else if (strcmp(name, "--package") == 0) {
+			PackageSize = atoi(value);
+		}
+		else if (strcmp(name, "--epochs") == 0) {
+			Epochs = atoi(value);
+		}
+		else if (strcmp(name, "--calibrate") == 0) {
+			CalibrationFile = value;
+		}
+		else if (strcmp(name, "--thresholds") == 0) {
+			ThresholdsFile = value;
+		}
+		else {
+			return false;
+		}
+	}
+	return (Samples > 0) && (PackageSize > 0) && (PackageSize <= Samples) && (Epochs > 0) && (MinCalls > 0);
+}
+
+void BenchmarkOptions::PrintUsage(const char *programName) const {
+	printf("Usage: %s [--sizes 128,256,...] [--threads 1,4,...] [--min-time seconds] [--min-calls count]\n"
+		"       [--warmup count] [--samples count] [--package size] [--epochs count]\n"
+		"       [--calibrate thresholds-file] [--thresholds thresholds-file]\n", programName);
+}
+
+bool BenchmarkOptions::ParseList(const char *text, std::vector<int> &values) {
+	values.clear();
+	while (*text != 0) {
+		char *end;
+		long value = strtol(text, &end, 10);
+		if ((end == text) || (value <= 0)) {
+			return false;
+		}
+		values.push_back((int)value);
+		text = (*end == ',') ? end + 1 : end;
+		if ((*end != ',') && (*end != 0)) {
+			return false;
+		}
+	}
+	return !values.empty();
+}
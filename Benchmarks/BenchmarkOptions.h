@@ -0,0 +1,26 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+struct BenchmarkOptions {
+public:
+	std::vector<int> Sizes;
+	std::vector<int> Threads;
+	double MinSeconds;
+	int MinCalls;
+	int WarmupCalls;
+	int Samples;
+	int PackageSize;
+	int Epochs;
+	// Dispatch thresholds are measured and saved into CalibrationFile instead of benchmarking when it is set,
+	// and loaded from ThresholdsFile before benchmarking when that is set.
+	std::string CalibrationFile;
+	std::string ThresholdsFile;
+
+	BenchmarkOptions(void);
+	bool Parse(int argc, char **argv);
+	void PrintUsage(const char *programName) const;
+private:
+	static bool ParseList(const char *text, std::vector<int> &values);
+};
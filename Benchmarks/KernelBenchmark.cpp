@@ -0,0 +1,468 @@
+#include "BenchmarkOptions.h"
+#include "TrainingTelemetry.h"
+#include "TrainPair.h"
+#include "TrainSingle.h"
+#include "RandomAccessIterator.h"
+#include "HalfSquaredEuclidianDistance.h"
+#include "ExecutionContext.h"
+#include "SimpleNeuronBlock.h"
+#include "SoftmaxNeuronBlock.h"
+#include "SigmoidFunction.h"
+#include "SoftmaxFunction.h"
+#include "MultyLayerPerceptronFactory.h"
+#include "BackPropagationAlgorithm.h"
+#include "NoRegularization.h"
+#include "ConstantFactor.h"
+#include "BinaryBinaryRbm.h"
+#include "PhiloxRandom.h"
+#include "RbmGradients.h"
+#include "LinearGradient.h"
+#include "CenteredGradient.h"
+#include "EnhancedGradient.h"
+#include "ParallelDispatch.h"
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <random>
+#include <vector>
+#include <cstdio>
+
+using namespace NeuralNetNative;
+using namespace NeuralNetNative::MultyLayerPerceptron;
+using namespace NeuralNetNative::RestrictedBoltzmannMachine;
+using namespace StandardTypesNative;
+
+namespace {
+	struct KernelCost {
+	public:
+		double Flops;
+		double Bytes;
+	};
+
+	struct BenchmarkResult {
+	public:
+		long long Calls;
+		double Seconds;
+	};
+
+	std::mt19937 RandomGenerator(12345);
+
+	void FillRandom(float *data, size_t count, float low, float high) {
+		std::uniform_real_distribution<float> distribution(low, high);
+		for (size_t i = 0; i < count; i++) {
+			data[i] = distribution(RandomGenerator);
+		}
+	}
+
+	void FillBinary(float *data, size_t count) {
+		std::bernoulli_distribution distribution(0.5);
+		for (size_t i = 0; i < count; i++) {
+			data[i] = distribution(RandomGenerator) ? 1.0f : 0.0f;
+		}
+	}
+
+	BenchmarkResult Measure(const BenchmarkOptions &options, ExecutionContext *context, const std::function<void(void)> &kernel) {
+		BenchmarkResult result;
+		result.Calls = 0;
+		result.Seconds = 0.0;
+		context->Execute([&]() {
+			for (int i = 0; i < options.WarmupCalls; i++) {
+				kernel();
+			}
+			double start = TrainingTelemetry::Now();
+			do {
+				kernel();
+				result.Calls++;
+				result.Seconds = TrainingTelemetry::Now() - start;
+			} while ((result.Seconds < options.MinSeconds) || (result.Calls < options.MinCalls));
+		});
+		return result;
+	}
+
+	void PrintHeader(void) {
+		printf("%-48s %8s %8s %10s %12s %10s %10s\n", "kernel", "size", "threads", "calls", "us/call", "GFLOP/s", "GB/s");
+	}
+
+	void PrintResult(const char *kernel, int size, int threads, long long calls, double seconds, const KernelCost &costPerCall) {
+		double secondsPerCall = (calls > 0) ? seconds/calls : 0.0;
+		double gflops = (seconds > 0.0) ? costPerCall.Flops*calls/seconds*1e-9 : 0.0;
+		double gbytes = (seconds > 0.0) ? costPerCall.Bytes*calls/seconds*1e-9 : 0.0;
+		printf("%-48s %8d %8d %10lld %12.3f %10.3f %10.3f\n", kernel, size, threads, calls, secondsPerCall*1e6, gflops, gbytes);
+		fflush(stdout);
+	}
+
+	void Report(const char *kernel, int size, int threads, const BenchmarkResult &result, const KernelCost &costPerCall) {
+		PrintResult(kernel, size, threads, result.Calls, result.Seconds, costPerCall);
+	}
+
+	void BenchmarkNeuronBlocks(const BenchmarkOptions &options, ExecutionContext *context, int size) {
+		int threads = context->GetConcurrency();
+		std::vector<float> input(size);
+		FillRandom(&input[0], size, 0.0f, 1.0f);
+		double weightsCount = (double)size*size;
+		KernelCost cost = {2.0*weightsCount, sizeof(float)*weightsCount};
+
+		SigmoidFunction sigmoid(1.0f);
+		SimpleNeuronBlock simpleBlock(size, size, &sigmoid);
+		FillRandom(simpleBlock.GetWeights(), (size_t)size*size, -0.1f, 0.1f);
+		FillRandom(simpleBlock.GetBias(), size, -0.1f, 0.1f);
+		Report("SimpleNeuronBlock::Calculate", size, threads,
+			Measure(options, context, [&]() { simpleBlock.Calculate(&input[0]); }), cost);
+
+		SoftmaxFunction softmax;
+		SoftmaxSimpleNeuronBlock softmaxBlock(size, size, &softmax);
+		FillRandom(softmaxBlock.GetWeights(), (size_t)size*size, -0.1f, 0.1f);
+		FillRandom(softmaxBlock.GetBias(), size, -0.1f, 0.1f);
+		Report("SoftmaxSimpleNeuronBlock::Calculate", size, threads,
+			Measure(options, context, [&]() { softmaxBlock.Calculate(&input[0]); }), cost);
+	}
+
+#if NNETS_TELEMETRY
+	class EpochStatsCollector : public IEpochStatsCallback {
+	public:
+		EpochStats Total;
+		int EpochsCount;
+
+		EpochStatsCollector(void) {
+			EpochsCount = 0;
+			Total = EpochStats();
+		}
+
+		virtual void Invoke(const EpochStats &stats) {
+			if (stats.EpochNum <= 1) {
+				return;
+			}
+			EpochsCount++;
+			Total.SamplesCount += stats.SamplesCount;
+			for (int phase = 0; phase < TrainingPhasesCount; phase++) {
+				Total.Phases[phase].Seconds += stats.Phases[phase].Seconds;
+				Total.Phases[phase].Flops += stats.Phases[phase].Flops;
+				Total.Phases[phase].Bytes += stats.Phases[phase].Bytes;
+			}
+		}
+	};
+
+	void ReportPhases(const char *kernel, int size, int threads, const EpochStats &stats, long long calls,
+		TrainingPhase firstPhase, TrainingPhase lastPhase) {
+		double seconds = 0.0;
+		KernelCost total = {0.0, 0.0};
+		for (int phase = firstPhase; phase <= lastPhase; phase++) {
+			seconds += stats.Phases[phase].Seconds;
+			total.Flops += stats.Phases[phase].Flops;
+			total.Bytes += stats.Phases[phase].Bytes;
+		}
+		KernelCost costPerCall = {(calls > 0) ? total.Flops/calls : 0.0, (calls > 0) ? total.Bytes/calls : 0.0};
+		PrintResult(kernel, size, threads, calls, seconds, costPerCall);
+	}
+#endif
+
+	void BenchmarkBackPropagation(const BenchmarkOptions &options, ExecutionContext *context, int size) {
+#if NNETS_TELEMETRY
+		int threads = context->GetConcurrency();
+		int samplesCount = options.Samples;
+		std::vector<TrainPair*> trainData(samplesCount);
+		for (int i = 0; i < samplesCount; i++) {
+			float *input = new float[size];
+			float *output = new float[size];
+			FillRandom(input, size, 0.0f, 1.0f);
+			FillRandom(output, size, 0.0f, 1.0f);
+			trainData[i] = new TrainPair(input, output, size, size);
+		}
+
+		SigmoidFunction sigmoid(1.0f);
+		int layersStruct[2] = {size, size};
+		MultyLayerPerceptronFactory factory(size, 2, layersStruct, &sigmoid, &sigmoid, UniformDistribution);
+		NeuralNet *neuralNet = factory.CreateNeuralNet();
+
+		HalfSquaredEuclidianDistance metrics;
+		NoRegularization regularization;
+		ConstantFactor factorStrategy(1.0f);
+		TrainProperties properties;
+		properties.Metrics = &metrics;
+		properties.Regularization = &regularization;
+		properties.Epsilon = 0.0f;
+		properties.MaxIterationCount = options.Epochs + 1;
+		properties.PackageSize = options.PackageSize;
+		properties.CvLimit = 0.0f;
+		properties.SkipCvLimitFirstIterations = 0;
+		properties.CvSlidingFactor = 1.0f;
+		properties.AsyncTesting = false;
+		properties.BatchTraining = false;
+		properties.PersistentChainsCount = 0;
+		properties.FreeEnergyTrainSamples = 0;
+		properties.PackedStates = false;
+		properties.WeightsPlacement = LocalNode;
+		properties.WeightReplicas = false;
+		properties.Context = context;
+		properties.BaseLearnSpeed = 0.01f;
+		properties.SpeedBonus = 1.05f;
+		properties.SpeedPenalty = 0.95f;
+		properties.SpeedLowBorder = 0.01f;
+		properties.SpeedUpBorder = 10.0f;
+		properties.FactorStrategy = &factorStrategy;
+		properties.AddedFactorStrategy = &factorStrategy;
+		properties.AverageLearnFactor = 0.9f;
+		properties.Momentum = 0.9f;
+
+		EpochStatsCollector collector;
+		BackPropagationAlgorithm *algorithm = new BackPropagationAlgorithm(&trainData[0], samplesCount);
+		algorithm->EpochStatsCompleted = &collector;
+		algorithm->InitilazeMethod(neuralNet, &properties);
+		algorithm->Start();
+
+		long long packagesCount = (long long)collector.EpochsCount*(samplesCount/options.PackageSize);
+		ReportPhases("BPA::CollectWeightsDeltaOfLayer", size, threads, collector.Total, collector.Total.SamplesCount,
+			BackwardPhase, GradientPhase);
+		ReportPhases("BPA::ModifyWeightsOfNeuronNet", size, threads, collector.Total, packagesCount,
+			UpdatePhase, UpdatePhase);
+
+		delete algorithm;
+		delete neuralNet;
+		for (int i = 0; i < samplesCount; i++) {
+			delete trainData[i];
+		}
+#endif
+	}
+
+	void BenchmarkRbmLayers(const BenchmarkOptions &options, ExecutionContext *context, int size) {
+		int threads = context->GetConcurrency();
+		BinaryBinaryRbm rbm(size, size);
+		FillRandom(rbm.GetWeights(), (size_t)size*size, -0.1f, 0.1f);
+		FillBinary(rbm.GetVisibleStates(), size);
+		FillBinary(rbm.GetHiddenStates(), size);
+		double weightsCount = (double)size*size;
+		KernelCost cost = {2.0*weightsCount, sizeof(float)*weightsCount};
+
+		Report("BinaryBinaryRbm::HiddenLayerActivity", size, threads,
+			Measure(options, context, [&]() { rbm.HiddenLayerCalculateActivity(); }), cost);
+		Report("BinaryBinaryRbm::VisibleLayerActivity", size, threads,
+			Measure(options, context, [&]() { rbm.VisibleLayerCalculateActivity(); }), cost);
+
+		int packageSize = options.PackageSize;
+		std::vector<float> visibleStatesBatch((size_t)packageSize*size);
+		std::vector<float> hiddenStatesBatch((size_t)packageSize*size);
+		FillBinary(&visibleStatesBatch[0], visibleStatesBatch.size());
+		FillBinary(&hiddenStatesBatch[0], hiddenStatesBatch.size());
+		KernelCost batchCost = {2.0*weightsCount*packageSize, sizeof(float)*(weightsCount + 2.0*packageSize*size)};
+
+		Report("BinaryBinaryRbm::HiddenLayerActivity(batch)", size, threads, Measure(options, context, [&]() {
+			rbm.HiddenLayerCalculateActivity(&visibleStatesBatch[0], &hiddenStatesBatch[0], packageSize);
+		}), batchCost);
+		Report("BinaryBinaryRbm::VisibleLayerActivity(batch)", size, threads, Measure(options, context, [&]() {
+			rbm.VisibleLayerCalculateActivity(&hiddenStatesBatch[0], &visibleStatesBatch[0], packageSize);
+		}), batchCost);
+
+		rbm.EnableTransposedWeights(true);
+		KernelCost transposeCost = {0.0, 2*sizeof(float)*weightsCount};
+		Report("BinaryBinaryRbm::RefreshTransposedWeights", size, threads,
+			Measure(options, context, [&]() { rbm.RefreshTransposedWeights(); }), transposeCost);
+		Report("BinaryBinaryRbm::VisibleLayerActivity(transposed)", size, threads,
+			Measure(options, context, [&]() { rbm.VisibleLayerCalculateActivity(); }), cost);
+		Report("BinaryBinaryRbm::HiddenLayerActivity(batch,transposed)", size, threads, Measure(options, context, [&]() {
+			rbm.HiddenLayerCalculateActivity(&visibleStatesBatch[0], &hiddenStatesBatch[0], packageSize);
+		}), batchCost);
+	}
+
+	void BenchmarkSampling(const BenchmarkOptions &options, ExecutionContext *context, int size) {
+		int threads = context->GetConcurrency();
+		int count = options.PackageSize*size;
+		std::vector<float> states(count);
+		PhiloxRandom random(12345, 0);
+		KernelCost cost = {0.0, sizeof(float)*(double)count};
+
+		Report("PhiloxRandom::FillUniform", size, threads,
+			Measure(options, context, [&]() { random.FillUniform(&states[0], count); }), cost);
+		Report("PhiloxRandom::Bernoulli", size, threads, Measure(options, context, [&]() {
+			std::fill(states.begin(), states.end(), 0.5f);
+			random.Bernoulli(&states[0], count);
+		}), cost);
+		Report("PhiloxRandom::AddNormal", size, threads,
+			Measure(options, context, [&]() { random.AddNormal(&states[0], count); }), cost);
+	}
+
+	void BenchmarkGradient(const BenchmarkOptions &options, ExecutionContext *context, int size, const char *kernel,
+		const char *batchKernel, GradientFunction *gradientFunction) {
+		int threads = context->GetConcurrency();
+		int packageSize = options.PackageSize;
+		RbmGradients gradients(size, size);
+		gradientFunction->Initialize(&gradients);
+
+		std::vector<float> visibleStates((size_t)packageSize*size);
+		std::vector<float> hiddenStates((size_t)packageSize*size);
+		FillBinary(&visibleStates[0], visibleStates.size());
+		FillRandom(&hiddenStates[0], hiddenStates.size(), 0.0f, 1.0f);
+		double weightsCount = (double)size*size;
+		KernelCost cost = {4.0*weightsCount*packageSize, 4*sizeof(float)*weightsCount*packageSize};
+
+		Report(kernel, size, threads, Measure(options, context, [&]() {
+			gradientFunction->PrepareToNextPackage(packageSize);
+			for (int i = 0; i < packageSize; i++) {
+				gradientFunction->StorePositivePhaseData(&visibleStates[(size_t)i*size], &hiddenStates[(size_t)i*size]);
+				gradientFunction->StoreNegativePhaseData(&visibleStates[(size_t)i*size], &hiddenStates[(size_t)i*size]);
+			}
+		}), cost);
+
+		KernelCost batchCost = {4.0*weightsCount*packageSize, 4*sizeof(float)*(weightsCount + 2.0*packageSize*size)};
+		Report(batchKernel, size, threads, Measure(options, context, [&]() {
+			gradientFunction->PrepareToNextPackage(packageSize);
+			gradientFunction->StorePositivePhaseBatch(&visibleStates[0], &hiddenStates[0], packageSize);
+			gradientFunction->StoreNegativePhaseBatch(&visibleStates[0], &hiddenStates[0], packageSize, 1.0f);
+		}), batchCost);
+	}
+
+	// The largest difference of the per-sample and batched EnhancedGradient from the formula of the managed
+	// EnhancedGradient, computed in double precision for one package.
+	void CheckEnhancedGradient(const BenchmarkOptions &options, ExecutionContext *context, int size) {
+		int packageSize = options.PackageSize;
+		int visibleStatesCount = size, hiddenStatesCount = (size + 1)/2;
+		std::vector<float> dataVisible((size_t)packageSize*visibleStatesCount), modelVisible(dataVisible.size());
+		std::vector<float> dataHidden((size_t)packageSize*hiddenStatesCount), modelHidden(dataHidden.size());
+		FillBinary(&dataVisible[0], dataVisible.size());
+		FillRandom(&modelVisible[0], modelVisible.size(), 0.0f, 1.0f);
+		FillRandom(&dataHidden[0], dataHidden.size(), 0.0f, 1.0f);
+		FillRandom(&modelHidden[0], modelHidden.size(), 0.0f, 1.0f);
+		double factor = 1.0/packageSize;
+
+		std::vector<double> dataVisibleSums(visibleStatesCount, 0.0), modelVisibleSums(visibleStatesCount, 0.0);
+		std::vector<double> dataHiddenSums(hiddenStatesCount, 0.0), modelHiddenSums(hiddenStatesCount, 0.0);
+		for (int p = 0; p < packageSize; p++) {
+			for (int i = 0; i < visibleStatesCount; i++) {
+				dataVisibleSums[i] += dataVisible[(size_t)p*visibleStatesCount + i];
+				modelVisibleSums[i] += modelVisible[(size_t)p*visibleStatesCount + i];
+			}
+			for (int j = 0; j < hiddenStatesCount; j++) {
+				dataHiddenSums[j] += dataHidden[(size_t)p*hiddenStatesCount + j];
+				modelHiddenSums[j] += modelHidden[(size_t)p*hiddenStatesCount + j];
+			}
+		}
+		std::vector<double> weights((size_t)hiddenStatesCount*visibleStatesCount);
+		std::vector<double> visibleBias(visibleStatesCount), hiddenBias(hiddenStatesCount);
+		for (int j = 0; j < hiddenStatesCount; j++) {
+			double hiddenStateSumGradient = 0.0;
+			for (int i = 0; i < visibleStatesCount; i++) {
+				double dataProduct = 0.0, modelProduct = 0.0;
+				for (int p = 0; p < packageSize; p++) {
+					dataProduct += (double)dataVisible[(size_t)p*visibleStatesCount + i]*dataHidden[(size_t)p*hiddenStatesCount + j];
+					modelProduct += (double)modelVisible[(size_t)p*visibleStatesCount + i]*modelHidden[(size_t)p*hiddenStatesCount + j];
+				}
+				double weightGradient = factor*(dataProduct - factor*dataVisibleSums[i]*dataHiddenSums[j] -
+					modelProduct + factor*modelVisibleSums[i]*modelHiddenSums[j]);
+				hiddenStateSumGradient += 0.5*factor*(dataVisibleSums[i] + modelVisibleSums[i])*weightGradient;
+				weights[(size_t)j*visibleStatesCount + i] = weightGradient;
+			}
+			hiddenBias[j] = factor*(dataHiddenSums[j] - modelHiddenSums[j]) - hiddenStateSumGradient;
+		}
+		for (int i = 0; i < visibleStatesCount; i++) {
+			double dif = 0.0;
+			for (int j = 0; j < hiddenStatesCount; j++) {
+				dif += 0.5*factor*(dataHiddenSums[j] + modelHiddenSums[j])*weights[(size_t)j*visibleStatesCount + i];
+			}
+			visibleBias[i] = factor*(dataVisibleSums[i] - modelVisibleSums[i]) - dif;
+		}
+
+		for (int batch = 0; batch < 2; batch++) {
+			RbmGradients gradients(visibleStatesCount, hiddenStatesCount);
+			EnhancedGradient enhancedGradient;
+			enhancedGradient.Initialize(&gradients);
+			context->Execute([&]() {
+				enhancedGradient.PrepareToNextPackage(packageSize);
+				if (batch != 0) {
+					enhancedGradient.StorePositivePhaseBatch(&dataVisible[0], &dataHidden[0], packageSize);
+					enhancedGradient.StoreNegativePhaseBatch(&modelVisible[0], &modelHidden[0], packageSize, 1.0f);
+				}
+				else {
+					for (int p = 0; p < packageSize; p++) {
+						enhancedGradient.StorePositivePhaseData(&dataVisible[(size_t)p*visibleStatesCount], &dataHidden[(size_t)p*hiddenStatesCount]);
+						enhancedGradient.StoreNegativePhaseData(&modelVisible[(size_t)p*visibleStatesCount], &modelHidden[(size_t)p*hiddenStatesCount]);
+					}
+				}
+				enhancedGradient.MakeGradient((float)factor);
+			});
+			double maxError = 0.0;
+			for (size_t w = 0; w < weights.size(); w++) {
+				maxError = std::max(maxError, fabs(gradients.GetPackageDerivativeForWeights()[w] - weights[w]));
+			}
+			for (int i = 0; i < visibleStatesCount; i++) {
+				maxError = std::max(maxError, fabs(gradients.GetPackageDerivativeForVisibleBias()[i] - visibleBias[i]));
+			}
+			for (int j = 0; j < hiddenStatesCount; j++) {
+				maxError = std::max(maxError, fabs(gradients.GetPackageDerivativeForHiddenBias()[j] - hiddenBias[j]));
+			}
+			printf("%-48s %8d %8d max error %g\n", (batch != 0) ? "EnhancedGradient::MakeGradient (batch) check" :
+				"EnhancedGradient::MakeGradient check", size, context->GetConcurrency(), maxError);
+		}
+		fflush(stdout);
+	}
+
+	void BenchmarkGradients(const BenchmarkOptions &options, ExecutionContext *context, int size) {
+		LinearGradient linearGradient;
+		BenchmarkGradient(options, context, size, "LinearGradient::Store*PhaseData",
+			"LinearGradient::Store*PhaseBatch", &linearGradient);
+
+		std::vector<float> offsets(size, 0.5f);
+		CenteredGradient centeredGradient(0.01f, &offsets[0], size, &offsets[0], size);
+		BenchmarkGradient(options, context, size, "CenteredGradient::Store*PhaseData",
+			"CenteredGradient::Store*PhaseBatch", &centeredGradient);
+
+		EnhancedGradient enhancedGradient;
+		BenchmarkGradient(options, context, size, "EnhancedGradient::Store*PhaseData",
+			"EnhancedGradient::Store*PhaseBatch", &enhancedGradient);
+		CheckEnhancedGradient(options, context, size);
+	}
+
+	void BenchmarkRandomAccessIterator(const BenchmarkOptions &options, ExecutionContext *context, int size) {
+		int threads = context->GetConcurrency();
+		int samplesCount = options.Samples*size/16;
+		std::vector<TrainSingle*> samples(samplesCount, (TrainSingle*)0);
+		RandomAccessIterator<TrainSingle*> iterator(&samples[0], samplesCount);
+		KernelCost cost = {0.0, 2*sizeof(int)*(double)samplesCount};
+
+		Report("RandomAccessIterator::Refresh", samplesCount, threads,
+			Measure(options, context, [&]() { iterator.RefreshRandomAccess(); }), cost);
+	}
+
+	// Measures the dispatch thresholds with the largest thread count, which is the one the training runs with.
+	int CalibrateDispatch(const BenchmarkOptions &options) {
+		ExecutionContext context(*std::max_element(options.Threads.begin(), options.Threads.end()), -1, -1);
+		DispatchThresholds thresholds;
+		context.Execute([&]() { thresholds = ParallelDispatch::Calibrate(); });
+		printf("threads=%d NsPerElement=%g NsPerByte=%g LaunchNs=%g TaskNs=%g TaskGranularity=%g\n",
+			context.GetConcurrency(), thresholds.NsPerElement, thresholds.NsPerByte, thresholds.LaunchNs,
+			thresholds.TaskNs, thresholds.TaskGranularity);
+		if (!ParallelDispatch::SaveThresholds(options.CalibrationFile.c_str())) {
+			fprintf(stderr, "Cannot write %s\n", options.CalibrationFile.c_str());
+			return 1;
+		}
+		return 0;
+	}
+}
+
+int main(int argc, char **argv) {
+	BenchmarkOptions options;
+	if (!options.Parse(argc, argv)) {
+		options.PrintUsage(argv[0]);
+		return 1;
+	}
+	if (!options.CalibrationFile.empty()) {
+		return CalibrateDispatch(options);
+	}
+	if (!options.ThresholdsFile.empty() && !ParallelDispatch::LoadThresholds(options.ThresholdsFile.c_str())) {
+		fprintf(stderr, "Cannot read %s\n", options.ThresholdsFile.c_str());
+		return 1;
+	}
+
+	PrintHeader();
+	for (size_t t = 0; t < options.Threads.size(); t++) {
+		ExecutionContext context(options.Threads[t], -1, -1);
+		for (size_t s = 0; s < options.Sizes.size(); s++) {
+			int size = options.Sizes[s];
+			BenchmarkNeuronBlocks(options, &context, size);
+			BenchmarkBackPropagation(options, &context, size);
+			BenchmarkRbmLayers(options, &context, size);
+			BenchmarkSampling(options, &context, size);
+			BenchmarkGradients(options, &context, size);
+			BenchmarkRandomAccessIterator(options, &context, size);
+		}
+	}
+	return 0;
+}
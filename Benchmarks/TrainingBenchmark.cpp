@@ -0,0 +1,1038 @@
+#include "TrainingTelemetry.h"
+#include "TrainPair.h"
+#include "TrainSingle.h"
+#include "RandomAccessIterator.h"
+#include "CrossEntropy.h"
+#include "HalfSquaredEuclidianDistance.h"
+#include "ExecutionContext.h"
+#include "HyperbolicTangensFunction.h"
+#include "SoftmaxFunction.h"
+#include "MultyLayerPerceptronFactory.h"
+#include "BackPropagationAlgorithm.h"
+#include "BinaryBinaryRbm.h"
+#include "LinearGradient.h"
+#include "CenteredGradient.h"
+#include "EnhancedGradient.h"
+#include "ContrastiveDivergence.h"
+#include "FastPersistentContrastiveDivergence.h"
+#include "ParallelTempering.h"
+#include "AnnealedImportanceSampling.h"
+#include "DeepBeliefNetwork.h"
+#include "FeatureExtractor.h"
+#include "ConditionalGibbsSampler.h"
+#include "MemoryMappedMatrix.h"
+#include "HybridTrainMethod.h"
+#include "EliminationRegularization.h"
+#include "L1Regularization.h"
+#include "ReverseFactor.h"
+#include "SqrtReverseFactor.h"
+#include "ConstantFactor.h"
+#include "SigmaComponentAnalysis.h"
+#include "MinMaxComponentAnalysis.h"
+#include "NormalizedInputTransform.h"
+#include "ParallelDispatch.h"
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+#ifdef _WIN32
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+
+using namespace NeuralNetNative;
+using namespace NeuralNetNative::MultyLayerPerceptron;
+using namespace NeuralNetNative::RestrictedBoltzmannMachine;
+using namespace StandardTypesNative;
+
+namespace {
+	const int ImageSize = 28;
+	const int InputLayerSize = ImageSize*ImageSize;
+	const int OutputLayerSize = 10;
+	const int HiddenLayer1Size = 500;
+	const int HiddenLayer2Size = 300;
+	const int FeatureBatchSize = 256;
+	const int RecoveryBatchSize = 100;
+	const int RecoveryChainsCount = 4;
+	const int RecoverySweepsCount = 20;
+	const int RecoveryBurnInSweepsCount = 5;
+
+	struct TrainingBenchmarkOptions {
+	public:
+		std::string Scenario;
+		std::string OutputFile;
+		std::string SpillDirectory;
+		std::string Normalization;
+		std::string Gradient;
+		std::string ThresholdsFile;
+		unsigned int Seed;
+		int TrainSamples;
+		int TestSamples;
+		int Epochs;
+		int Threads;
+		int RbmHiddenSize;
+		int CdSteps;
+		bool BatchTraining;
+		bool AsyncTesting;
+		bool TransposedWeights;
+		int PersistentChains;
+		int Temperatures;
+		int AisRuns;
+		int AisTemperatures;
+		int AisInterval;
+		int FreeEnergyTrainSamples;
+		bool PackedStates;
+		NumaPlacement WeightsPlacement;
+		bool WeightReplicas;
+		float BpaTargetError;
+		float RbmTargetError;
+
+		TrainingBenchmarkOptions(void) {
+			Scenario = "all";
+			Normalization = "none";
+			Gradient = "linear";
+			Seed = 12345;
+			TrainSamples = 2000;
+			TestSamples = 500;
+			Epochs = 5;
+			Threads = 0;
+			RbmHiddenSize = HiddenLayer1Size;
+			CdSteps = 1;
+			BatchTraining = false;
+			AsyncTesting = false;
+			TransposedWeights = false;
+			PersistentChains = 0;
+			Temperatures = 4;
+			AisRuns = 0;
+			AisTemperatures = 1000;
+			AisInterval = 1;
+			FreeEnergyTrainSamples = 0;
+			PackedStates = false;
+			WeightsPlacement = LocalNode;
+			WeightReplicas = false;
+			BpaTargetError = 0.1f;
+			RbmTargetError = 75.0f;
+		}
+
+		bool Parse(int argc, char **argv) {
+			for (int i = 1; i < argc; i++) {
+				const char *name = argv[i];
+				if ((i + 1 >= argc) || (strncmp(name, "--", 2) != 0)) {
+					return false;
+				}
+				const char *value = argv[++i];
+				if (strcmp(name, "--scenario") == 0) {
+					Scenario = value;
+				}
+				else if (strcmp(name, "--output") == 0) {
+					OutputFile = value;
+				}
+				else if (strcmp(name, "--seed") == 0) {
+					Seed = (unsigned int)strtoul(value, 0, 10);
+				}
+				else if (strcmp(name, "--train-samples") == 0) {
+					TrainSamples = atoi(value);
+				}
+				else if (strcmp(name, "--test-samples") == 0) {
+					TestSamples = atoi(value);
+				}
+				else if (strcmp(name, "--epochs") == 0) {
+					Epochs = atoi(value);
+				}
+				else if (strcmp(name, "--threads") == 0) {
+					Threads = atoi(value);
+				}
+				else if (strcmp(name, "--rbm-hidden") == 0) {
+					RbmHiddenSize = atoi(value);
+				}
+				else if (strcmp(name, "--cd-steps") == 0) {
+					CdSteps = atoi(value);
+				}
+				else if (strcmp(name, "--batch") == 0) {
+					BatchTraining = (atoi(value) != 0);
+				}
+				else if (strcmp(name, "--async") == 0) {
+					AsyncTesting = (atoi(value) != 0);
+				}
+				else if (strcmp(name, "--transposed") == 0) {
+					TransposedWeights = (atoi(value) != 0);
+				}
+				else if (strcmp(name, "--chains") == 0) {
+					PersistentChains = atoi(value);
+				}
+				else if (strcmp(name, "--temperatures") == 0) {
+					Temperatures = atoi(value);
+				}
+				else if (strcmp(name, "--ais-runs") == 0) {
+					AisRuns = atoi(value);
+				}
+				else if (strcmp(name, "--ais-temperatures") == 0) {
+					AisTemperatures = atoi(value);
+				}
+				else if (strcmp(name, "--ais-interval") == 0) {
+					AisInterval = atoi(value);
+				}
+				else if (strcmp(name, "--free-energy") == 0) {
+					FreeEnergyTrainSamples = atoi(value);
+				}
+				else if (strcmp(name, "--packed") == 0) {
+					PackedStates = (atoi(value) != 0);
+				}
+				else if (strcmp(name, "--placement") == 0) {
+					if (strcmp(value, "local") == 0) {
+						WeightsPlacement = LocalNode;
+					}
+					else if (strcmp(value, "interleaved") == 0) {
+						WeightsPlacement = Interleaved;
+					}
+					else if (strcmp(value, "rows") == 0) {
+						WeightsPlacement = PartitionedByRows;
+					}
+					else {
+						return false;
+					}
+				}
+				else if (strcmp(name, "--replicas") == 0) {
+					WeightReplicas = (atoi(value) != 0);
+				}
+				else if (strcmp(name, "--normalize") == 0) {
+					Normalization = value;
+				}
+				else if (strcmp(name, "--gradient") == 0) {
+					Gradient = value;
+				}
+				else if (strcmp(name, "--thresholds") == 0) {
+					ThresholdsFile = value;
+				}
+				else if (strcmp(name, "--spill-dir") == 0) {
+					SpillDirectory = value;
+				}
+				else if (strcmp(name, "--bpa-target") == 0) {
+					BpaTargetError = (float)atof(value);
+				}
+				else if (strcmp(name, "--rbm-target") == 0) {
+					RbmTargetError = (float)atof(value);
+				}
+				else {
+					return false;
+				}
+			}
+			return (Scenario == "all" || Scenario == "bpa" || Scenario == "cd" || Scenario == "fpcd" || Scenario == "pt" ||
+				 Scenario == "dbn" || Scenario == "crbm" || Scenario == "features" ||
+				 Scenario == "recover") &&
+				(Seed != 0) && (TrainSamples >= 50) && (TestSamples > 0) && (Epochs > 0) && (RbmHiddenSize > 0) && (CdSteps > 0) &&
+				(PersistentChains >= 0) && (Temperatures > 0) &&
+				(AisRuns >= 0) && (AisTemperatures > 1) && (AisInterval > 0) &&
+				(FreeEnergyTrainSamples >= 0) &&
+				(Normalization == "none" || Normalization == "sigma" || Normalization == "minmax") &&
+				(Gradient == "linear" || Gradient == "centered" || Gradient == "enhanced");
+		}
+
+		void PrintUsage(const char *programName) const {
+			fprintf(stderr, "Usage: %s [--scenario all|bpa|cd|fpcd|pt|dbn|crbm|features|recover] [--output file] [--seed n] [--train-samples n]\n"
+				"       [--test-samples n] [--epochs n] [--threads n] [--rbm-hidden n] [--cd-steps n]\n"
+				"       [--batch 0|1] [--async 0|1] [--transposed 0|1] [--chains n] [--temperatures n]\n"
+				"       [--ais-runs n] [--ais-temperatures n] [--ais-interval epochs] [--free-energy train-samples]\n"
+				"       [--packed 0|1] [--placement local|interleaved|rows] [--replicas 0|1] [--spill-dir directory]\n"
+				"       [--normalize none|sigma|minmax] [--gradient linear|centered|enhanced] [--thresholds file]\n"
+				"       [--bpa-target error] [--rbm-target error]\n",
+				programName);
+		}
+	};
+
+	// Binary 28x28 images sampled from one random stroke prototype per class, shifted by up to two pixels,
+	// with one-hot labels.
+	class SyntheticLetters {
+	private:
+		std::vector<float> _prototypes;
+		std::mt19937 _generator;
+	public:
+		SyntheticLetters(unsigned int seed) : _prototypes((size_t)OutputLayerSize*InputLayerSize, 0.0f), _generator(seed) {
+			std::uniform_int_distribution<int> position(4, ImageSize - 5);
+			std::uniform_int_distribution<int> direction(-1, 1);
+			for (int label = 0; label < OutputLayerSize; label++) {
+				float *prototype = &_prototypes[(size_t)label*InputLayerSize];
+				for (int stroke = 0; stroke < 3; stroke++) {
+					int x = position(_generator), y = position(_generator);
+					int dx = direction(_generator), dy = direction(_generator);
+					if ((dx == 0) && (dy == 0)) {
+						dx = 1;
+					}
+					for (int step = 0; step < 16; step++) {
+						if ((x < 1) || (x >= ImageSize - 1) || (y < 1) || (y >= ImageSize - 1)) {
+							break;
+						}
+						prototype[y*ImageSize + x] = 0.8f;
+						prototype[y*ImageSize + x + 1] = std::max(prototype[y*ImageSize + x + 1], 0.5f);
+						prototype[(y + 1)*ImageSize + x] = std::max(prototype[(y + 1)*ImageSize + x], 0.5f);
+						x += dx;
+						y += dy;
+					}
+				}
+				for (int i = 0; i < InputLayerSize; i++) {
+					prototype[i] = std::max(prototype[i], 0.05f);
+				}
+			}
+		}
+
+		TrainPair* CreatePair(int label) {
+			float *input = new float[InputLayerSize];
+			float *output = new float[OutputLayerSize];
+			FillImage(label, input);
+			for (int i = 0; i < OutputLayerSize; i++) {
+				output[i] = (i == label) ? 1.0f : 0.0f;
+			}
+			return new TrainPair(input, output, InputLayerSize, OutputLayerSize);
+		}
+
+		TrainSingle* CreateSingle(int label) {
+			float *input = new float[InputLayerSize];
+			FillImage(label, input);
+			return new TrainSingle(input, InputLayerSize);
+		}
+
+		float* GetPrototype(int label) {
+			return &_prototypes[(size_t)label*InputLayerSize];
+		}
+	private:
+		void FillImage(int label, float *image) {
+			std::uniform_real_distribution<float> uniform(0.0f, 1.0f);
+			std::uniform_int_distribution<int> shift(-2, 2);
+			const float *prototype = GetPrototype(label);
+			int dx = shift(_generator), dy = shift(_generator);
+			for (int y = 0; y < ImageSize; y++) {
+				for (int x = 0; x < ImageSize; x++) {
+					int sourceX = std::min(std::max(x - dx, 0), ImageSize - 1);
+					int sourceY = std::min(std::max(y - dy, 0), ImageSize - 1);
+					image[y*ImageSize + x] = (uniform(_generator) < prototype[sourceY*ImageSize + sourceX]) ? 1.0f : 0.0f;
+				}
+			}
+		}
+	};
+
+	class TargetErrorWatcher : public ITripleCallback {
+	private:
+		float _targetError;
+		double _start;
+	public:
+		int EpochsToTarget;
+		double SecondsToTarget;
+		std::vector<float> TrainErrors;
+		std::vector<float> TestErrors;
+
+		TargetErrorWatcher(float targetError) {
+			_targetError = targetError;
+			_start = 0.0;
+			EpochsToTarget = -1;
+			SecondsToTarget = -1.0;
+		}
+
+		void Restart(void) {
+			_start = TrainingTelemetry::Now();
+		}
+
+		virtual void Invoke(int iterationNum, float iterationValue, float addedIterationValue) {
+			TrainErrors.push_back(iterationValue);
+			TestErrors.push_back(addedIterationValue);
+			float error = std::isnan(addedIterationValue) ? iterationValue : addedIterationValue;
+			if ((EpochsToTarget < 0) && (error <= _targetError)) {
+				EpochsToTarget = iterationNum;
+				SecondsToTarget = TrainingTelemetry::Now() - _start;
+			}
+		}
+	};
+
+	class LikelihoodRecorder : public ITripleCallback {
+	public:
+		std::vector<float> LogPartitionFunctions;
+		std::vector<float> LogLikelihoods;
+
+		virtual void Invoke(int iterationNum, float iterationValue, float addedIterationValue) {
+			LogPartitionFunctions.push_back(iterationValue);
+			LogLikelihoods.push_back(addedIterationValue);
+		}
+	};
+
+	class FinishTimeRecorder : public ISingleCallback {
+	public:
+		std::vector<double> FinishTimes;
+
+		virtual void Invoke(int iterationCount) {
+			FinishTimes.push_back(TrainingTelemetry::Now());
+		}
+	};
+
+	class EpochStatsRecorder : public IEpochStatsCallback {
+	public:
+		std::vector<EpochStats> Epochs;
+
+		virtual void Invoke(const EpochStats &stats) {
+			Epochs.push_back(stats);
+		}
+	};
+
+	long long GetPeakRssKb(void) {
+#ifdef _WIN32
+		PROCESS_MEMORY_COUNTERS counters;
+		if (!GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) {
+			return 0;
+		}
+		return (long long)(counters.PeakWorkingSetSize/1024);
+#else
+		struct rusage usage;
+		if (getrusage(RUSAGE_SELF, &usage) != 0) {
+			return 0;
+		}
+		return (long long)usage.ru_maxrss;
+#endif
+	}
+
+	void FillProperties(TrainProperties &properties, const TrainingBenchmarkOptions &options, ExecutionContext *context) {
+		properties.Epsilon = 0.0f;
+		properties.MaxIterationCount = options.Epochs;
+		properties.PackageSize = 50;
+		properties.CvLimit = FLT_MAX;
+		properties.SkipCvLimitFirstIterations = options.Epochs;
+		properties.CvSlidingFactor = 0.5f;
+		properties.AsyncTesting = options.AsyncTesting;
+		properties.BatchTraining = options.BatchTraining;
+		properties.PersistentChainsCount = options.PersistentChains;
+		properties.FreeEnergyTrainSamples = options.FreeEnergyTrainSamples;
+		properties.PackedStates = options.PackedStates;
+		properties.Context = context;
+		properties.WeightsPlacement = options.WeightsPlacement;
+		properties.WeightReplicas = options.WeightReplicas;
+		properties.BaseLearnSpeed = 0.01f;
+		properties.SpeedBonus = 0.001f;
+		properties.SpeedPenalty = 0.999f;
+		properties.SpeedUpBorder = FLT_MAX;
+		properties.SpeedLowBorder = -FLT_MAX;
+	}
+
+	const char* GetPlacementName(NumaPlacement placement) {
+		switch (placement) {
+			case Interleaved:
+				return "interleaved";
+			case PartitionedByRows:
+				return "rows";
+			default:
+				return "local";
+		}
+	}
+
+	// The method chosen by --normalize with the statistics of the samples collected, or 0.
+	NormalizeMethod* CollectNormalization(const TrainingBenchmarkOptions &options, const std::vector<TrainSingle*> &samples,
+		SigmaComponentAnalysis *sigma, MinMaxComponentAnalysis *minMax) {
+		NormalizeMethod *normalization = 0;
+		if (options.Normalization == "sigma") {
+			normalization = sigma;
+		}
+		else if (options.Normalization == "minmax") {
+			normalization = minMax;
+		}
+		if (normalization != 0) {
+			normalization->CollectInputStatistics(&samples[0], (int)samples.size());
+		}
+		return normalization;
+	}
+
+	// The mean of the train inputs as the machine sees them, which CenteredGradient takes as the visible offsets.
+	std::vector<float> CalculateVisibleMeans(const std::vector<TrainSingle*> &samples, const DataTransform *inputTransform) {
+		std::vector<float> means(InputLayerSize, 0.0f);
+		std::vector<float> transformedInput(InputLayerSize);
+		for (size_t s = 0; s < samples.size(); s++) {
+			const float *input = samples[s]->Input();
+			if (inputTransform != 0) {
+				inputTransform->Transform(&samples[s], 1, &transformedInput[0]);
+				input = &transformedInput[0];
+			}
+			for (int i = 0; i < InputLayerSize; i++) {
+				means[i] += input[i];
+			}
+		}
+		for (int i = 0; i < InputLayerSize; i++) {
+			means[i] /= samples.size();
+		}
+		return means;
+	}
+
+	void WriteErrors(FILE *file, const char *name, const std::vector<float> &errors) {
+		fprintf(file, "\"%s\":[", name);
+		for (size_t i = 0; i < errors.size(); i++) {
+			if (std::isnan(errors[i])) {
+				fprintf(file, "%snull", (i > 0) ? "," : "");
+			}
+			else {
+				fprintf(file, "%s%g", (i > 0) ? "," : "", errors[i]);
+			}
+		}
+		fprintf(file, "],");
+	}
+
+	void WriteResult(FILE *file, const char *scenario, const TrainingBenchmarkOptions &options, double seconds,
+		const EpochStatsRecorder &recorder, const TargetErrorWatcher &watcher, const LikelihoodRecorder &likelihoods, float targetError) {
+		long long samplesCount = 0;
+		double epochsSeconds = 0.0;
+		PhaseStats phases[TrainingPhasesCount];
+		memset(phases, 0, sizeof(phases));
+		for (size_t epoch = 0; epoch < recorder.Epochs.size(); epoch++) {
+			const EpochStats &stats = recorder.Epochs[epoch];
+			samplesCount += stats.SamplesCount;
+			epochsSeconds += stats.Seconds;
+			for (int phase = 0; phase < TrainingPhasesCount; phase++) {
+				phases[phase].Seconds += stats.Phases[phase].Seconds;
+				phases[phase].Flops += stats.Phases[phase].Flops;
+				phases[phase].Bytes += stats.Phases[phase].Bytes;
+			}
+		}
+
+		fprintf(file, "{\"scenario\":\"%s\",\"seed\":%u,\"threads\":%d,\"batch\":%s,\"async\":%s,\"transposed\":%s,\"packed\":%s,\"placement\":\"%s\",\"replicas\":%s,\"normalize\":\"%s\",\"gradient\":\"%s\",\"chains\":%d,\"temperatures\":%d,\"epochs\":%d,\"train_samples\":%d,\"test_samples\":%d,"
+			"\"seconds\":%.6f,\"samples_per_sec\":%.3f,\"peak_rss_kb\":%lld,",
+			scenario, options.Seed, options.Threads, options.BatchTraining ? "true" : "false", options.AsyncTesting ? "true" : "false",
+			options.TransposedWeights ? "true" : "false", options.PackedStates ? "true" : "false",
+			GetPlacementName(options.WeightsPlacement), options.WeightReplicas ? "true" : "false", options.Normalization.c_str(), options.Gradient.c_str(), options.PersistentChains, options.Temperatures, options.Epochs, options.TrainSamples, options.TestSamples,
+			seconds, (seconds > 0.0) ? samplesCount/seconds : 0.0, GetPeakRssKb());
+		fprintf(file, "\"target_error\":%g,", targetError);
+		if (watcher.EpochsToTarget >= 0) {
+			fprintf(file, "\"epochs_to_target\":%d,\"seconds_to_target\":%.6f,", watcher.EpochsToTarget, watcher.SecondsToTarget);
+		}
+		else {
+			fprintf(file, "\"epochs_to_target\":null,\"seconds_to_target\":null,");
+		}
+		WriteErrors(file, "train_errors", watcher.TrainErrors);
+		WriteErrors(file, "test_errors", watcher.TestErrors);
+		WriteErrors(file, "log_partition_functions", likelihoods.LogPartitionFunctions);
+		WriteErrors(file, "log_likelihoods", likelihoods.LogLikelihoods);
+		fprintf(file, "\"phases\":{");
+		for (int phase = 0; phase < TrainingPhasesCount; phase++) {
+			fprintf(file, "%s\"%s\":{\"seconds\":%.6f,\"flops\":%.0f,\"bytes\":%.0f}", (phase > 0) ? "," : "",
+				TrainingTelemetry::GetPhaseName((TrainingPhase)phase), phases[phase].Seconds, phases[phase].Flops, phases[phase].Bytes);
+		}
+		// With --async 1 the evaluation runs beside the epochs, so a ratio close to that of --async 0 with
+		// shorter epochs means the evaluation is hidden behind training.
+		fprintf(file, "},\"evaluation_epoch_ratio\":%.6f,\"epoch_seconds\":[",
+			(epochsSeconds > 0.0) ? phases[EvaluationPhase].Seconds/epochsSeconds : 0.0);
+		for (size_t epoch = 0; epoch < recorder.Epochs.size(); epoch++) {
+			fprintf(file, "%s%.6f", (epoch > 0) ? "," : "", recorder.Epochs[epoch].Seconds);
+		}
+		fprintf(file, "]}\n");
+		fflush(file);
+	}
+
+	void RunTrainMethod(TrainMethod *trainMethod, NeuralNet *neuralNet, TrainProperties *properties, FILE *file,
+		const char *scenario, const TrainingBenchmarkOptions &options, float targetError, const LikelihoodRecorder &likelihoods) {
+		EpochStatsRecorder recorder;
+		TargetErrorWatcher watcher(targetError);
+		trainMethod->IterationCompleted = &watcher;
+		trainMethod->EpochStatsCompleted = &recorder;
+		trainMethod->InitilazeMethod(neuralNet, properties);
+
+		watcher.Restart();
+		double start = TrainingTelemetry::Now();
+		trainMethod->Start();
+		double seconds = TrainingTelemetry::Now() - start;
+
+		WriteResult(file, scenario, options, seconds, recorder, watcher, likelihoods, targetError);
+	}
+
+	void RunRbmTrainMethod(RbmTrainMethod *trainMethod, NeuralNet *neuralNet, TrainProperties *properties, FILE *file,
+		const char *scenario, const TrainingBenchmarkOptions &options, const DataTransform *inputTransform) {
+		AnnealedImportanceSampling estimator(options.AisRuns, options.AisTemperatures, options.Seed, 1);
+		trainMethod->SetInputTransform(inputTransform);
+		LikelihoodRecorder likelihoods;
+		if (options.AisRuns > 0) {
+			trainMethod->SetLikelihoodEstimator(&estimator, options.AisInterval);
+			trainMethod->LikelihoodEstimated = &likelihoods;
+		}
+		RunTrainMethod(trainMethod, neuralNet, properties, file, scenario, options, options.RbmTargetError, likelihoods);
+	}
+
+	void SetWeights(float *weights, size_t count, float factor, std::mt19937 &generator) {
+		std::normal_distribution<float> distribution(0.0f, 1.0f);
+		for (size_t i = 0; i < count; i++) {
+			weights[i] = factor*distribution(generator);
+		}
+	}
+
+	void RunBackPropagation(const TrainingBenchmarkOptions &options, ExecutionContext *context, FILE *file) {
+		SyntheticLetters letters(options.Seed);
+		std::vector<TrainPair*> trainData(options.TrainSamples);
+		std::vector<TrainPair*> testData(options.TestSamples);
+		for (int i = 0; i < options.TrainSamples; i++) {
+			trainData[i] = letters.CreatePair(i%OutputLayerSize);
+		}
+		for (int i = 0; i < options.TestSamples; i++) {
+			testData[i] = letters.CreatePair(i%OutputLayerSize);
+		}
+
+		HyperbolicTangensFunction hiddenFunction(1.0f, 1.0f);
+		SoftmaxFunction outputFunction;
+		int layersStruct[3] = {HiddenLayer1Size, HiddenLayer2Size, OutputLayerSize};
+		MultyLayerPerceptronFactory factory(InputLayerSize, 3, layersStruct, &hiddenFunction, &outputFunction, NullDistribution);
+		MultyLayerPerceptron::MultyLayerPerceptron *neuralNet = (MultyLayerPerceptron::MultyLayerPerceptron*)factory.CreateNeuralNet();
+		std::mt19937 generator(options.Seed);
+		for (int layerNum = 0; layerNum < neuralNet->GetLayersCount(); layerNum++) {
+			BaseNeuralBlock *layer = neuralNet->GetLayers()[layerNum];
+			float factor = 1.0f/sqrtf((float)layer->GetPreviousSize());
+			SetWeights(layer->GetWeights(), (size_t)layer->GetSize()*layer->GetPreviousSize(), factor, generator);
+			SetWeights(layer->GetBias(), layer->GetSize(), factor, generator);
+		}
+
+		CrossEntropyForSoftmax metrics;
+		EliminationRegularization regularization(0.001f, 1.2f);
+		ReverseFactor factorStrategy;
+		TrainProperties properties;
+		FillProperties(properties, options, context);
+		properties.Metrics = &metrics;
+		properties.Regularization = &regularization;
+		properties.FactorStrategy = &factorStrategy;
+		properties.AddedFactorStrategy = &factorStrategy;
+		properties.AverageLearnFactor = 0.7f;
+		properties.Momentum = 0.99f;
+
+		BackPropagationAlgorithm *trainMethod = new BackPropagationAlgorithm(&trainData[0], options.TrainSamples,
+			&testData[0], options.TestSamples);
+		SigmaComponentAnalysis sigma;
+		MinMaxComponentAnalysis minMax;
+		trainMethod->SetInputNormalization(CollectNormalization(options,
+			std::vector<TrainSingle*>(trainData.begin(), trainData.end()), &sigma, &minMax));
+		RunTrainMethod(trainMethod, neuralNet, &properties, file, "bpa", options, options.BpaTargetError, LikelihoodRecorder());
+
+		delete trainMethod;
+		delete neuralNet;
+		for (size_t i = 0; i < trainData.size(); i++) {
+			delete trainData[i];
+		}
+		for (size_t i = 0; i < testData.size(); i++) {
+			delete testData[i];
+		}
+	}
+
+	void RunRbm(const TrainingBenchmarkOptions &options, ExecutionContext *context, FILE *file, const char *scenario) {
+		SyntheticLetters letters(options.Seed);
+		std::vector<TrainSingle*> trainData(options.TrainSamples);
+		std::vector<TrainSingle*> testData(options.TestSamples);
+		for (int i = 0; i < options.TrainSamples; i++) {
+			trainData[i] = letters.CreateSingle(i%OutputLayerSize);
+		}
+		for (int i = 0; i < options.TestSamples; i++) {
+			testData[i] = letters.CreateSingle(i%OutputLayerSize);
+		}
+
+		BinaryBinaryRbm *neuralNet = new BinaryBinaryRbm(InputLayerSize, options.RbmHiddenSize);
+		std::mt19937 generator(options.Seed);
+		SetWeights(neuralNet->GetWeights(), (size_t)InputLayerSize*options.RbmHiddenSize, 0.01f, generator);
+		std::fill(neuralNet->GetVisibleStatesBias(), neuralNet->GetVisibleStatesBias() + InputLayerSize, 0.0f);
+		std::fill(neuralNet->GetHiddenStatesBias(), neuralNet->GetHiddenStatesBias() + options.RbmHiddenSize, 0.0f);
+		neuralNet->EnableTransposedWeights(options.TransposedWeights);
+		neuralNet->SetRandomStream(options.Seed, 0);
+
+		HalfSquaredEuclidianDistance metrics;
+		L1Regularization regularization(0.0001f);
+		SqrtReverseFactor factorStrategy;
+		ConstantFactor addedFactorStrategy(1.0f);
+		TrainProperties properties;
+		FillProperties(properties, options, context);
+		properties.Metrics = &metrics;
+		properties.Regularization = &regularization;
+		properties.FactorStrategy = &factorStrategy;
+		properties.AddedFactorStrategy = &addedFactorStrategy;
+		properties.AverageLearnFactor = 0.6f;
+		properties.Momentum = 0.96f;
+
+		SigmaComponentAnalysis sigma;
+		MinMaxComponentAnalysis minMax;
+		NormalizeMethod *normalization = CollectNormalization(options, trainData, &sigma, &minMax);
+		NormalizedInputTransform normalizedInput(normalization);
+		const DataTransform *inputTransform = (normalization != 0) ? &normalizedInput : 0;
+
+		LinearGradient linearGradient;
+		std::vector<float> visibleOffsets = CalculateVisibleMeans(trainData, inputTransform);
+		std::vector<float> hiddenOffsets(options.RbmHiddenSize, 0.5f);
+		CenteredGradient centeredGradient(0.5f, &visibleOffsets[0], InputLayerSize, &hiddenOffsets[0], options.RbmHiddenSize);
+		EnhancedGradient enhancedGradient;
+		GradientFunction *gradient = &linearGradient;
+		if (options.Gradient == "centered") {
+			gradient = &centeredGradient;
+		}
+		else if (options.Gradient == "enhanced") {
+			gradient = &enhancedGradient;
+		}
+		if (strcmp(scenario, "fpcd") == 0) {
+			FastPersistentContrastiveDivergence *trainMethod = new FastPersistentContrastiveDivergence(&trainData[0],
+				&testData[0], options.TrainSamples, options.TestSamples, gradient, 0.95f);
+			RunRbmTrainMethod(trainMethod, neuralNet, &properties, file, "fpcd", options, inputTransform);
+			delete trainMethod;
+		}
+		else if (strcmp(scenario, "pt") == 0) {
+			ParallelTempering *trainMethod = new ParallelTempering(&trainData[0], &testData[0],
+				options.TrainSamples, options.TestSamples, gradient, options.Temperatures);
+			RunRbmTrainMethod(trainMethod, neuralNet, &properties, file, "pt", options, inputTransform);
+			delete trainMethod;
+		}
+		else {
+			ContrastiveDivergence *trainMethod = new ContrastiveDivergence(&trainData[0], &testData[0],
+				options.TrainSamples, options.TestSamples, gradient, options.CdSteps);
+			RunRbmTrainMethod(trainMethod, neuralNet, &properties, file, "cd", options, inputTransform);
+			delete trainMethod;
+		}
+		delete neuralNet;
+		for (size_t i = 0; i < trainData.size(); i++) {
+			delete trainData[i];
+		}
+		for (size_t i = 0; i < testData.size(); i++) {
+			delete testData[i];
+		}
+	}
+
+	// Trains a ClassificationRbm on the labeled letters with the hybrid method; the error is that of the
+	// predicted labels, so it is compared against the back propagation target.
+	void RunClassificationRbm(const TrainingBenchmarkOptions &options, ExecutionContext *context, FILE *file) {
+		SyntheticLetters letters(options.Seed);
+		std::vector<TrainPair*> trainData(options.TrainSamples);
+		std::vector<TrainPair*> testData(options.TestSamples);
+		for (int i = 0; i < options.TrainSamples; i++) {
+			trainData[i] = letters.CreatePair(i%OutputLayerSize);
+		}
+		for (int i = 0; i < options.TestSamples; i++) {
+			testData[i] = letters.CreatePair(i%OutputLayerSize);
+		}
+
+		ClassificationRbm::ClassificationRbm *neuralNet = new ClassificationRbm::ClassificationRbm(InputLayerSize,
+			options.RbmHiddenSize, OutputLayerSize);
+		int visibleStatesCount = neuralNet->GetVisibleStatesCount();
+		std::mt19937 generator(options.Seed);
+		// Tiny label weights make every label equally likely under every hidden unit, where the discriminative
+		// gradient vanishes.
+		SetWeights(neuralNet->GetWeights(), (size_t)visibleStatesCount*options.RbmHiddenSize, 0.1f, generator);
+		std::fill(neuralNet->GetVisibleStatesBias(), neuralNet->GetVisibleStatesBias() + visibleStatesCount, 0.0f);
+		std::fill(neuralNet->GetHiddenStatesBias(), neuralNet->GetHiddenStatesBias() + options.RbmHiddenSize, 0.0f);
+		neuralNet->EnableTransposedWeights(options.TransposedWeights);
+		neuralNet->SetRandomStream(options.Seed, 0);
+
+		CrossEntropyForSoftmax metrics;
+		L1Regularization regularization(0.0001f);
+		SqrtReverseFactor factorStrategy;
+		TrainProperties properties;
+		FillProperties(properties, options, context);
+		properties.Metrics = &metrics;
+		properties.Regularization = &regularization;
+		properties.FactorStrategy = &factorStrategy;
+		properties.AddedFactorStrategy = &factorStrategy;
+		properties.AverageLearnFactor = 0.6f;
+		properties.Momentum = 0.9f;
+
+		LinearGradient gradient;
+		ClassificationRbm::HybridTrainMethod *trainMethod = new ClassificationRbm::HybridTrainMethod(&trainData[0], &testData[0],
+			options.TrainSamples, options.TestSamples, &gradient, options.CdSteps, 0.01f);
+		RunTrainMethod(trainMethod, neuralNet, &properties, file, "crbm", options, options.BpaTargetError, LikelihoodRecorder());
+
+		delete trainMethod;
+		delete neuralNet;
+		for (size_t i = 0; i < trainData.size(); i++) {
+			delete trainData[i];
+		}
+		for (size_t i = 0; i < testData.size(); i++) {
+			delete testData[i];
+		}
+	}
+
+	// Pretrains a two-layer stack with ContrastiveDivergence and writes one result per layer. The time of
+	// a layer includes spilling its inputs.
+	void RunDeepBeliefNetwork(const TrainingBenchmarkOptions &options, ExecutionContext *context, FILE *file) {
+		const int LayersCount = 2;
+		SyntheticLetters letters(options.Seed);
+		std::vector<TrainSingle*> trainData(options.TrainSamples);
+		std::vector<TrainSingle*> testData(options.TestSamples);
+		for (int i = 0; i < options.TrainSamples; i++) {
+			trainData[i] = letters.CreateSingle(i%OutputLayerSize);
+		}
+		for (int i = 0; i < options.TestSamples; i++) {
+			testData[i] = letters.CreateSingle(i%OutputLayerSize);
+		}
+
+		int layersStruct[LayersCount + 1] = {InputLayerSize, options.RbmHiddenSize, HiddenLayer2Size};
+		RestrictedBoltzmannMachineBase *layers[LayersCount];
+		std::mt19937 generator(options.Seed);
+		for (int k = 0; k < LayersCount; k++) {
+			int visibleStatesCount = layersStruct[k], hiddenStatesCount = layersStruct[k + 1];
+			layers[k] = new BinaryBinaryRbm(visibleStatesCount, hiddenStatesCount);
+			SetWeights(layers[k]->GetWeights(), (size_t)visibleStatesCount*hiddenStatesCount, 0.01f, generator);
+			std::fill(layers[k]->GetVisibleStatesBias(), layers[k]->GetVisibleStatesBias() + visibleStatesCount, 0.0f);
+			std::fill(layers[k]->GetHiddenStatesBias(), layers[k]->GetHiddenStatesBias() + hiddenStatesCount, 0.0f);
+			layers[k]->EnableTransposedWeights(options.TransposedWeights);
+			layers[k]->SetRandomStream(options.Seed, k);
+		}
+
+		HalfSquaredEuclidianDistance metrics;
+		L1Regularization regularization(0.0001f);
+		SqrtReverseFactor factorStrategy;
+		ConstantFactor addedFactorStrategy(1.0f);
+		TrainProperties properties;
+		FillProperties(properties, options, context);
+		properties.Metrics = &metrics;
+		properties.Regularization = &regularization;
+		properties.FactorStrategy = &factorStrategy;
+		properties.AddedFactorStrategy = &addedFactorStrategy;
+		properties.AverageLearnFactor = 0.6f;
+		properties.Momentum = 0.96f;
+
+		LinearGradient gradients[LayersCount];
+		RbmTrainMethod *trainMethods[LayersCount];
+		TrainProperties *layersProperties[LayersCount];
+		EpochStatsRecorder recorders[LayersCount];
+		std::vector<TargetErrorWatcher> watchers(LayersCount, TargetErrorWatcher(options.RbmTargetError));
+		FinishTimeRecorder finishTimes;
+		for (int k = 0; k < LayersCount; k++) {
+			trainMethods[k] = new ContrastiveDivergence(&trainData[0], &testData[0],
+				options.TrainSamples, options.TestSamples, &gradients[k], options.CdSteps);
+			trainMethods[k]->IterationCompleted = &watchers[k];
+			trainMethods[k]->EpochStatsCompleted = &recorders[k];
+			trainMethods[k]->IterativeProcessFinished = &finishTimes;
+			layersProperties[k] = &properties;
+			watchers[k].Restart();
+		}
+
+		DeepBeliefNetwork network(layers, LayersCount, false);
+		if (!options.SpillDirectory.empty()) {
+			network.SetSpillDirectory(options.SpillDirectory.c_str());
+		}
+		double start = TrainingTelemetry::Now();
+		if (network.Pretrain(trainMethods, layersProperties, &trainData[0], options.TrainSamples,
+			&testData[0], options.TestSamples)) {
+			const char *scenarios[LayersCount] = {"dbn-layer1", "dbn-layer2"};
+			for (int k = 0; k < LayersCount; k++) {
+				double layerStart = (k > 0) ? finishTimes.FinishTimes[k - 1] : start;
+				WriteResult(file, scenarios[k], options, finishTimes.FinishTimes[k] - layerStart, recorders[k], watchers[k],
+					LikelihoodRecorder(), options.RbmTargetError);
+			}
+		}
+		else {
+			fprintf(stderr, "Cannot create a spill file in %s\n", options.SpillDirectory.c_str());
+		}
+
+		for (int k = 0; k < LayersCount; k++) {
+			delete (ContrastiveDivergence*)trainMethods[k];
+			delete layers[k];
+		}
+		for (size_t i = 0; i < trainData.size(); i++) {
+			delete trainData[i];
+		}
+		for (size_t i = 0; i < testData.size(); i++) {
+			delete testData[i];
+		}
+	}
+
+	// Extracts the hidden probabilities of the train samples with FeatureExtractor into a half precision
+	// file in the spill directory (the current one by default), reads them back and compares them with
+	// the probabilities computed in memory.
+	void RunFeatureExtraction(const TrainingBenchmarkOptions &options, ExecutionContext *context, FILE *file) {
+		SyntheticLetters letters(options.Seed);
+		std::vector<float> inputs((size_t)options.TrainSamples*InputLayerSize);
+		for (int i = 0; i < options.TrainSamples; i++) {
+			TrainSingle *sample = letters.CreateSingle(i%OutputLayerSize);
+			std::copy(sample->Input(), sample->Input() + InputLayerSize, &inputs[(size_t)i*InputLayerSize]);
+			delete sample;
+		}
+
+		BinaryBinaryRbm *neuralNet = new BinaryBinaryRbm(InputLayerSize, options.RbmHiddenSize);
+		std::mt19937 generator(options.Seed);
+		SetWeights(neuralNet->GetWeights(), (size_t)InputLayerSize*options.RbmHiddenSize, 0.1f, generator);
+		std::fill(neuralNet->GetVisibleStatesBias(), neuralNet->GetVisibleStatesBias() + InputLayerSize, 0.0f);
+		std::fill(neuralNet->GetHiddenStatesBias(), neuralNet->GetHiddenStatesBias() + options.RbmHiddenSize, 0.0f);
+		neuralNet->EnableTransposedWeights(options.TransposedWeights);
+		neuralNet->SetExecutionContext(context);
+
+		std::string path = (options.SpillDirectory.empty() ? std::string(".") : options.SpillDirectory) + "/features.f16";
+		MemoryMappedMatrix *output = MemoryMappedMatrix::CreateAt(path.c_str(), options.TrainSamples, options.RbmHiddenSize,
+			HalfPrecision);
+		if (output == 0) {
+			fprintf(stderr, "Cannot create %s\n", path.c_str());
+			delete neuralNet;
+			return;
+		}
+		FeatureExtractor extractor(neuralNet, FeatureBatchSize, false);
+		double start = TrainingTelemetry::Now();
+		extractor.Extract(&inputs[0], options.TrainSamples, output);
+		delete output;
+		double seconds = TrainingTelemetry::Now() - start;
+
+		std::vector<float> expected((size_t)options.TrainSamples*options.RbmHiddenSize);
+		ExecutionContext::ExecuteIn(context, [&]() {
+			neuralNet->HiddenLayerCalculateActivity(&inputs[0], &expected[0], options.TrainSamples);
+		});
+		std::vector<float> features(expected.size());
+		start = TrainingTelemetry::Now();
+		MemoryMappedMatrix *input = MemoryMappedMatrix::Open(path.c_str(), options.RbmHiddenSize, HalfPrecision);
+		if ((input == 0) || (input->GetRowsCount() != options.TrainSamples)) {
+			fprintf(stderr, "Cannot read %s back\n", path.c_str());
+			delete input;
+			delete neuralNet;
+			return;
+		}
+		input->ReadRows(0, options.TrainSamples, &features[0]);
+		delete input;
+		double readSeconds = TrainingTelemetry::Now() - start;
+		remove(path.c_str());
+
+		float maxError = 0.0f;
+		for (size_t i = 0; i < features.size(); i++) {
+			maxError = std::max(maxError, fabsf(features[i] - expected[i]));
+		}
+		fprintf(file, "{\"scenario\":\"features\",\"seed\":%u,\"threads\":%d,\"transposed\":%s,\"train_samples\":%d,\"hidden\":%d,"
+			"\"batch_size\":%d,\"seconds\":%.6f,\"rows_per_sec\":%.3f,\"read_seconds\":%.6f,\"max_error\":%g,\"peak_rss_kb\":%lld}\n",
+			options.Seed, options.Threads, options.TransposedWeights ? "true" : "false", options.TrainSamples, options.RbmHiddenSize,
+			FeatureBatchSize, seconds, (seconds > 0.0) ? options.TrainSamples/seconds : 0.0, readSeconds, maxError, GetPeakRssKb());
+		fflush(file);
+		delete neuralNet;
+	}
+
+	// Trains a BinaryBinaryRbm with ContrastiveDivergence, hides the lower half of every test image and
+	// recovers it with ConditionalGibbsSampler. The accuracy is the share of hidden pixels whose recovered
+	// probability falls on the same side of 0.5 as the pixel.
+	void RunRecovery(const TrainingBenchmarkOptions &options, ExecutionContext *context, FILE *file) {
+		SyntheticLetters letters(options.Seed);
+		std::vector<TrainSingle*> trainData(options.TrainSamples);
+		std::vector<TrainSingle*> testData(options.TestSamples);
+		for (int i = 0; i < options.TrainSamples; i++) {
+			trainData[i] = letters.CreateSingle(i%OutputLayerSize);
+		}
+		for (int i = 0; i < options.TestSamples; i++) {
+			testData[i] = letters.CreateSingle(i%OutputLayerSize);
+		}
+
+		BinaryBinaryRbm *neuralNet = new BinaryBinaryRbm(InputLayerSize, options.RbmHiddenSize);
+		std::mt19937 generator(options.Seed);
+		SetWeights(neuralNet->GetWeights(), (size_t)InputLayerSize*options.RbmHiddenSize, 0.01f, generator);
+		std::fill(neuralNet->GetVisibleStatesBias(), neuralNet->GetVisibleStatesBias() + InputLayerSize, 0.0f);
+		std::fill(neuralNet->GetHiddenStatesBias(), neuralNet->GetHiddenStatesBias() + options.RbmHiddenSize, 0.0f);
+		neuralNet->EnableTransposedWeights(options.TransposedWeights);
+		neuralNet->SetRandomStream(options.Seed, 0);
+
+		HalfSquaredEuclidianDistance metrics;
+		L1Regularization regularization(0.0001f);
+		SqrtReverseFactor factorStrategy;
+		ConstantFactor addedFactorStrategy(1.0f);
+		TrainProperties properties;
+		FillProperties(properties, options, context);
+		properties.Metrics = &metrics;
+		properties.Regularization = &regularization;
+		properties.FactorStrategy = &factorStrategy;
+		properties.AddedFactorStrategy = &addedFactorStrategy;
+		properties.AverageLearnFactor = 0.6f;
+		properties.Momentum = 0.96f;
+
+		LinearGradient gradient;
+		ContrastiveDivergence *trainMethod = new ContrastiveDivergence(&trainData[0], &testData[0],
+			options.TrainSamples, options.TestSamples, &gradient, options.CdSteps);
+		RunRbmTrainMethod(trainMethod, neuralNet, &properties, file, "recover-cd", options, 0);
+		delete trainMethod;
+
+		std::vector<float> inputs((size_t)RecoveryBatchSize*InputLayerSize);
+		std::vector<float> masks(inputs.size());
+		std::vector<float> reconstructions(inputs.size());
+		for (int b = 0; b < RecoveryBatchSize; b++) {
+			std::fill(&masks[(size_t)b*InputLayerSize], &masks[(size_t)b*InputLayerSize] + InputLayerSize/2, 1.0f);
+			std::fill(&masks[(size_t)b*InputLayerSize] + InputLayerSize/2, &masks[(size_t)b*InputLayerSize] + InputLayerSize, 0.0f);
+		}
+		ConditionalGibbsSampler sampler(neuralNet, RecoveryChainsCount, RecoverySweepsCount, RecoveryBurnInSweepsCount);
+		long long hiddenPixelsCount = 0, recoveredPixelsCount = 0;
+		double seconds = 0.0;
+		for (int first = 0; first < options.TestSamples; first += RecoveryBatchSize) {
+			int batchSize = std::min(RecoveryBatchSize, options.TestSamples - first);
+			for (int b = 0; b < batchSize; b++) {
+				const float *input = testData[first + b]->Input();
+				std::copy(input, input + InputLayerSize, &inputs[(size_t)b*InputLayerSize]);
+			}
+			double start = TrainingTelemetry::Now();
+			sampler.Recover(&inputs[0], &masks[0], &reconstructions[0], batchSize);
+			seconds += TrainingTelemetry::Now() - start;
+			for (int b = 0; b < batchSize; b++) {
+				for (int i = InputLayerSize/2; i < InputLayerSize; i++) {
+					size_t index = (size_t)b*InputLayerSize + i;
+					if ((inputs[index] > 0.5f) == (reconstructions[index] > 0.5f)) {
+						recoveredPixelsCount++;
+					}
+					hiddenPixelsCount++;
+				}
+			}
+		}
+		fprintf(file, "{\"scenario\":\"recover\",\"seed\":%u,\"threads\":%d,\"test_samples\":%d,\"hidden\":%d,"
+			"\"chains\":%d,\"sweeps\":%d,\"burn_in\":%d,\"seconds\":%.6f,\"samples_per_sec\":%.3f,\"accuracy\":%.6f,"
+			"\"peak_rss_kb\":%lld}\n",
+			options.Seed, options.Threads, options.TestSamples, options.RbmHiddenSize, RecoveryChainsCount, RecoverySweepsCount,
+			RecoveryBurnInSweepsCount, seconds, (seconds > 0.0) ? options.TestSamples/seconds : 0.0,
+			(hiddenPixelsCount > 0) ? (double)recoveredPixelsCount/hiddenPixelsCount : 0.0, GetPeakRssKb());
+		fflush(file);
+
+		delete neuralNet;
+		for (size_t i = 0; i < trainData.size(); i++) {
+			delete trainData[i];
+		}
+		for (size_t i = 0; i < testData.size(); i++) {
+			delete testData[i];
+		}
+	}
+}
+
+int main(int argc, char **argv) {
+	TrainingBenchmarkOptions options;
+	if (!options.Parse(argc, argv)) {
+		options.PrintUsage(argv[0]);
+		return 1;
+	}
+
+	if (!options.ThresholdsFile.empty() && !ParallelDispatch::LoadThresholds(options.ThresholdsFile.c_str())) {
+		fprintf(stderr, "Cannot read %s\n", options.ThresholdsFile.c_str());
+		return 1;
+	}
+
+	FILE *file = stdout;
+	if (!options.OutputFile.empty()) {
+		file = fopen(options.OutputFile.c_str(), "a");
+		if (file == 0) {
+			fprintf(stderr, "Cannot open %s\n", options.OutputFile.c_str());
+			return 1;
+		}
+	}
+
+	RandomAccessIterator<TrainSingle*>::SetSeed(options.Seed);
+	ExecutionContext context(options.Threads, -1, -1);
+	options.Threads = context.GetConcurrency();
+	if ((options.Scenario == "all") || (options.Scenario == "bpa")) {
+		RunBackPropagation(options, &context, file);
+	}
+	if ((options.Scenario == "all") || (options.Scenario == "cd")) {
+		RunRbm(options, &context, file, "cd");
+	}
+	if ((options.Scenario == "all") || (options.Scenario == "fpcd")) {
+		RunRbm(options, &context, file, "fpcd");
+	}
+	if ((options.Scenario == "all") || (options.Scenario == "pt")) {
+		RunRbm(options, &context, file, "pt");
+	}
+	if ((options.Scenario == "all") || (options.Scenario == "dbn")) {
+		RunDeepBeliefNetwork(options, &context, file);
+	}
+	if ((options.Scenario == "all") || (options.Scenario == "crbm")) {
+		RunClassificationRbm(options, &context, file);
+	}
+	if ((options.Scenario == "all") || (options.Scenario == "features")) {
+		RunFeatureExtraction(options, &context, file);
+	}
+	if ((options.Scenario == "all") || (options.Scenario == "recover")) {
+		RunRecovery(options, &context, file);
+	}
+
+	if (file != stdout) {
+		fclose(file);
+	}
+	return 0;
+}
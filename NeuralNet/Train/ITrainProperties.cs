@@ -11,6 +11,16 @@ public interface ITrainProperties<T> where T:TrainData {
 		float CvLimit { get; set; }
 		int SkipCvLimitFirstIterations { get; set; }
 		float CvSlidingFactor { get; set; }
+		bool AsyncTesting { get; set; }
+		bool BatchTraining { get; set; }
+		int PersistentChainsCount { get; set; }
+		int FreeEnergyTrainSamples { get; set; }
+		bool PackedStates { get; set; }
+		int MaxConcurrency { get; set; }
+		int FirstCore { get; set; }
+		int NumaNode { get; set; }
+		WeightsPlacement WeightsPlacement { get; set; }
+		bool WeightReplicas { get; set; }
 		int MaxIterationCount { get; set; }
 		int PackageSize { get; set; }
 		float BaseLearnSpeed { get; set; }
@@ -11,6 +11,16 @@ public sealed class TrainProperties<T> : ITrainProperties<T> where T:TrainData {
 		public float CvLimit { get; set; }
 		public int SkipCvLimitFirstIterations { get; set; }
 		public float CvSlidingFactor { get; set; }
+		public bool AsyncTesting { get; set; }
+		public bool BatchTraining { get; set; }
+		public int PersistentChainsCount { get; set; }
+		public int FreeEnergyTrainSamples { get; set; }
+		public bool PackedStates { get; set; }
+		public int MaxConcurrency { get; set; }
+		public int FirstCore { get; set; }
+		public int NumaNode { get; set; }
+		public WeightsPlacement WeightsPlacement { get; set; }
+		public bool WeightReplicas { get; set; }
 		public int MaxIterationCount { get; set; }
 		public int PackageSize { get; set; }
 		public float BaseLearnSpeed { get; set; }
@@ -30,6 +40,8 @@ public sealed class TrainProperties<T> : ITrainProperties<T> where T:TrainData {
 			LearnFactorStrategy = new ConstantFactor();
 			AddedLearnFactorStrategy = new ConstantFactor();
 			SetWeightsAdaptation = new ConstantWeights<T>();
+			FirstCore = -1;
+			NumaNode = -1;
 		}
 	}
 }
@@ -0,0 +1,7 @@
+﻿namespace NeuralNet {
+	public enum WeightsPlacement {
+		LocalNode,
+		Interleaved,
+		PartitionedByRows
+	}
+}
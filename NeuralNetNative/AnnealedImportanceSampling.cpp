@@ -0,0 +1,217 @@
+#define NEURALNETNATIVEAPI
+
+#include "Platform.h"
+#include "AnnealedImportanceSampling.h"
+#include <tbb/tbb.h>
+#include <tbb/parallel_for.h>
+#include <tbb/blocked_range.h>
+#include "ParallelDispatch.h"
+#include "MatrixKernels.h"
+#include <algorithm>
+
+using namespace tbb;
+
+namespace NeuralNetNative {
+	namespace RestrictedBoltzmannMachine {
+		AnnealedImportanceSampling::AnnealedImportanceSampling(int runsCount, int temperaturesCount,
+		                                                       unsigned long long seed, unsigned long long stream) {
+			Initialize(runsCount, std::max(temperaturesCount, 2), seed, stream);
+			for (int k = 0; k < _temperaturesCount; k++) {
+				_inverseTemperatures[k] = (float)k/(_temperaturesCount - 1);
+			}
+		}
+
+		AnnealedImportanceSampling::AnnealedImportanceSampling(int runsCount, const float *inverseTemperatures, int temperaturesCount,
+		                                                       unsigned long long seed, unsigned long long stream) {
+			Initialize(runsCount, temperaturesCount, seed, stream);
+			std::copy(inverseTemperatures, inverseTemperatures + temperaturesCount, _inverseTemperatures);
+		}
+
+		AnnealedImportanceSampling::~AnnealedImportanceSampling(void) {
+			DeleteModelData();
+			if (_baseVisibleBias != 0) {
+				_mm_free(_baseVisibleBias);
+			}
+			_mm_free(_inverseTemperatures);
+		}
+
+		void AnnealedImportanceSampling::Initialize(int runsCount, int temperaturesCount, unsigned long long seed, unsigned long long stream) {
+			_runsCount = runsCount;
+			_temperaturesCount = temperaturesCount;
+			_inverseTemperatures = (float*)_mm_malloc(temperaturesCount*sizeof(float), 32);
+			_seed = seed;
+			_stream = stream;
+			_model = 0;
+			_baseVisibleBias = 0;
+			_hasBaseVisibleBias = false;
+			_logPartitionFunction = 0.0f;
+		}
+
+		void AnnealedImportanceSampling::DeleteModelData(void) {
+			if (_model != 0) {
+				delete _model;
+				_mm_free(_annealedVisibleBias);
+				_mm_free(_visibleStates);
+				_mm_free(_hiddenStates);
+				_mm_free(_potentials);
+				_mm_free(_logWeights);
+				_mm_free(_baseEnergies);
+				_mm_free(_energies);
+				_model = 0;
+			}
+		}
+
+		void AnnealedImportanceSampling::SetBaseVisibleBias(const float *baseVisibleBias, int visibleStatesCount) {
+			if (_baseVisibleBias != 0) {
+				_mm_free(_baseVisibleBias);
+			}
+			_baseVisibleBias = (float*)_mm_malloc(visibleStatesCount*sizeof(float), 32);
+			std::copy(baseVisibleBias, baseVisibleBias + visibleStatesCount, _baseVisibleBias);
+			_hasBaseVisibleBias = true;
+		}
+
+		void AnnealedImportanceSampling::PrepareModel(RestrictedBoltzmannMachineBase *rbm) {
+			int visibleStatesCount = rbm->GetVisibleStatesCount();
+			int hiddenStatesCount = rbm->GetHiddenStatesCount();
+			if ((_model != 0) && ((_model->GetVisibleStatesCount() != visibleStatesCount) ||
+			                      (_model->GetHiddenStatesCount() != hiddenStatesCount))) {
+				DeleteModelData();
+			}
+			if (_model == 0) {
+				_model = rbm->Clone();
+				_annealedVisibleBias = (float*)_mm_malloc(visibleStatesCount*sizeof(float), 32);
+				_visibleStates = (float*)_mm_malloc((size_t)_runsCount*visibleStatesCount*sizeof(float), 32);
+				_hiddenStates = (float*)_mm_malloc((size_t)_runsCount*hiddenStatesCount*sizeof(float), 32);
+				_potentials = (float*)_mm_malloc((size_t)_runsCount*hiddenStatesCount*sizeof(float), 32);
+				_logWeights = (float*)_mm_malloc(_runsCount*sizeof(float), 32);
+				_baseEnergies = (float*)_mm_malloc(_runsCount*sizeof(float), 32);
+				_energies = (float*)_mm_malloc(_runsCount*sizeof(float), 32);
+			}
+			else {
+				rbm->CopyParametersTo(_model);
+			}
+			if (!_hasBaseVisibleBias) {
+				if (_baseVisibleBias == 0) {
+					_baseVisibleBias = (float*)_mm_malloc(visibleStatesCount*sizeof(float), 32);
+				}
+				std::copy(rbm->GetVisibleStatesBias(), rbm->GetVisibleStatesBias() + visibleStatesCount, _baseVisibleBias);
+			}
+			_model->SetRandomStream(_seed, _stream);
+		}
+
+		// One Gibbs step of every run in the distribution at the inverse temperature, whose hidden
+		// potentials are already in _potentials:
+		// h ~ sigmoid(beta*(W*v + c)), v ~ p(v | visible bias (1 - beta)*b0 + beta*b, weights beta*W).
+		void AnnealedImportanceSampling::SampleStates(float inverseTemperature) {
+			int visibleStatesCount = _model->GetVisibleStatesCount();
+			int hiddenStatesCount = _model->GetHiddenStatesCount();
+			int hiddenCount = _runsCount*hiddenStatesCount;
+			float *hiddenStates = _hiddenStates;
+			const float *potentials = _potentials;
+			DispatchFor(hiddenCount, 1, 2*sizeof(float),
+			[=](const blocked_range<size_t>& r)
+			{
+				for (int i = r.begin(); i < r.end(); i++) {
+					hiddenStates[i] = inverseTemperature*potentials[i];
+				}
+			});
+			MatrixKernels::Sigmoid(_hiddenStates, hiddenCount);
+			_model->StatesSampling(_hiddenStates, hiddenCount);
+			// The visible pass takes beta*h, which is beta*W applied to h.
+			DispatchFor(hiddenCount, 1, 2*sizeof(float),
+			[=](const blocked_range<size_t>& r)
+			{
+				for (int i = r.begin(); i < r.end(); i++) {
+					hiddenStates[i] *= inverseTemperature;
+				}
+			});
+
+			const float *visibleBias = _model->GetVisibleStatesBias();
+			for (int i = 0; i < visibleStatesCount; i++) {
+				_annealedVisibleBias[i] = (1.0f - inverseTemperature)*_baseVisibleBias[i] + inverseTemperature*visibleBias[i];
+			}
+			RbmParameters parameters;
+			parameters.Weights = _model->GetWeights();
+			parameters.VisibleStatesBias = _annealedVisibleBias;
+			parameters.HiddenStatesBias = _model->GetHiddenStatesBias();
+			_model->VisibleLayerCalculateActivity(_hiddenStates, _visibleStates, _runsCount, parameters);
+			_model->VisibleLayerSampling(_visibleStates, _runsCount);
+		}
+
+		float AnnealedImportanceSampling::EstimateLogPartitionFunction(RestrictedBoltzmannMachineBase *rbm) {
+			PrepareModel(rbm);
+			int hiddenStatesCount = _model->GetHiddenStatesCount();
+			std::fill(_logWeights, _logWeights + _runsCount, 0.0f);
+			// At inverse temperature 0 the hidden states do not reach the visible units, so the first
+			// step draws exact samples of the starting machine.
+			std::fill(_potentials, _potentials + (size_t)_runsCount*hiddenStatesCount, 0.0f);
+			SampleStates(0.0f);
+
+			// log f_k(v) = -(1 - beta_k)*E0(v) - beta_k*E(v) + sum of log(1 + exp(beta_k*(W*v + c)))
+			for (int k = 1; k < _temperaturesCount; k++) {
+				float previousInverseTemperature = _inverseTemperatures[k - 1];
+				float inverseTemperature = _inverseTemperatures[k];
+				float step = inverseTemperature - previousInverseTemperature;
+
+				_model->HiddenLayerCalculatePotentials(_visibleStates, _potentials, _runsCount);
+				_model->CalculateVisibleEnergies(_visibleStates, _baseVisibleBias, _baseEnergies, _runsCount);
+				_model->CalculateVisibleEnergies(_visibleStates, _model->GetVisibleStatesBias(), _energies, _runsCount);
+				for (int run = 0; run < _runsCount; run++) {
+					_logWeights[run] += step*(_baseEnergies[run] - _energies[run]);
+				}
+				MatrixKernels::AddSoftplusRowSums(_potentials, inverseTemperature, 1.0f, _logWeights, _runsCount, hiddenStatesCount);
+				MatrixKernels::AddSoftplusRowSums(_potentials, previousInverseTemperature, -1.0f, _logWeights, _runsCount, hiddenStatesCount);
+
+				if (k + 1 < _temperaturesCount) {
+					SampleStates(inverseTemperature);
+				}
+			}
+
+			float maxLogWeight = *std::max_element(_logWeights, _logWeights + _runsCount);
+			double sumWeights = 0.0;
+			for (int run = 0; run < _runsCount; run++) {
+				sumWeights += exp((double)(_logWeights[run] - maxLogWeight));
+			}
+			_logPartitionFunction = _model->CalculateIndependentLogPartitionFunction(_baseVisibleBias) +
+			                        maxLogWeight + (float)log(sumWeights/_runsCount);
+			return _logPartitionFunction;
+		}
+
+		float AnnealedImportanceSampling::EstimateAverageLogLikelihood(RestrictedBoltzmannMachineBase *rbm,
+		                                                                StandardTypesNative::TrainSingle **data, int dataSize,
+		                                                                const DataTransform *inputTransform) {
+			float logPartitionFunction = EstimateLogPartitionFunction(rbm);
+			int visibleStatesCount = _model->GetVisibleStatesCount();
+			double sumLogProbabilities = 0.0;
+			for (int first = 0; first < dataSize; first += _runsCount) {
+				int batchSize = std::min(_runsCount, dataSize - first);
+				if (inputTransform != 0) {
+					inputTransform->Transform(data + first, batchSize, _visibleStates);
+				}
+				else {
+					for (int b = 0; b < batchSize; b++) {
+						float *input = data[first + b]->Input();
+						std::copy(input, input + visibleStatesCount, _visibleStates + (size_t)b*visibleStatesCount);
+					}
+				}
+				_model->CalculateFreeEnergies(_visibleStates, _energies, batchSize);
+				for (int b = 0; b < batchSize; b++) {
+					sumLogProbabilities -= _energies[b];
+				}
+			}
+			return (float)(sumLogProbabilities/dataSize) - logPartitionFunction;
+		}
+
+		float AnnealedImportanceSampling::GetLogPartitionFunction(void) const {
+			return _logPartitionFunction;
+		}
+
+		int AnnealedImportanceSampling::GetRunsCount(void) const {
+			return _runsCount;
+		}
+
+		int AnnealedImportanceSampling::GetTemperaturesCount(void) const {
+			return _temperaturesCount;
+		}
+	}
+}
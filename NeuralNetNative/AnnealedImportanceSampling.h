@@ -0,0 +1,59 @@
+#pragma once
+
+#include "ExportDll.h"
+#include "TrainSingle.h"
+#include "RestrictedBoltzmannMachine.h"
+#include "DataTransform.h"
+
+namespace NeuralNetNative {
+	namespace RestrictedBoltzmannMachine {
+		// Annealed importance sampling estimate of the log partition function of an RBM. The runs anneal
+		// from the machine with zero weights and hidden bias (base visible bias) to the machine itself
+		// through the given inverse temperatures, and all runs are advanced as one batch. The estimator
+		// samples on its own copy of the machine with a fixed stream, so every estimate uses the same
+		// random numbers and does not disturb the training stream.
+		class NEURALNETNATIVE_EXPORT AnnealedImportanceSampling {
+		private:
+			int _runsCount;
+			int _temperaturesCount;
+			float *_inverseTemperatures;
+			unsigned long long _seed;
+			unsigned long long _stream;
+			RestrictedBoltzmannMachineBase *_model;
+			float *_baseVisibleBias;
+			bool _hasBaseVisibleBias;
+			float *_annealedVisibleBias;
+			float *_visibleStates;
+			float *_hiddenStates;
+			float *_potentials;
+			float *_logWeights;
+			float *_baseEnergies;
+			float *_energies;
+			float _logPartitionFunction;
+		public:
+			// Uniform schedule of temperaturesCount inverse temperatures from 0 to 1.
+			AnnealedImportanceSampling(int runsCount, int temperaturesCount, unsigned long long seed, unsigned long long stream);
+			// inverseTemperatures must increase from 0 to 1.
+			AnnealedImportanceSampling(int runsCount, const float *inverseTemperatures, int temperaturesCount,
+			                           unsigned long long seed, unsigned long long stream);
+			~AnnealedImportanceSampling(void);
+			// Visible bias of the starting machine, e.g. the log odds of the data means for binary
+			// visible units; by default the visible bias of the estimated machine. Copied.
+			void SetBaseVisibleBias(const float *baseVisibleBias, int visibleStatesCount);
+			float EstimateLogPartitionFunction(RestrictedBoltzmannMachineBase *rbm);
+			// Mean of log p(v) = -F(v) - log Z over the data, with a fresh estimate of log Z. The visible
+			// states are the rows of the input transform, or the sample inputs when it is 0.
+			float EstimateAverageLogLikelihood(RestrictedBoltzmannMachineBase *rbm,
+			                                   StandardTypesNative::TrainSingle **data, int dataSize,
+			                                   const DataTransform *inputTransform);
+			float GetLogPartitionFunction(void) const;
+			int GetRunsCount(void) const;
+			int GetTemperaturesCount(void) const;
+		private:
+			void Initialize(int runsCount, int temperaturesCount, unsigned long long seed, unsigned long long stream);
+			void PrepareModel(RestrictedBoltzmannMachineBase *rbm);
+			void DeleteModelData(void);
+			void SampleStates(float inverseTemperature);
+		};
+	}
+}
@@ -0,0 +1,57 @@
+#define NEURALNETNATIVEAPI
+#include "AsyncModelTester.h"
+#include "TrainingTelemetry.h"
+
+namespace NeuralNetNative {
+	AsyncModelTester::AsyncModelTester(void) {
+		_isReady = false;
+		_isRunning = false;
+	}
+
+	AsyncModelTester::~AsyncModelTester(void) {
+		if (_worker.joinable()) {
+			_worker.join();
+		}
+	}
+
+	bool AsyncModelTester::IsBusy(void) const {
+		return _isRunning && !_isReady;
+	}
+
+	void AsyncModelTester::Run(int iterationNum, const std::function<void(ModelTestResult &result)> &test) {
+		if (_worker.joinable()) {
+			_worker.join();
+		}
+		_isRunning = true;
+		_isReady = false;
+		_result.IterationNum = iterationNum;
+		_worker = std::thread([this, test]() {
+			double start = StandardTypesNative::TrainingTelemetry::Now();
+			test(_result);
+			_result.Seconds = StandardTypesNative::TrainingTelemetry::Now() - start;
+			_isReady = true;
+		});
+	}
+
+	bool AsyncModelTester::TryGetResult(ModelTestResult &result) {
+		if (!_isRunning || !_isReady) {
+			return false;
+		}
+		TakeResult(result);
+		return true;
+	}
+
+	bool AsyncModelTester::WaitResult(ModelTestResult &result) {
+		if (!_isRunning) {
+			return false;
+		}
+		TakeResult(result);
+		return true;
+	}
+
+	void AsyncModelTester::TakeResult(ModelTestResult &result) {
+		_worker.join();
+		_isRunning = false;
+		result = _result;
+	}
+}
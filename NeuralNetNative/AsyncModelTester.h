@@ -0,0 +1,34 @@
+#pragma once
+
+#include <thread>
+#include <atomic>
+#include <functional>
+
+namespace NeuralNetNative {
+	struct ModelTestResult {
+	public:
+		int IterationNum;
+		float TrainError;
+		float TestError;
+		double Seconds;
+	};
+
+	// Runs model testing on a separate thread. Only one test can be in flight: a caller must
+	// check IsBusy() before Run(), so the tested model snapshot is never overwritten while in use.
+	class AsyncModelTester {
+	private:
+		std::thread _worker;
+		std::atomic<bool> _isReady;
+		bool _isRunning;
+		ModelTestResult _result;
+	public:
+		AsyncModelTester(void);
+		~AsyncModelTester(void);
+		bool IsBusy(void) const;
+		void Run(int iterationNum, const std::function<void(ModelTestResult &result)> &test);
+		bool TryGetResult(ModelTestResult &result);
+		bool WaitResult(ModelTestResult &result);
+	private:
+		void TakeResult(ModelTestResult &result);
+	};
+}
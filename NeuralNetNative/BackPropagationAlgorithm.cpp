@@ -1,13 +1,13 @@
 #define NEURALNETNATIVEAPI
-#include <mathimf.h>
+#include "Platform.h"
 #include "BackPropagationAlgorithm.h"
 #include "TrainPair.h"
-#include "malloc.h"
-#include <tbb\tbb.h>
-#include <tbb\task_scheduler_init.h>
-#include <tbb\parallel_for.h>
-#include <tbb\blocked_range.h>
-#include "GrainSizeForParallel.h"
+#include <tbb/tbb.h>
+#include <tbb/parallel_for.h>
+#include <tbb/blocked_range.h>
+#include "ParallelDispatch.h"
+#include "AsyncModelTester.h"
+#include "ExecutionContext.h"
 
 using namespace StandardTypesNative;
 using namespace tbb;
@@ -18,6 +18,7 @@ namespace NeuralNetNative {
 			_neuralNet = 0;
 			_trainDataIterator = new RandomAccessIterator<TrainPair*>(trainData, trainDataSize);
 			_testData = 0;
+			_inputNormalization = 0;
 		}
 
 		BackPropagationAlgorithm::BackPropagationAlgorithm(StandardTypesNative::TrainPair **trainData, int trainDataSize, StandardTypesNative::TrainPair **testData, int testDataSize) {
@@ -25,6 +26,7 @@ namespace NeuralNetNative {
 			_trainDataIterator = new RandomAccessIterator<TrainPair*>(trainData, trainDataSize);
 			_testData = testData;
 			_testDataSize = testDataSize;
+			_inputNormalization = 0;
 		}
 
 		BackPropagationAlgorithm::~BackPropagationAlgorithm(void) {
@@ -38,12 +40,15 @@ namespace NeuralNetNative {
 				return;
 			}
 			_properties = trainProperties;
+			_neuralNet->SetExecutionContext(_properties->Context);
 			_layers = _neuralNet->GetLayers();
 			_layersCount = _neuralNet->GetLayersCount();
 			_inputSize = _neuralNet->GetInputSize();
 			_outputSize = _neuralNet->GetOutputSize();
 			_packageFactor = 1.0f/_properties->PackageSize;
 			_packagesCount = CalculatePackagesCount();
+			// The optimizer buffers follow the placement of the weights, so it is set first.
+			_neuralNet->SetNumaPlacement(_properties->WeightsPlacement, _properties->WeightReplicas);
 			AllocateMemory();
 			ProcessSate = IterativeProcessState::NotStarted;
 		}
@@ -60,6 +65,10 @@ namespace NeuralNetNative {
 			return _properties;
 		}
 
+		void BackPropagationAlgorithm::SetInputNormalization(StandardTypesNative::NormalizeMethod *inputNormalization) {
+			_inputNormalization = inputNormalization;
+		}
+
 		void BackPropagationAlgorithm::AllocateMemory(void) {
 			int maxGradientSize = FindMaxSize();
 
@@ -69,25 +78,36 @@ namespace NeuralNetNative {
 			int outputSize = _layers[_layersCount - 1]->GetSize();
 			_neuronNetOutput =  (float*)_mm_malloc(outputSize*sizeof(float), 32);
 			_partialDerivaitve = (float*)_mm_malloc(outputSize*sizeof(float), 32);
+			_normalizedInput = (float*)_mm_malloc(_inputSize*sizeof(float), 32);
 
 			_oldDeltaWeights = (float**)_mm_malloc(_layersCount*sizeof(float*), 32);
 			_derivativeAverages = (float**)_mm_malloc(_layersCount*sizeof(float*), 32);
 			_packageDerivative = (float**)_mm_malloc(_layersCount*sizeof(float*), 32);
 			_learnFactors = (float**)_mm_malloc(_layersCount*sizeof(float*), 32);
+			_weightsCount = 0.0;
+			_backwardWeightsCount = 0.0;
 			for (int i = 0; i < _layersCount; i++) {
 				BaseNeuralBlock *layer = _layers[i];
-				int weightsCount = (layer->GetPreviousSize())*(layer->GetSize());
+				int layerSize = layer->GetSize();
+				int prevLayerSize = layer->GetPreviousSize();
+				int weightsCount = prevLayerSize*layerSize;
+				_weightsCount += weightsCount;
+				if (i > 0) {
+					_backwardWeightsCount += weightsCount;
+				}
+				NumaPlacement placement = layer->GetWeightsPlacement();
 
-				_oldDeltaWeights[i] = (float*)_mm_malloc(weightsCount*sizeof(float), 32);
-				_derivativeAverages[i] = (float*)_mm_malloc(weightsCount*sizeof(float), 32);
-				_packageDerivative[i] = (float*)_mm_malloc(weightsCount*sizeof(float), 32);
-				_learnFactors[i] = (float*)_mm_malloc(weightsCount*sizeof(float), 32);
+				_oldDeltaWeights[i] = NumaMemory::Allocate(layerSize, prevLayerSize, placement);
+				_derivativeAverages[i] = NumaMemory::Allocate(layerSize, prevLayerSize, placement);
+				_packageDerivative[i] = NumaMemory::Allocate(layerSize, prevLayerSize, placement);
+				_learnFactors[i] = NumaMemory::Allocate(layerSize, prevLayerSize, placement);
 				for (int j = 0; j < weightsCount; j++) {
 					_oldDeltaWeights[i][j] = 0.0f;
 					_derivativeAverages[i][j] = 0.0f;
 					_packageDerivative[i][j] = 0.0f;
 					_learnFactors[i][j] = 1.0f;
 				}
+				layer->RefreshWeightReplicas();
 			}
 
 			_oldDeltaWeightsForBias = (float**)_mm_malloc(_layersCount*sizeof(float*), 32);
@@ -109,6 +129,19 @@ namespace NeuralNetNative {
 					_learnFactorsForBias[i][j] = 1.0f;
 				}
 			}
+
+			if (_properties->AsyncTesting) {
+				_asyncTester = new AsyncModelTester();
+				_snapshotNeuralNet = _neuralNet->Clone();
+				_snapshotOutput = (float*)_mm_malloc(outputSize*sizeof(float), 32);
+				_snapshotInput = (float*)_mm_malloc(_inputSize*sizeof(float), 32);
+			}
+			else {
+				_asyncTester = 0;
+				_snapshotNeuralNet = 0;
+				_snapshotOutput = 0;
+				_snapshotInput = 0;
+			}
 		}
 
 		int BackPropagationAlgorithm::FindMaxSize(void) {
@@ -123,12 +156,17 @@ namespace NeuralNetNative {
 		}
 
 		void BackPropagationAlgorithm::RunIterativeProcess() {
-			if (IsTestDataAvailable()) {
-	            RunTraingWithTesting();
-	        }
-			else {
-				RunTraingWithoutTesting();
-			}
+			ExecutionContext::ExecuteIn(_properties->Context, [this]() {
+				if (_properties->AsyncTesting) {
+					RunTraingWithAsyncTesting();
+				}
+				else if (IsTestDataAvailable()) {
+					RunTraingWithTesting();
+				}
+				else {
+					RunTraingWithoutTesting();
+				}
+			});
 		}
 
 		void BackPropagationAlgorithm::ApplyResults(void) {
@@ -144,13 +182,13 @@ namespace NeuralNetNative {
 				_layers = 0;
 
 				for (int i = 0; i < _layersCount; i++) {
-					_mm_free(_oldDeltaWeights[i]);
-					_mm_free(_derivativeAverages[i]);
-					_mm_free(_packageDerivative[i]);
+					NumaMemory::Free(_oldDeltaWeights[i]);
+					NumaMemory::Free(_derivativeAverages[i]);
+					NumaMemory::Free(_packageDerivative[i]);
 					_mm_free(_oldDeltaWeightsForBias[i]);
 					_mm_free(_derivativeAveragesForBias[i]);
 					_mm_free(_packageDerivativeForBias[i]);
-					_mm_free(_learnFactors[i]);
+					NumaMemory::Free(_learnFactors[i]);
 					_mm_free(_learnFactorsForBias[i]);
 				}
 				_mm_free(_oldDeltaWeights);
@@ -165,6 +203,18 @@ namespace NeuralNetNative {
 				_mm_free(_gradientsIntermediate);
 				_mm_free(_neuronNetOutput);
 				_mm_free(_partialDerivaitve);
+				_mm_free(_normalizedInput);
+
+				if (_asyncTester != 0) {
+					delete _asyncTester;
+					delete _snapshotNeuralNet;
+					_mm_free(_snapshotOutput);
+					_mm_free(_snapshotInput);
+					_asyncTester = 0;
+					_snapshotNeuralNet = 0;
+					_snapshotOutput = 0;
+					_snapshotInput = 0;
+				}
 			}
 		}
 
@@ -173,8 +223,8 @@ namespace NeuralNetNative {
         }
 
         void BackPropagationAlgorithm::RunTraingWithTesting(void) {
-            float trainError = TestModel(_trainDataIterator->Collection(), _trainDataIterator->Size());
-			float slidingTestError = TestModel(_testData, _testDataSize);
+            float trainError = TestModel(_neuralNet, _normalizedInput, _neuronNetOutput, _trainDataIterator->Collection(), _trainDataIterator->Size());
+			float slidingTestError = TestModel(_neuralNet, _normalizedInput, _neuronNetOutput, _testData, _testDataSize);
 			float minTestError = slidingTestError;
 			_epochNumber = 1;
 			while ((ProcessSate == StandardTypesNative::IterativeProcessState::InProgress) && 
@@ -183,10 +233,11 @@ namespace NeuralNetNative {
 				((_epochNumber <= _properties->SkipCvLimitFirstIterations) ||
                  (fabsf(slidingTestError - minTestError) < _properties->CvLimit))) {
 
+				TELEMETRY_BEGIN_EPOCH(Telemetry, (int)_epochNumber);
 				TrainEpoch();
 
-				trainError = TestModel(_trainDataIterator->Collection(), _trainDataIterator->Size());
-				float testError = TestModel(_testData, _testDataSize);
+				trainError = EvaluateModel(_trainDataIterator->Collection(), _trainDataIterator->Size());
+				float testError = EvaluateModel(_testData, _testDataSize);
                 slidingTestError = _properties->CvSlidingFactor*testError +
 					(1.0f - _properties->CvSlidingFactor)*slidingTestError;
 
@@ -195,55 +246,158 @@ namespace NeuralNetNative {
 				}
 
 				OnIterationCompleted(_epochNumber, trainError, testError);
+				TELEMETRY_END_EPOCH();
 				_epochNumber++;
 			}
 			OnIterativeProcessFinished(_epochNumber);
         }
 
         void BackPropagationAlgorithm::RunTraingWithoutTesting(void) {
-            float trainError = TestModel(_trainDataIterator->Collection(), _trainDataIterator->Size());
+            float trainError = TestModel(_neuralNet, _normalizedInput, _neuronNetOutput, _trainDataIterator->Collection(), _trainDataIterator->Size());
 			_epochNumber = 1;
 			while ((ProcessSate == StandardTypesNative::IterativeProcessState::InProgress) && 
 				   (trainError > _properties->Epsilon) && 
 				   (_epochNumber <= _properties->MaxIterationCount)) {
 
+				TELEMETRY_BEGIN_EPOCH(Telemetry, (int)_epochNumber);
 				TrainEpoch();
 
-				trainError = TestModel(_trainDataIterator->Collection(), _trainDataIterator->Size());
+				trainError = EvaluateModel(_trainDataIterator->Collection(), _trainDataIterator->Size());
 
 				OnIterationCompleted(_epochNumber, trainError, std::numeric_limits<float>::quiet_NaN());
+				TELEMETRY_END_EPOCH();
+				_epochNumber++;
+			}
+			OnIterativeProcessFinished(_epochNumber);
+        }
+
+        void BackPropagationAlgorithm::RunTraingWithAsyncTesting(void) {
+			bool isTestDataAvailable = IsTestDataAvailable();
+            float trainError = TestModel(_neuralNet, _normalizedInput, _neuronNetOutput, _trainDataIterator->Collection(), _trainDataIterator->Size());
+			float slidingTestError = isTestDataAvailable ? TestModel(_neuralNet, _normalizedInput, _neuronNetOutput, _testData, _testDataSize) : 0.0f;
+			float minTestError = slidingTestError;
+			ModelTestResult testResult;
+			_epochNumber = 1;
+			while ((ProcessSate == StandardTypesNative::IterativeProcessState::InProgress) && 
+				(trainError > _properties->Epsilon) && 
+				(_epochNumber <= _properties->MaxIterationCount) &&
+				(!isTestDataAvailable || (_epochNumber <= _properties->SkipCvLimitFirstIterations) ||
+                 (fabsf(slidingTestError - minTestError) < _properties->CvLimit))) {
+
+				TELEMETRY_BEGIN_EPOCH(Telemetry, (int)_epochNumber);
+				TrainEpoch();
+
+				if (_asyncTester->TryGetResult(testResult)) {
+					ApplyAsyncTestResult(testResult, trainError, slidingTestError, minTestError);
+				}
+				if (!_asyncTester->IsBusy()) {
+					StartAsyncTesting();
+				}
+				TELEMETRY_END_EPOCH();
 				_epochNumber++;
 			}
+
+			if (_asyncTester->WaitResult(testResult)) {
+				ApplyAsyncTestResult(testResult, trainError, slidingTestError, minTestError);
+			}
 			OnIterativeProcessFinished(_epochNumber);
         }
 
-		float BackPropagationAlgorithm::TestModel(StandardTypesNative::TrainPair **data, int dataSize) {
+		void BackPropagationAlgorithm::StartAsyncTesting(void) {
+			_neuralNet->CopyParametersTo(_snapshotNeuralNet);
+			_asyncTester->Run((int)_epochNumber, [this](ModelTestResult &result) {
+				ExecutionContext::ExecuteIn(_properties->Context, [this, &result]() {
+					result.TrainError = TestModel(_snapshotNeuralNet, _snapshotInput, _snapshotOutput, _trainDataIterator->Collection(), _trainDataIterator->Size());
+					result.TestError = IsTestDataAvailable() ? TestModel(_snapshotNeuralNet, _snapshotInput, _snapshotOutput, _testData, _testDataSize) :
+						std::numeric_limits<float>::quiet_NaN();
+				});
+			});
+		}
+
+		void BackPropagationAlgorithm::ApplyAsyncTestResult(const ModelTestResult &result, float &trainError, float &slidingTestError, float &minTestError) {
+#if NNETS_TELEMETRY
+			int testedSamplesCount = _trainDataIterator->Size() + (IsTestDataAvailable() ? _testDataSize : 0);
+			TELEMETRY_TIME(Telemetry, EvaluationPhase, result.Seconds);
+			TELEMETRY_WORK(Telemetry, EvaluationPhase, 2.0*_weightsCount*testedSamplesCount, sizeof(float)*_weightsCount*testedSamplesCount);
+#endif
+			trainError = result.TrainError;
+			if (IsTestDataAvailable()) {
+				slidingTestError = _properties->CvSlidingFactor*result.TestError +
+					(1.0f - _properties->CvSlidingFactor)*slidingTestError;
+				if (result.TestError < minTestError) {
+					minTestError = result.TestError;
+				}
+			}
+			OnIterationCompleted(result.IterationNum, result.TrainError, result.TestError);
+		}
+
+		float* BackPropagationAlgorithm::GetInput(const StandardTypesNative::TrainPair *trainPair, float *normalizedInput) const {
+			if (_inputNormalization == 0) {
+				return trainPair->Input();
+			}
+			_inputNormalization->CopyNormalizedInputVector(trainPair->Input(), normalizedInput);
+			return normalizedInput;
+		}
+
+		float BackPropagationAlgorithm::TestModel(MultyLayerPerceptron *neuralNet, float *input, float *output, StandardTypesNative::TrainPair **data, int dataSize) const {
 			float sumError = 0.0f;
 			for (int i = 0; i < dataSize; i++) {
 				TrainPair *trainPair = data[i];
-				_neuronNetInput = trainPair->Input();
-				_neuralNet->Predict(_neuronNetInput, _neuronNetOutput);
-				sumError += _properties->Metrics->Calculate(trainPair->Output(), _neuronNetOutput, _outputSize);
+				neuralNet->Predict(GetInput(trainPair, input), output);
+				sumError += _properties->Metrics->Calculate(trainPair->Output(), output, _outputSize);
 			}
 			return sumError/dataSize;
 		}
 
+		float BackPropagationAlgorithm::EvaluateModel(StandardTypesNative::TrainPair **data, int dataSize) {
+			TELEMETRY_SCOPE(Telemetry, EvaluationPhase);
+			TELEMETRY_WORK(Telemetry, EvaluationPhase, 2.0*_weightsCount*dataSize, sizeof(float)*_weightsCount*dataSize);
+			return TestModel(_neuralNet, _normalizedInput, _neuronNetOutput, data, dataSize);
+		}
+
 		void BackPropagationAlgorithm::TrainEpoch(void) {
-			_trainDataIterator->RefreshRandomAccess();
+			{
+				TELEMETRY_SCOPE(Telemetry, ShufflePhase);
+				_trainDataIterator->RefreshRandomAccess();
+			}
 			for (int i = 0; i < _packagesCount; i++) {
 				TrainPackage();
 			}
 		}
 
 		void BackPropagationAlgorithm::TrainPackage(void) {
+			double forwardSeconds = 0.0;
+			_backwardSeconds = 0.0;
+			_gradientSeconds = 0.0;
 			for (int i = 0; i < _properties->PackageSize; i++) {
 				TrainPair *trainPair = _trainDataIterator->Next();
-				_neuronNetInput = trainPair->Input();
+				double time = TELEMETRY_NOW();
+				_neuronNetInput = GetInput(trainPair, _normalizedInput);
 				_neuralNet->Predict(_neuronNetInput, _neuronNetOutput);
+				TELEMETRY_LAP(forwardSeconds, time);
 				_properties->Metrics->CalculatePartialDerivaitve(trainPair->Output(), _neuronNetOutput, _partialDerivaitve, _outputSize);
+				TELEMETRY_LAP(_backwardSeconds, time);
 				CollectWeightsDelta(_partialDerivaitve);
 			}
-			ModifyWeightsOfNeuronNet();
+			TELEMETRY_TIME(Telemetry, ForwardPhase, forwardSeconds);
+			TELEMETRY_TIME(Telemetry, BackwardPhase, _backwardSeconds);
+			TELEMETRY_TIME(Telemetry, GradientPhase, _gradientSeconds);
+			{
+				TELEMETRY_SCOPE(Telemetry, UpdatePhase);
+				ModifyWeightsOfNeuronNet();
+			}
+			AddPackageWork();
+		}
+
+		void BackPropagationAlgorithm::AddPackageWork(void) {
+#if NNETS_TELEMETRY
+			double packageSize = _properties->PackageSize;
+			TELEMETRY_SAMPLES(Telemetry, _properties->PackageSize);
+			TELEMETRY_WORK(Telemetry, ForwardPhase, 2.0*_weightsCount*packageSize, sizeof(float)*_weightsCount*packageSize);
+			TELEMETRY_WORK(Telemetry, BackwardPhase, 2.0*_backwardWeightsCount*packageSize, sizeof(float)*_backwardWeightsCount*packageSize);
+			TELEMETRY_WORK(Telemetry, GradientPhase, 2.0*_weightsCount*packageSize, 2*sizeof(float)*_weightsCount*packageSize);
+			TELEMETRY_WORK(Telemetry, UpdatePhase, 12.0*_weightsCount, 10*sizeof(float)*_weightsCount);
+#endif
 		}
 
 		void BackPropagationAlgorithm::CollectWeightsDelta(const float *errrorVector) {
@@ -268,9 +422,11 @@ namespace NeuralNetNative {
 			float *packageDerivative = _packageDerivative[layerNum];
 			float *packageDerivativeForBias = _packageDerivativeForBias[layerNum];
 
+			double time = TELEMETRY_NOW();
 			(*localGradientfunction)(curGradients, curLayer->GetActivationFunction(), curLayer->GetState(), partialDerivaitve, nextGradients, nextLayerWeights, curLayerSize, nextLayerSize);
-			
-			parallel_for( blocked_range<size_t>(0, curLayerSize, BPACollectWeightsGrainSize),
+			TELEMETRY_LAP(_backwardSeconds, time);
+
+			DispatchFor(curLayerSize, prevLayerSize, 2*sizeof(float),
 			[=](const blocked_range<size_t>& r)
 			{
 				for (int i = r.begin(); i < r.end(); i++) {
@@ -282,6 +438,7 @@ namespace NeuralNetNative {
 					packageDerivativeForBias[i] -= localGradient;
 				}
 			});
+			TELEMETRY_LAP(_gradientSeconds, time);
 						
 			_gradients = curGradients;
 			_gradientsIntermediate = nextGradients;
@@ -305,7 +462,7 @@ namespace NeuralNetNative {
 				float *derivativeAveragesForBias = _derivativeAveragesForBias[layerNum];
 				float curLearnSpeed = _properties->BaseLearnSpeed*_properties->FactorStrategy->GetFactor(_epochNumber);
 
-				parallel_for( blocked_range<size_t>(0, curLayerSize, BPAModifyWeightsGrainSize),
+				DispatchFor(curLayerSize, prevLayerSize, 10*sizeof(float),
 				[=](const blocked_range<size_t>& r)
 				{
 					for (int i = r.begin(); i < r.end(); i++) {
@@ -343,6 +500,7 @@ namespace NeuralNetNative {
 						curLayerBias[i] += (1.0f + _properties->Momentum)*newDeltaForBias;
 					}
 				});
+				curLayer->RefreshWeightReplicas();
 			}
 		}
 
@@ -354,16 +512,15 @@ namespace NeuralNetNative {
 
 		void BackPropagationAlgorithm::LocalGradientForHiddenLayer(float *gradientsOutput, ActivationFunction *function, float *state, const float *errors,
 				float *nextLayerGradients, float *nextLayerOldWeights, int curLayerSize, int nextLayerSize) {
-			for (int neuronNum = 0; neuronNum < curLayerSize; neuronNum++) {
-				gradientsOutput[neuronNum] = 0.0f;
-			}
-
-			parallel_for( blocked_range<size_t>(0, nextLayerSize, BPALocalGradientGrainSize),
+			DispatchFor(curLayerSize, nextLayerSize, sizeof(float),
 			[=](const blocked_range<size_t>& r)
 			{
-				for (int j = r.begin(); j < r.end(); j++) {
+				for (int neuronNum = r.begin(); neuronNum < r.end(); neuronNum++) {
+					gradientsOutput[neuronNum] = 0.0f;
+				}
+				for (int j = 0; j < nextLayerSize; j++) {
 					float nextLayerGradient = nextLayerGradients[j];
-					for (int neuronNum = 0; neuronNum < curLayerSize; neuronNum++) {
+					for (int neuronNum = r.begin(); neuronNum < r.end(); neuronNum++) {
 						gradientsOutput[neuronNum] += nextLayerGradient*nextLayerOldWeights[curLayerSize*j + neuronNum];
 					}
 				}
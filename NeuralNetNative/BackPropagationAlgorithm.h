@@ -5,10 +5,14 @@
 #include "TrainProperties.h"
 #include "RandomAccessIterator.h"
 #include "TrainPair.h"
+#include "NormalizeMethod.h"
 #include "MultyLayerPerceptron.h"
 #include "ActivationFunction.h"
 
 namespace NeuralNetNative {
+	class AsyncModelTester;
+	struct ModelTestResult;
+
 	namespace MultyLayerPerceptron {
 		typedef void (*LocalGradient)(float *gradientsOutput, ActivationFunction *function, float *net, const float *errors,
 			float *nextLayerGradients, float *nextLayerOldWeights, int curLayerSize, int nextLayerSize);
@@ -26,6 +30,8 @@ namespace NeuralNetNative {
 			int _outputSize;
 			float *_neuronNetOutput;
 			float *_neuronNetInput;
+			StandardTypesNative::NormalizeMethod *_inputNormalization;
+			float *_normalizedInput;
 			float *_partialDerivaitve;
 			float **_oldDeltaWeights;
 			float **_derivativeAverages;
@@ -40,25 +46,43 @@ namespace NeuralNetNative {
 			float _packageFactor;
 			float _epochNumber;
 			int _packagesCount;
+			double _weightsCount;
+			double _backwardWeightsCount;
+			// Time of the local gradients and of the weight derivatives of the current package.
+			double _backwardSeconds;
+			double _gradientSeconds;
+			AsyncModelTester *_asyncTester;
+			MultyLayerPerceptron *_snapshotNeuralNet;
+			float *_snapshotOutput;
+			float *_snapshotInput;
 		public:
 			BackPropagationAlgorithm(StandardTypesNative::TrainPair **trainData, int trainDataSize);
 			BackPropagationAlgorithm(StandardTypesNative::TrainPair **trainData, int trainDataSize, StandardTypesNative::TrainPair **testData, int testDataSize);
-			~BackPropagationAlgorithm(void);
+			virtual ~BackPropagationAlgorithm(void);
 			virtual void InitilazeMethod(NeuralNet *neuralNet, TrainProperties *trainProperties);
 			virtual TrainProperties* Properties(void) const;
+			// The network is trained and tested on the inputs normalized by the method, which must have collected
+			// its statistics; the data itself is not rewritten. 0 feeds the inputs as they are. Set before InitilazeMethod.
+			void SetInputNormalization(StandardTypesNative::NormalizeMethod *inputNormalization);
 		private:
 			void AllocateMemory(void);
             bool IsTestDataAvailable() const;
             void RunTraingWithTesting(void);
             void RunTraingWithoutTesting(void);
+            void RunTraingWithAsyncTesting(void);
+            void StartAsyncTesting(void);
+            void ApplyAsyncTestResult(const ModelTestResult &result, float &trainError, float &slidingTestError, float &minTestError);
 			int CalculatePackagesCount(void);
 			int FindMaxSize(void);
 			virtual void RunIterativeProcess(void);
 			virtual void ApplyResults(void);
 			void ClearData(void);
-			float TestModel(StandardTypesNative::TrainPair **data, int dataSize);
+			float* GetInput(const StandardTypesNative::TrainPair *trainPair, float *normalizedInput) const;
+			float TestModel(MultyLayerPerceptron *neuralNet, float *input, float *output, StandardTypesNative::TrainPair **data, int dataSize) const;
+			float EvaluateModel(StandardTypesNative::TrainPair **data, int dataSize);
 			void TrainEpoch(void);
 			void TrainPackage(void);
+			void AddPackageWork(void);
 			void CollectWeightsDelta(const float *errrorVector);
 			void CollectWeightsDeltaOfLayer(int layerNum, LocalGradient localGradientfunction, const float *errorVector);
 			void ModifyWeightsOfNeuronNet(void);
@@ -1,6 +1,7 @@
 #define NEURALNETNATIVEAPI
 #include "BaseNeuralBlock.h"
-#include "malloc.h"
+#include "Platform.h"
+#include <algorithm>
 
 namespace NeuralNetNative {
 	BaseNeuralBlock::BaseNeuralBlock(int size, BaseNeuralBlock *parent, ActivationFunction *function) {
@@ -12,7 +13,8 @@ namespace NeuralNetNative {
 		Bias = (float*)_mm_malloc(size*sizeof(float), 32);
         State = (float*)_mm_malloc(size*sizeof(float), 32);
         Net = (float*)_mm_malloc(size*sizeof(float), 32);
-		Weights = (float*)_mm_malloc(size*PreviousSize*sizeof(float), 32);
+		Weights = NumaMemory::Allocate(size, PreviousSize, LocalNode);
+		WeightReplicas = 0;
     }
 
     BaseNeuralBlock::BaseNeuralBlock(int size, int previousSize, ActivationFunction *function) {
@@ -24,7 +26,8 @@ namespace NeuralNetNative {
 		Bias = (float*)_mm_malloc(size*sizeof(float), 32);
         State = (float*)_mm_malloc(size*sizeof(float), 32);
         Net = (float*)_mm_malloc(size*sizeof(float), 32);
-		Weights = (float*)_mm_malloc(size*PreviousSize*sizeof(float), 32);
+		Weights = NumaMemory::Allocate(size, PreviousSize, LocalNode);
+		WeightReplicas = 0;
     }
 
 	BaseNeuralBlock::~BaseNeuralBlock() {
@@ -35,7 +38,8 @@ namespace NeuralNetNative {
 		_mm_free(Bias);
 		_mm_free(State);
 		_mm_free(Net);
-		_mm_free(Weights);
+		SetWeightReplicas(false);
+		NumaMemory::Free(Weights);
 	}
 
     float* BaseNeuralBlock::GetState(void) {
@@ -55,10 +59,61 @@ namespace NeuralNetNative {
     }
 
     void BaseNeuralBlock::SetWeights(float *newWeights) {
-        if (Weights != 0) {
-			_mm_free(Weights);
-		}
-		Weights = newWeights;
+        // The block still takes over a buffer allocated with _mm_malloc, but keeps the weights in its
+        // own placed buffer.
+        std::copy(newWeights, newWeights + Size*PreviousSize, Weights);
+        _mm_free(newWeights);
+		RefreshWeightReplicas();
+    }
+
+    const float* BaseNeuralBlock::GetReadWeights(void) {
+        if (WeightReplicas == 0) {
+            return Weights;
+        }
+        return WeightReplicas[NumaMemory::GetCurrentNode()];
+    }
+
+    NumaPlacement BaseNeuralBlock::GetWeightsPlacement(void) {
+        return NumaMemory::GetPlacement(Weights);
+    }
+
+    void BaseNeuralBlock::SetWeightsPlacement(NumaPlacement placement) {
+        float *newWeights = NumaMemory::Allocate(Size, PreviousSize, placement);
+        std::copy(Weights, Weights + Size*PreviousSize, newWeights);
+        NumaMemory::Free(Weights);
+        Weights = newWeights;
+    }
+
+    bool BaseNeuralBlock::HasWeightReplicas(void) {
+        return (WeightReplicas != 0);
+    }
+
+    void BaseNeuralBlock::SetWeightReplicas(bool enabled) {
+        int nodesCount = NumaMemory::GetNodesCount();
+        if (enabled && (WeightReplicas == 0) && (nodesCount > 1)) {
+            WeightReplicas = new float*[nodesCount];
+            for (int node = 0; node < nodesCount; node++) {
+                WeightReplicas[node] = NumaMemory::AllocateOnNode(Size*PreviousSize, node);
+            }
+            RefreshWeightReplicas();
+        }
+        else if (!enabled && (WeightReplicas != 0)) {
+            for (int node = 0; node < nodesCount; node++) {
+                NumaMemory::Free(WeightReplicas[node]);
+            }
+            delete[] WeightReplicas;
+            WeightReplicas = 0;
+        }
+    }
+
+    void BaseNeuralBlock::RefreshWeightReplicas(void) {
+        if (WeightReplicas == 0) {
+            return;
+        }
+        int nodesCount = NumaMemory::GetNodesCount();
+        for (int node = 0; node < nodesCount; node++) {
+            std::copy(Weights, Weights + Size*PreviousSize, WeightReplicas[node]);
+        }
     }
 
     float* BaseNeuralBlock::GetBias(void) {
@@ -76,4 +131,14 @@ namespace NeuralNetNative {
 	int BaseNeuralBlock::GetPreviousSize(void) {
         return PreviousSize;
     }
+
+	void BaseNeuralBlock::CopyParametersTo(BaseNeuralBlock *target) {
+		if (target->GetWeightsPlacement() != GetWeightsPlacement()) {
+			target->SetWeightsPlacement(GetWeightsPlacement());
+		}
+		target->SetWeightReplicas(HasWeightReplicas());
+		std::copy(Weights, Weights + Size*PreviousSize, target->Weights);
+		std::copy(Bias, Bias + Size, target->Bias);
+		target->RefreshWeightReplicas();
+	}
 }
\ No newline at end of file
@@ -2,6 +2,7 @@
 
 #include "ExportDll.h"
 #include "ActivationFunction.h"
+#include "NumaMemory.h"
 
 namespace NeuralNetNative {
 	class NEURALNETNATIVE_EXPORT BaseNeuralBlock {
@@ -14,6 +15,7 @@ namespace NeuralNetNative {
         float *Bias;
         float *State;
         float *Net;
+        float **WeightReplicas;
 	protected: 
 		BaseNeuralBlock(int size, BaseNeuralBlock *parent, ActivationFunction *function);
         BaseNeuralBlock(int size, int parentSize, ActivationFunction *function);
@@ -24,11 +26,19 @@ namespace NeuralNetNative {
         BaseNeuralBlock* GetParent(void);
         float* GetWeights(void);
         void SetWeights(float *newWeights);
+        const float* GetReadWeights(void);
+        NumaPlacement GetWeightsPlacement(void);
+        void SetWeightsPlacement(NumaPlacement placement);
+        bool HasWeightReplicas(void);
+        void SetWeightReplicas(bool enabled);
+        void RefreshWeightReplicas(void);
         float* GetBias(void);
         ActivationFunction* GetActivationFunction(void);
         int GetSize(void);
 		int GetPreviousSize(void);
         virtual void Calculate(void) = 0;
         virtual void Calculate(const float *input) = 0;
+        virtual BaseNeuralBlock* Clone(BaseNeuralBlock *parent) = 0;
+        void CopyParametersTo(BaseNeuralBlock *target);
 	};
 }
\ No newline at end of file
@@ -1,10 +1,11 @@
 #define NEURALNETNATIVEAPI
-#include <mathimf.h>
+#include "Platform.h"
 #include <immintrin.h>
-#include <tbb\tbb.h>
-#include <tbb\task_scheduler_init.h>
-#include <tbb\parallel_for.h>
-#include <tbb\blocked_range.h>
+#include <tbb/tbb.h>
+#include <tbb/parallel_for.h>
+#include <tbb/blocked_range.h>
+#include "ParallelDispatch.h"
+#include "MatrixKernels.h"
 #include <algorithm>
 #include "BinaryBinaryRbm.h"
 
@@ -14,24 +15,28 @@ namespace NeuralNetNative {
 	namespace RestrictedBoltzmannMachine {
 		BinaryBinaryRbm::BinaryBinaryRbm(int visibleStatesCount, int hiddenStatesCount) : RestrictedBoltzmannMachineBase(visibleStatesCount, hiddenStatesCount) {
 		}
+
+		RestrictedBoltzmannMachineBase* BinaryBinaryRbm::Clone(void) {
+			BinaryBinaryRbm *rbm = new BinaryBinaryRbm(_visibleStatesCount, _hiddenStatesCount);
+			rbm->EnableTransposedWeights(_transposedWeights != 0);
+			CopyParametersTo(rbm);
+			return rbm;
+		}
 		
 		void BinaryBinaryRbm::VisibleLayerCalculateActivity(void) {
-            std::copy(_visibleStatesBias, _visibleStatesBias + _visibleStatesCount, _visibleStates);
-
-			for (int j = 0; j < _hiddenStatesCount; j++) {
-				float hiddenState = _hiddenStates[j];
-				for (int i = 0; i < _visibleStatesCount; i++) {
-					_visibleStates[i] += hiddenState*_weights[j*_visibleStatesCount + i];
-				}
+			if (_transposedWeights != 0) {
+				MatrixKernels::MultiplyTransposed(_hiddenStates, _transposedWeights, _visibleStatesBias, _visibleStates,
+				                                  1, _visibleStatesCount, _hiddenStatesCount);
 			}
-
-			for (int i = 0; i < _visibleStatesCount; i++) {
-				_visibleStates[i] = 1.0f/(1.0f + expf(-_visibleStates[i]));
+			else {
+				MatrixKernels::Multiply(_hiddenStates, _weights, _visibleStatesBias, _visibleStates,
+				                        1, _visibleStatesCount, _hiddenStatesCount);
 			}
+			VisibleLayerActivation(_visibleStates, 1);
 		}
 
 		void BinaryBinaryRbm::HiddenLayerCalculateActivity(void) {
-			parallel_for( blocked_range<size_t>(0, _hiddenStatesCount),
+			DispatchFor(_hiddenStatesCount, _visibleStatesCount, sizeof(float),
 			[=](const blocked_range<size_t>& r)
 			{
 				for (int j = r.begin(); j < r.end(); j++) {
@@ -39,13 +44,14 @@ namespace NeuralNetNative {
 					for (int i = 0; i < _visibleStatesCount; i++) {
 						sum += _visibleStates[i]*_weights[j*_visibleStatesCount + i];
 					}
-					_hiddenStates[j] = 1.0f/(1.0f + expf(-sum));
+					_hiddenStates[j] = sum;
 				}
 			});
+			HiddenLayerActivation(_hiddenStates, 1);
 		}
 
 		void BinaryBinaryRbm::HiddenLayerCalculateActivity(const float *newVisibleState) {
-			parallel_for( blocked_range<size_t>(0, _hiddenStatesCount),
+			DispatchFor(_hiddenStatesCount, _visibleStatesCount, sizeof(float),
 			[=](const blocked_range<size_t>& r)
 			{
 				for (int j = r.begin(); j < r.end(); j++) {
@@ -53,9 +59,10 @@ namespace NeuralNetNative {
 					for (int i = 0; i < _visibleStatesCount; i++) {
 						sum += newVisibleState[i]*_weights[j*_visibleStatesCount + i];
 					}
-					_hiddenStates[j] = 1.0f/(1.0f + expf(-sum));
+					_hiddenStates[j] = sum;
 				}
 			});
+			HiddenLayerActivation(_hiddenStates, 1);
 		}
 
 		void BinaryBinaryRbm::VisibleLayerCalculateActivity(const float *addedWeight, const float *addedVisibleBias) {
@@ -71,13 +78,11 @@ namespace NeuralNetNative {
 				}
 			}
 
-			for (int i = 0; i < _visibleStatesCount; i++) {
-				_visibleStates[i] = 1.0f/(1.0f + expf(-_visibleStates[i]));
-			}
+			VisibleLayerActivation(_visibleStates, 1);
 		}
 
 		void BinaryBinaryRbm::HiddenLayerCalculateActivity(const float *addedWeight, const float *addedHiddenBias) {
-			parallel_for( blocked_range<size_t>(0, _hiddenStatesCount),
+			DispatchFor(_hiddenStatesCount, _visibleStatesCount, 2*sizeof(float),
 			[=](const blocked_range<size_t>& r)
 			{
 				for (int j = r.begin(); j < r.end(); j++) {
@@ -86,13 +91,14 @@ namespace NeuralNetNative {
 						sum += _visibleStates[i]*(_weights[j*_visibleStatesCount + i] +
                                addedWeight[j*_visibleStatesCount + i]);
 					}
-					_hiddenStates[j] = 1.0f/(1.0f + expf(-sum));
+					_hiddenStates[j] = sum;
 				}
 			});
+			HiddenLayerActivation(_hiddenStates, 1);
 		}
 
 		void BinaryBinaryRbm::HiddenLayerCalculateActivity(const float *newVisibleState, const float *addedWeight, const float *addedHiddenBias) {
-			parallel_for( blocked_range<size_t>(0, _hiddenStatesCount),
+			DispatchFor(_hiddenStatesCount, _visibleStatesCount, 2*sizeof(float),
 			[=](const blocked_range<size_t>& r)
 			{
 				for (int j = r.begin(); j < r.end(); j++) {
@@ -101,9 +107,102 @@ namespace NeuralNetNative {
 						sum += newVisibleState[i]*(_weights[j*_visibleStatesCount + i] +
                                addedWeight[j*_visibleStatesCount + i]);
 					}
-					_hiddenStates[j] = 1.0f/(1.0f + expf(-sum));
+					_hiddenStates[j] = sum;
 				}
 			});
+			HiddenLayerActivation(_hiddenStates, 1);
+		}
+
+		void BinaryBinaryRbm::HiddenLayerCalculateActivity(const float *newVisibleState, const RbmParameters &parameters) {
+			MatrixKernels::MultiplyTransposed(newVisibleState, parameters.Weights, parameters.HiddenStatesBias, _hiddenStates,
+			                                  1, _hiddenStatesCount, _visibleStatesCount);
+			HiddenLayerActivation(_hiddenStates, 1);
+		}
+
+		void BinaryBinaryRbm::VisibleLayerCalculateActivity(const RbmParameters &parameters) {
+			MatrixKernels::Multiply(_hiddenStates, parameters.Weights, parameters.VisibleStatesBias, _visibleStates,
+			                        1, _visibleStatesCount, _hiddenStatesCount);
+			VisibleLayerActivation(_visibleStates, 1);
+		}
+
+		void BinaryBinaryRbm::HiddenLayerCalculateActivity(const float *visibleStatesBatch, float *hiddenStatesBatch, int batchSize) {
+			HiddenLayerCalculatePotentials(visibleStatesBatch, hiddenStatesBatch, batchSize);
+			HiddenLayerActivation(hiddenStatesBatch, batchSize);
+		}
+
+		void BinaryBinaryRbm::VisibleLayerCalculateActivity(const float *hiddenStatesBatch, float *visibleStatesBatch, int batchSize) {
+			MatrixKernels::Multiply(hiddenStatesBatch, _weights, _visibleStatesBias, visibleStatesBatch,
+			                        batchSize, _visibleStatesCount, _hiddenStatesCount);
+			VisibleLayerActivation(visibleStatesBatch, batchSize);
+		}
+
+		void BinaryBinaryRbm::HiddenLayerCalculateActivity(const float *visibleStatesBatch, float *hiddenStatesBatch, int batchSize,
+		                                                   const RbmParameters &parameters) {
+			MatrixKernels::MultiplyTransposed(visibleStatesBatch, parameters.Weights, parameters.HiddenStatesBias, hiddenStatesBatch,
+			                                  batchSize, _hiddenStatesCount, _visibleStatesCount);
+			HiddenLayerActivation(hiddenStatesBatch, batchSize);
+		}
+
+		void BinaryBinaryRbm::VisibleLayerCalculateActivity(const float *hiddenStatesBatch, float *visibleStatesBatch, int batchSize,
+		                                                    const RbmParameters &parameters) {
+			MatrixKernels::Multiply(hiddenStatesBatch, parameters.Weights, parameters.VisibleStatesBias, visibleStatesBatch,
+			                        batchSize, _visibleStatesCount, _hiddenStatesCount);
+			VisibleLayerActivation(visibleStatesBatch, batchSize);
+		}
+
+		void BinaryBinaryRbm::VisibleLayerCalculateActivity(const float *hiddenStatesBatch, float *visibleStatesBatch, int batchSize,
+		                                                    const float *inverseTemperatures) {
+			MatrixKernels::Multiply(hiddenStatesBatch, _weights, _visibleStatesBias, visibleStatesBatch,
+			                        batchSize, _visibleStatesCount, _hiddenStatesCount);
+			MatrixKernels::ScaleRows(visibleStatesBatch, inverseTemperatures, batchSize, _visibleStatesCount);
+			VisibleLayerActivation(visibleStatesBatch, batchSize);
+		}
+
+		void BinaryBinaryRbm::HiddenLayerCalculateActivity(const PackedStates &visibleStatesBatch, float *hiddenStatesBatch, int batchSize) {
+			if (_transposedWeights != 0) {
+				MatrixKernels::MultiplyPacked(visibleStatesBatch.GetWords(), visibleStatesBatch.GetWordsPerRow(), _transposedWeights,
+				                              _hiddenStatesBias, hiddenStatesBatch, batchSize, _hiddenStatesCount, _visibleStatesCount);
+			}
+			else {
+				MatrixKernels::MultiplyTransposedPacked(visibleStatesBatch.GetWords(), visibleStatesBatch.GetWordsPerRow(), _weights,
+				                                        _hiddenStatesBias, hiddenStatesBatch, batchSize, _hiddenStatesCount, _visibleStatesCount);
+			}
+			HiddenLayerActivation(hiddenStatesBatch, batchSize);
+		}
+
+		void BinaryBinaryRbm::VisibleLayerCalculateActivity(const PackedStates &hiddenStatesBatch, float *visibleStatesBatch, int batchSize) {
+			MatrixKernels::MultiplyPacked(hiddenStatesBatch.GetWords(), hiddenStatesBatch.GetWordsPerRow(), _weights,
+			                              _visibleStatesBias, visibleStatesBatch, batchSize, _visibleStatesCount, _hiddenStatesCount);
+			VisibleLayerActivation(visibleStatesBatch, batchSize);
+		}
+
+		bool BinaryBinaryRbm::SupportsPackedStates(void) const {
+			return true;
+		}
+
+		void BinaryBinaryRbm::CalculateVisibleEnergies(const float *visibleStatesBatch, const float *visibleBias, float *energies, int batchSize) {
+			DispatchFor(batchSize, _visibleStatesCount, 2*sizeof(float),
+			[=](const blocked_range<size_t>& r)
+			{
+				for (int b = r.begin(); b < r.end(); b++) {
+					const float *visibleStates = visibleStatesBatch + (size_t)b*_visibleStatesCount;
+					float energy = 0.0f;
+					for (int i = 0; i < _visibleStatesCount; i++) {
+						energy -= visibleBias[i]*visibleStates[i];
+					}
+					energies[b] = energy;
+				}
+			});
+		}
+
+		void BinaryBinaryRbm::VisibleLayerActivation(float *visibleStatesBatch, int batchSize) {
+			MatrixKernels::Sigmoid(visibleStatesBatch, batchSize*_visibleStatesCount);
+		}
+
+		float BinaryBinaryRbm::CalculateIndependentLogPartitionFunction(const float *visibleBias) {
+			float logPartitionFunction = 0.0f;
+			MatrixKernels::AddSoftplusRowSums(visibleBias, 1.0f, 1.0f, &logPartitionFunction, 1, _visibleStatesCount);
+			return logPartitionFunction + _hiddenStatesCount*logf(2.0f);
 		}
 	}
 }
\ No newline at end of file
@@ -8,12 +8,31 @@ namespace NeuralNetNative {
 		class NEURALNETNATIVE_EXPORT BinaryBinaryRbm : public RestrictedBoltzmannMachineBase {
 		public:
 			BinaryBinaryRbm(int visibleStatesCount, int hiddenStatesCount);
+			virtual RestrictedBoltzmannMachineBase* Clone(void);
 			virtual void VisibleLayerCalculateActivity(void);
 			virtual void HiddenLayerCalculateActivity(void);
 			virtual void HiddenLayerCalculateActivity(const float *newVisibleState);
 			virtual void VisibleLayerCalculateActivity(const float *addedWeight, const float *addedVisibleBias);
 			virtual void HiddenLayerCalculateActivity(const float *addedWeight, const float *addedHiddenBias);
 			virtual void HiddenLayerCalculateActivity(const float *newVisibleState, const float *addedWeight, const float *addedHiddenBias);
+			virtual void HiddenLayerCalculateActivity(const float *newVisibleState, const RbmParameters &parameters);
+			virtual void VisibleLayerCalculateActivity(const RbmParameters &parameters);
+			virtual void HiddenLayerCalculateActivity(const float *visibleStatesBatch, float *hiddenStatesBatch, int batchSize);
+			virtual void VisibleLayerCalculateActivity(const float *hiddenStatesBatch, float *visibleStatesBatch, int batchSize);
+			virtual void HiddenLayerCalculateActivity(const float *visibleStatesBatch, float *hiddenStatesBatch, int batchSize,
+			                                          const RbmParameters &parameters);
+			virtual void VisibleLayerCalculateActivity(const float *hiddenStatesBatch, float *visibleStatesBatch, int batchSize,
+			                                           const RbmParameters &parameters);
+			virtual void VisibleLayerCalculateActivity(const float *hiddenStatesBatch, float *visibleStatesBatch, int batchSize,
+			                                           const float *inverseTemperatures);
+			virtual void HiddenLayerCalculateActivity(const PackedStates &visibleStatesBatch, float *hiddenStatesBatch, int batchSize);
+			virtual void VisibleLayerCalculateActivity(const PackedStates &hiddenStatesBatch, float *visibleStatesBatch, int batchSize);
+			virtual bool SupportsPackedStates(void) const;
+			virtual void CalculateVisibleEnergies(const float *visibleStatesBatch, const float *visibleBias, float *energies, int batchSize);
+			virtual float CalculateIndependentLogPartitionFunction(const float *visibleBias);
+		protected:
+			// Turns batchSize rows of visible potentials into the visible activities in place.
+			virtual void VisibleLayerActivation(float *visibleStatesBatch, int batchSize);
 		};
 	}
 }
\ No newline at end of file
@@ -0,0 +1,31 @@
+#define NEURALNETNATIVEAPI
+#include "Platform.h"
+#include "BinaryNreluRbm.h"
+
+namespace NeuralNetNative {
+	namespace RestrictedBoltzmannMachine {
+		BinaryNreluRbm::BinaryNreluRbm(int visibleStatesCount, int hiddenStatesCount) : BinaryBinaryRbm(visibleStatesCount, hiddenStatesCount) {
+		}
+
+		RestrictedBoltzmannMachineBase* BinaryNreluRbm::Clone(void) {
+			BinaryNreluRbm *rbm = new BinaryNreluRbm(_visibleStatesCount, _hiddenStatesCount);
+			rbm->EnableTransposedWeights(_transposedWeights != 0);
+			CopyParametersTo(rbm);
+			return rbm;
+		}
+
+		void BinaryNreluRbm::HiddenLayerSampling(void) {
+		}
+
+		void BinaryNreluRbm::HiddenLayerSampling(float *hiddenStatesBatch, int batchSize) {
+		}
+
+		bool BinaryNreluRbm::SupportsPackedStates(void) const {
+			return false;
+		}
+
+		void BinaryNreluRbm::HiddenLayerActivation(float *hiddenStatesBatch, int batchSize) {
+			_random->NoisyRectifier(hiddenStatesBatch, batchSize*_hiddenStatesCount);
+		}
+	}
+}
@@ -1,12 +1,13 @@
 #define NEURALNETNATIVEAPI
 
 #include "CenteredGradient.h"
-#include <tbb\tbb.h>
-#include <tbb\task_scheduler_init.h>
-#include <tbb\parallel_for.h>
-#include <tbb\blocked_range.h>
+#include <tbb/tbb.h>
+#include <tbb/parallel_for.h>
+#include <tbb/blocked_range.h>
+#include "ParallelDispatch.h"
+#include "MatrixKernels.h"
 #include <algorithm>
-#include <malloc.h>
+#include "Platform.h"
 
 using namespace tbb;
 
@@ -23,7 +24,7 @@ namespace NeuralNetNative {
             _hiddenOffsets = (float*)_mm_malloc(hiddenOffsetsCount*sizeof(float), 32);
             std::copy(hiddenOffsets, hiddenOffsets + hiddenOffsetsCount, _hiddenOffsets);
 
-            _dataVisibleHidden = 0;
+            _shiftedVisibleStates = 0;
         }
 
         CenteredGradient::~CenteredGradient(void) {
@@ -34,31 +35,26 @@ namespace NeuralNetNative {
         }
 
         void CenteredGradient::AllocateMemory(void) {
-            _dataVisibleHidden = (float*)_mm_malloc(VisibleStatesCount*HiddenStatesCount*sizeof(float), 32);
-            _modelVisibleHidden = (float*)_mm_malloc(VisibleStatesCount*HiddenStatesCount*sizeof(float), 32);
+            _shiftedVisibleStates = (float*)_mm_malloc(VisibleStatesCount*sizeof(float), 32);
+            _shiftedHiddenStates = (float*)_mm_malloc(HiddenStatesCount*sizeof(float), 32);
 
-            _dataVisible = (float*)_mm_malloc(VisibleStatesCount*sizeof(float), 32);
-            _modelVisible = (float*)_mm_malloc(VisibleStatesCount*sizeof(float), 32);
-
-            _dataHidden = (float*)_mm_malloc(HiddenStatesCount*sizeof(float), 32);
-            _modelHidden = (float*)_mm_malloc(HiddenStatesCount*sizeof(float), 32);
+            _visibleStatesSums = (float*)_mm_malloc(VisibleStatesCount*sizeof(float), 32);
+            _hiddenStatesSums = (float*)_mm_malloc(HiddenStatesCount*sizeof(float), 32);
 
             _visibleOffsetsNew = (float*)_mm_malloc(VisibleStatesCount*sizeof(float), 32);
             _hiddenOffsetsNew = (float*)_mm_malloc(HiddenStatesCount*sizeof(float), 32);
         }
 
         void CenteredGradient::DeleteMemory(void) {
-            if (_dataVisibleHidden != 0) {
-                _mm_free(_dataVisibleHidden);
-                _mm_free(_modelVisibleHidden);
-                _mm_free(_dataVisible);
-                _mm_free(_modelVisible);
-                _mm_free(_dataHidden);
-                _mm_free(_modelHidden);
+            if (_shiftedVisibleStates != 0) {
+                _mm_free(_shiftedVisibleStates);
+                _mm_free(_shiftedHiddenStates);
+                _mm_free(_visibleStatesSums);
+                _mm_free(_hiddenStatesSums);
                 _mm_free(_visibleOffsetsNew);
                 _mm_free(_hiddenOffsetsNew);
 
-                _dataVisibleHidden = 0;
+                _shiftedVisibleStates = 0;
             }
         }
         
@@ -67,81 +63,122 @@ namespace NeuralNetNative {
 
             std::fill(_visibleOffsetsNew, _visibleOffsetsNew + VisibleStatesCount, 0.0f);
             std::fill(_hiddenOffsetsNew, _hiddenOffsetsNew + HiddenStatesCount, 0.0f);
-			
-            std::fill(_dataVisibleHidden, _dataVisibleHidden + VisibleStatesCount*HiddenStatesCount, 0.0f);
-            std::fill(_modelVisibleHidden, _modelVisibleHidden + VisibleStatesCount*HiddenStatesCount, 0.0f);
-
-            std::fill(_dataHidden, _dataHidden + HiddenStatesCount, 0.0f);
-            std::fill(_modelHidden, _modelHidden + HiddenStatesCount, 0.0f);
-
-            std::fill(_dataVisible, _dataVisible + VisibleStatesCount, 0.0f);
-            std::fill(_modelVisible, _modelVisible + VisibleStatesCount, 0.0f);
         }
         
         void CenteredGradient::StorePositivePhaseData(float *visibleStates, float *hiddenStates) {
-            parallel_for( blocked_range<size_t>(0, HiddenStatesCount),
-			[=](const blocked_range<size_t>& r)
-			{
-               for (int j = r.begin(); j < r.end(); j++) {
-			   	   float shiftedHiddenState = hiddenStates[j] - _hiddenOffsets[j];
-			   	   for (int i = 0; i < VisibleStatesCount; i++) {
-			   	   	   _dataVisibleHidden[j*VisibleStatesCount + i] += (visibleStates[i] - _visibleOffsets[i])*shiftedHiddenState;
-			   	   }
-			   	   _dataHidden[j] += hiddenStates[j];
-			   	   _hiddenOffsetsNew[j] += _packageFactor*hiddenStates[j];
-			   }
-            });
+            AddCenteredProduct(visibleStates, hiddenStates, 1.0f);
 
-            parallel_for( blocked_range<size_t>(0, VisibleStatesCount),
-			[=](const blocked_range<size_t>& r)
-			{
-                for (int i = r.begin(); i < r.end(); i++) {
-			    	_dataVisible[i] += visibleStates[i];
-			    	_visibleOffsetsNew[i] += _packageFactor*visibleStates[i];
-			    }
-            });
+            float *packageDerivativeForHiddenBias = Gradients->GetPackageDerivativeForHiddenBias();
+            float *packageDerivativeForVisibleBias = Gradients->GetPackageDerivativeForVisibleBias();
+            for (int j = 0; j < HiddenStatesCount; j++) {
+                packageDerivativeForHiddenBias[j] += hiddenStates[j];
+                _hiddenOffsetsNew[j] += _packageFactor*hiddenStates[j];
+            }
+            for (int i = 0; i < VisibleStatesCount; i++) {
+                packageDerivativeForVisibleBias[i] += visibleStates[i];
+                _visibleOffsetsNew[i] += _packageFactor*visibleStates[i];
+            }
         }
 
         void CenteredGradient::StoreNegativePhaseData(float *visibleStates, float *hiddenStates) {
-            parallel_for( blocked_range<size_t>(0, HiddenStatesCount),
+            AddCenteredProduct(visibleStates, hiddenStates, -1.0f);
+
+            float *packageDerivativeForHiddenBias = Gradients->GetPackageDerivativeForHiddenBias();
+            float *packageDerivativeForVisibleBias = Gradients->GetPackageDerivativeForVisibleBias();
+            for (int j = 0; j < HiddenStatesCount; j++) {
+                packageDerivativeForHiddenBias[j] -= hiddenStates[j];
+            }
+            for (int i = 0; i < VisibleStatesCount; i++) {
+                packageDerivativeForVisibleBias[i] -= visibleStates[i];
+            }
+        }
+
+        void CenteredGradient::StorePositivePhaseBatch(float *visibleStatesBatch, float *hiddenStatesBatch, int batchSize) {
+            AddCenteredBatch(visibleStatesBatch, hiddenStatesBatch, batchSize, 1.0f);
+
+            float *packageDerivativeForHiddenBias = Gradients->GetPackageDerivativeForHiddenBias();
+            float *packageDerivativeForVisibleBias = Gradients->GetPackageDerivativeForVisibleBias();
+            for (int j = 0; j < HiddenStatesCount; j++) {
+                packageDerivativeForHiddenBias[j] += _hiddenStatesSums[j];
+                _hiddenOffsetsNew[j] += _packageFactor*_hiddenStatesSums[j];
+            }
+            for (int i = 0; i < VisibleStatesCount; i++) {
+                packageDerivativeForVisibleBias[i] += _visibleStatesSums[i];
+                _visibleOffsetsNew[i] += _packageFactor*_visibleStatesSums[i];
+            }
+        }
+
+        void CenteredGradient::StoreNegativePhaseBatch(float *visibleStatesBatch, float *hiddenStatesBatch, int batchSize, float weight) {
+            AddCenteredBatch(visibleStatesBatch, hiddenStatesBatch, batchSize, -weight);
+
+            float *packageDerivativeForHiddenBias = Gradients->GetPackageDerivativeForHiddenBias();
+            float *packageDerivativeForVisibleBias = Gradients->GetPackageDerivativeForVisibleBias();
+            for (int j = 0; j < HiddenStatesCount; j++) {
+                packageDerivativeForHiddenBias[j] -= weight*_hiddenStatesSums[j];
+            }
+            for (int i = 0; i < VisibleStatesCount; i++) {
+                packageDerivativeForVisibleBias[i] -= weight*_visibleStatesSums[i];
+            }
+        }
+
+        void CenteredGradient::AddCenteredProduct(float *visibleStates, float *hiddenStates, float alpha) {
+            for (int i = 0; i < VisibleStatesCount; i++) {
+                _shiftedVisibleStates[i] = visibleStates[i] - _visibleOffsets[i];
+            }
+            for (int j = 0; j < HiddenStatesCount; j++) {
+                _shiftedHiddenStates[j] = alpha*(hiddenStates[j] - _hiddenOffsets[j]);
+            }
+
+            float *packageDerivativeForWeights = Gradients->GetPackageDerivativeForWeights();
+            DispatchFor(HiddenStatesCount, VisibleStatesCount, 2*sizeof(float),
 			[=](const blocked_range<size_t>& r)
 			{
                 for (int j = r.begin(); j < r.end(); j++) {
-			    	float shiftedHiddenState = hiddenStates[j] - _hiddenOffsets[j];
+                    float *derivatives = packageDerivativeForWeights + (size_t)j*VisibleStatesCount;
+			    	float shiftedHiddenState = _shiftedHiddenStates[j];
 			    	for (int i = 0; i < VisibleStatesCount; i++) {
-			    		_modelVisibleHidden[j*VisibleStatesCount + i] += (visibleStates[i] - _visibleOffsets[i])*shiftedHiddenState;
+			    		derivatives[i] += _shiftedVisibleStates[i]*shiftedHiddenState;
 			    	}
-			    	_modelHidden[j] += hiddenStates[j];
 			    }
             });
-            
-            parallel_for( blocked_range<size_t>(0, VisibleStatesCount),
+        }
+
+        // sum over b of (h_b - c)(v_b - a)^T = H^T*V - c*(sv - n*a)^T - sh*a^T, where sv and sh are the
+        // column sums of the batch, so the batch goes through one product without centered copies.
+        void CenteredGradient::AddCenteredBatch(float *visibleStatesBatch, float *hiddenStatesBatch, int batchSize, float alpha) {
+            std::fill(_visibleStatesSums, _visibleStatesSums + VisibleStatesCount, 0.0f);
+            std::fill(_hiddenStatesSums, _hiddenStatesSums + HiddenStatesCount, 0.0f);
+            MatrixKernels::AddColumnSums(visibleStatesBatch, 1.0f, _visibleStatesSums, batchSize, VisibleStatesCount);
+            MatrixKernels::AddColumnSums(hiddenStatesBatch, 1.0f, _hiddenStatesSums, batchSize, HiddenStatesCount);
+            for (int i = 0; i < VisibleStatesCount; i++) {
+                _shiftedVisibleStates[i] = _visibleStatesSums[i] - batchSize*_visibleOffsets[i];
+            }
+
+            float *packageDerivativeForWeights = Gradients->GetPackageDerivativeForWeights();
+            MatrixKernels::AddTransposedProduct(hiddenStatesBatch, visibleStatesBatch, alpha, packageDerivativeForWeights,
+                                                HiddenStatesCount, VisibleStatesCount, batchSize);
+            DispatchFor(HiddenStatesCount, VisibleStatesCount, 2*sizeof(float),
 			[=](const blocked_range<size_t>& r)
 			{
-                for (int i = r.begin(); i < r.end(); i++) {
-			    	_modelVisible[i] += visibleStates[i];
+                for (int j = r.begin(); j < r.end(); j++) {
+                    float *derivatives = packageDerivativeForWeights + (size_t)j*VisibleStatesCount;
+                    float hiddenOffset = alpha*_hiddenOffsets[j];
+                    float hiddenStatesSum = alpha*_hiddenStatesSums[j];
+			    	for (int i = 0; i < VisibleStatesCount; i++) {
+			    		derivatives[i] -= hiddenOffset*_shiftedVisibleStates[i] + hiddenStatesSum*_visibleOffsets[i];
+			    	}
 			    }
             });
         }
 
+        // The derivatives still hold the package sums here. The visible pass reads them unscaled and
+        // the hidden pass scales every row as it goes, so the matrix is not traversed a third time.
         void CenteredGradient::MakeGradient(float packageFactor) {
             float *packageDerivativeForWeights = Gradients->GetPackageDerivativeForWeights();
             float *packageDerivativeForHiddenBias = Gradients->GetPackageDerivativeForHiddenBias();
             float *packageDerivativeForVisibleBias = Gradients->GetPackageDerivativeForVisibleBias();
-            
-            parallel_for( blocked_range<size_t>(0, HiddenStatesCount),
-			[=](const blocked_range<size_t>& r)
-			{
-                for(int j = r.begin(); j < r.end(); j++) {
-			    	int startIndex = j*VisibleStatesCount;
-                    for (int i = 0; i < VisibleStatesCount; i++) {
-			    		packageDerivativeForWeights[startIndex + i] = 
-                            packageFactor*(_dataVisibleHidden[startIndex + i] - _modelVisibleHidden[startIndex + i]);
-			    	}
-			    }
-            });
 
-            parallel_for( blocked_range<size_t>(0, VisibleStatesCount),
+            DispatchFor(VisibleStatesCount, HiddenStatesCount, sizeof(float),
 			[=](const blocked_range<size_t>& r)
 			{
                 for (int i = r.begin(); i < r.end(); i++) {
@@ -149,24 +186,24 @@ namespace NeuralNetNative {
 			    	for (int j = 0; j < HiddenStatesCount; j++) {
 			    		visibleStateSumGradient += _hiddenOffsets[j]*packageDerivativeForWeights[j*VisibleStatesCount + i];
 			    	}
-			    	packageDerivativeForVisibleBias[i] = packageFactor*(_dataVisible[i] - _modelVisible[i]) -
-			    	                                     visibleStateSumGradient;
+			    	packageDerivativeForVisibleBias[i] = packageFactor*(packageDerivativeForVisibleBias[i] - visibleStateSumGradient);
                 
                     _visibleOffsets[i] = (1.0f - _slidingFactor)*_visibleOffsets[i] +
 			    	                     _slidingFactor*_visibleOffsetsNew[i];
 			    }
             });
 
-			parallel_for( blocked_range<size_t>(0, HiddenStatesCount),
+			DispatchFor(HiddenStatesCount, VisibleStatesCount, 2*sizeof(float),
 			[=](const blocked_range<size_t>& r)
 			{
                 for (int j = r.begin(); j < r.end(); j++) {
+                    float *derivatives = packageDerivativeForWeights + (size_t)j*VisibleStatesCount;
 			        float hiddenStateSumGradient = 0.0f;
                     for (int i = 0; i < VisibleStatesCount; i++) {
-			    		hiddenStateSumGradient += _visibleOffsets[i]*packageDerivativeForWeights[j*VisibleStatesCount + i];
+                        derivatives[i] *= packageFactor;
+			    		hiddenStateSumGradient += _visibleOffsets[i]*derivatives[i];
 			    	}
-			    	packageDerivativeForHiddenBias[j] = packageFactor*(_dataHidden[j] - _modelHidden[j]) - 
-			    	                                    hiddenStateSumGradient;
+			    	packageDerivativeForHiddenBias[j] = packageFactor*packageDerivativeForHiddenBias[j] - hiddenStateSumGradient;
                     
                     _hiddenOffsets[j] = (1.0f - _slidingFactor)*_hiddenOffsets[j] +
 			    	                    _slidingFactor*_hiddenOffsetsNew[j];
@@ -174,4 +211,4 @@ namespace NeuralNetNative {
             });
         }
     }
-}
+}
\ No newline at end of file
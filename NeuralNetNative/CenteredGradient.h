@@ -14,22 +14,28 @@ namespace NeuralNetNative {
             virtual void PrepareToNextPackage(int nextPackageSize);
             virtual void StorePositivePhaseData(float *visibleStates, float *hiddenStates);
             virtual void StoreNegativePhaseData(float *visibleStates, float *hiddenStates);
+            virtual void StorePositivePhaseBatch(float *visibleStatesBatch, float *hiddenStatesBatch, int batchSize);
+            virtual void StoreNegativePhaseBatch(float *visibleStatesBatch, float *hiddenStatesBatch, int batchSize, float weight);
             virtual void MakeGradient(float packageFactor);
         protected:
             virtual void AllocateMemory(void);
             virtual void DeleteMemory(void);
         private:
+            // Both phases accumulate into the package derivatives of Gradients: the positive phase adds
+            // and the negative phase subtracts, so no separate data and model statistics are kept.
+            void AddCenteredProduct(float *visibleStates, float *hiddenStates, float alpha);
+            // Adds alpha times the centered statistics of the batch and leaves its column sums in
+            // _visibleStatesSums and _hiddenStatesSums.
+            void AddCenteredBatch(float *visibleStatesBatch, float *hiddenStatesBatch, int batchSize, float alpha);
             float _slidingFactor;
 		    float *_visibleOffsets;
 		    float *_hiddenOffsets;
 		    float *_visibleOffsetsNew;
 		    float *_hiddenOffsetsNew;
-		    float *_dataVisibleHidden;
-		    float *_dataVisible;
-		    float *_dataHidden;
-		    float *_modelVisibleHidden;
-		    float *_modelVisible;
-		    float *_modelHidden;
+		    float *_shiftedVisibleStates;
+		    float *_shiftedHiddenStates;
+		    float *_visibleStatesSums;
+		    float *_hiddenStatesSums;
 		    float _packageFactor;
         };
     }
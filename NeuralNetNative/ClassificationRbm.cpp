@@ -0,0 +1,163 @@
+#define NEURALNETNATIVEAPI
+#include "Platform.h"
+#include <tbb/tbb.h>
+#include <tbb/parallel_for.h>
+#include <tbb/blocked_range.h>
+#include "ParallelDispatch.h"
+#include "ExecutionContext.h"
+#include "MatrixKernels.h"
+#include <algorithm>
+#include "ClassificationRbm.h"
+
+using namespace tbb;
+using namespace NeuralNetNative::RestrictedBoltzmannMachine;
+
+namespace NeuralNetNative {
+	namespace ClassificationRbm {
+		namespace {
+			inline float Softplus(float x) {
+				return fmaxf(x, 0.0f) + log1pf(expf(-fabsf(x)));
+			}
+
+			void Softmax(float *values, int count) {
+				float maxValue = *std::max_element(values, values + count);
+				float sum = 0.0f;
+				for (int k = 0; k < count; k++) {
+					values[k] = expf(values[k] - maxValue);
+					sum += values[k];
+				}
+				for (int k = 0; k < count; k++) {
+					values[k] /= sum;
+				}
+			}
+		}
+
+		ClassificationRbm::ClassificationRbm(int inputsCount, int hiddenStatesCount, int labelsCount)
+			: BinaryBinaryRbm(inputsCount + labelsCount, hiddenStatesCount) {
+			_inputsCount = inputsCount;
+			_labelsCount = labelsCount;
+		}
+
+		RestrictedBoltzmannMachineBase* ClassificationRbm::Clone(void) {
+			ClassificationRbm *rbm = new ClassificationRbm(_inputsCount, _hiddenStatesCount, _labelsCount);
+			rbm->EnableTransposedWeights(_transposedWeights != 0);
+			CopyParametersTo(rbm);
+			return rbm;
+		}
+
+		void ClassificationRbm::VisibleLayerActivation(float *visibleStatesBatch, int batchSize) {
+			DispatchFor(batchSize, _visibleStatesCount, 2*sizeof(float),
+			[=](const blocked_range<size_t>& r)
+			{
+				for (int b = r.begin(); b < r.end(); b++) {
+					float *visibleStates = visibleStatesBatch + (size_t)b*_visibleStatesCount;
+					for (int i = 0; i < _inputsCount; i++) {
+						visibleStates[i] = 1.0f/(1.0f + expf(-visibleStates[i]));
+					}
+					Softmax(visibleStates + _inputsCount, _labelsCount);
+				}
+			});
+		}
+
+		void ClassificationRbm::VisibleLayerSampling(void) {
+			VisibleLayerSampling(_visibleStates, 1);
+		}
+
+		void ClassificationRbm::VisibleLayerSampling(float *visibleStatesBatch, int batchSize) {
+			// One uniform per input and one more per row to pick the label.
+			int uniformsCount = _inputsCount + 1;
+			float *uniforms = (float*)_mm_malloc((size_t)batchSize*uniformsCount*sizeof(float), 32);
+			_random->FillUniform(uniforms, batchSize*uniformsCount);
+			DispatchFor(batchSize, _visibleStatesCount, 2*sizeof(float),
+			[=](const blocked_range<size_t>& r)
+			{
+				for (int b = r.begin(); b < r.end(); b++) {
+					float *visibleStates = visibleStatesBatch + (size_t)b*_visibleStatesCount;
+					const float *rowUniforms = uniforms + (size_t)b*uniformsCount;
+					for (int i = 0; i < _inputsCount; i++) {
+						visibleStates[i] = (rowUniforms[i] < visibleStates[i]) ? 1.0f : 0.0f;
+					}
+					float *labels = visibleStates + _inputsCount;
+					float threshold = rowUniforms[_inputsCount];
+					int label = _labelsCount - 1;
+					float cumulativeProbability = 0.0f;
+					for (int k = 0; k < _labelsCount - 1; k++) {
+						cumulativeProbability += labels[k];
+						if (threshold < cumulativeProbability) {
+							label = k;
+							break;
+						}
+					}
+					std::fill(labels, labels + _labelsCount, 0.0f);
+					labels[label] = 1.0f;
+				}
+			});
+			_mm_free(uniforms);
+		}
+
+		bool ClassificationRbm::SupportsPackedStates(void) const {
+			return false;
+		}
+
+		float ClassificationRbm::CalculateIndependentLogPartitionFunction(const float *visibleBias) {
+			float logPartitionFunction = 0.0f;
+			MatrixKernels::AddSoftplusRowSums(visibleBias, 1.0f, 1.0f, &logPartitionFunction, 1, _inputsCount);
+
+			const float *labelsBias = visibleBias + _inputsCount;
+			float maxBias = *std::max_element(labelsBias, labelsBias + _labelsCount);
+			float sum = 0.0f;
+			for (int k = 0; k < _labelsCount; k++) {
+				sum += expf(labelsBias[k] - maxBias);
+			}
+			return logPartitionFunction + maxBias + logf(sum) + _hiddenStatesCount*logf(2.0f);
+		}
+
+		void ClassificationRbm::CalculateLabelsPosterior(const float *visibleStatesBatch, float *hiddenPotentialsBatch,
+		                                                 float *labelsBatch, int batchSize) {
+			HiddenLayerCalculatePotentials(visibleStatesBatch, hiddenPotentialsBatch, batchSize);
+			const float *labelsBias = _visibleStatesBias + _inputsCount;
+			// log p(y|x) = d_y + sum over j of softplus(W_j*x + c_j + U_jy) - log Z(x)
+			DispatchFor(batchSize, _hiddenStatesCount*_labelsCount, 2*sizeof(float),
+			[=](const blocked_range<size_t>& r)
+			{
+				for (int b = r.begin(); b < r.end(); b++) {
+					const float *hiddenPotentials = hiddenPotentialsBatch + (size_t)b*_hiddenStatesCount;
+					float *labels = labelsBatch + (size_t)b*_labelsCount;
+					std::copy(labelsBias, labelsBias + _labelsCount, labels);
+					for (int j = 0; j < _hiddenStatesCount; j++) {
+						float hiddenPotential = hiddenPotentials[j];
+						const float *labelsWeights = _weights + (size_t)j*_visibleStatesCount + _inputsCount;
+						for (int k = 0; k < _labelsCount; k++) {
+							labels[k] += Softplus(hiddenPotential + labelsWeights[k]);
+						}
+					}
+					Softmax(labels, _labelsCount);
+				}
+			});
+		}
+
+		void ClassificationRbm::PredictLabels(const float *inputBatch, float *labelsBatch, int batchSize) {
+			ExecutionContext::ExecuteIn(_executionContext, [=]() {
+				float *visibleStatesBatch = (float*)_mm_malloc((size_t)batchSize*_visibleStatesCount*sizeof(float), 32);
+				float *hiddenPotentialsBatch = (float*)_mm_malloc((size_t)batchSize*_hiddenStatesCount*sizeof(float), 32);
+				for (int b = 0; b < batchSize; b++) {
+					const float *input = inputBatch + (size_t)b*_inputsCount;
+					float *visibleStates = visibleStatesBatch + (size_t)b*_visibleStatesCount;
+					std::copy(input, input + _inputsCount, visibleStates);
+					std::fill(visibleStates + _inputsCount, visibleStates + _visibleStatesCount, 0.0f);
+				}
+				CalculateLabelsPosterior(visibleStatesBatch, hiddenPotentialsBatch, labelsBatch, batchSize);
+				_mm_free(visibleStatesBatch);
+				_mm_free(hiddenPotentialsBatch);
+			});
+		}
+
+		int ClassificationRbm::GetInputsCount(void) const {
+			return _inputsCount;
+		}
+
+		int ClassificationRbm::GetLabelsCount(void) const {
+			return _labelsCount;
+		}
+	}
+}
@@ -0,0 +1,33 @@
+#pragma once
+
+#include "ExportDll.h"
+#include "BinaryBinaryRbm.h"
+
+namespace NeuralNetNative {
+	namespace ClassificationRbm {
+		// Binary RBM whose visible layer is the input followed by a softmax label layer, so the weights
+		// are one [hidden x (inputs + labels)] matrix and the label bias is the tail of the visible bias.
+		class NEURALNETNATIVE_EXPORT ClassificationRbm : public RestrictedBoltzmannMachine::BinaryBinaryRbm {
+		private:
+			int _inputsCount;
+			int _labelsCount;
+		public:
+			ClassificationRbm(int inputsCount, int hiddenStatesCount, int labelsCount);
+			virtual RestrictedBoltzmannMachine::RestrictedBoltzmannMachineBase* Clone(void);
+			virtual float CalculateIndependentLogPartitionFunction(const float *visibleBias);
+			virtual void VisibleLayerSampling(void);
+			virtual void VisibleLayerSampling(float *visibleStatesBatch, int batchSize);
+			virtual bool SupportsPackedStates(void) const;
+			// p(y|x) of batchSize visible rows whose label parts are zero. hiddenPotentialsBatch receives
+			// W*x + c of every row, labelsBatch the label probabilities.
+			void CalculateLabelsPosterior(const float *visibleStatesBatch, float *hiddenPotentialsBatch,
+			                              float *labelsBatch, int batchSize);
+			// p(y|x) of batchSize input rows of GetInputsCount() values.
+			void PredictLabels(const float *inputBatch, float *labelsBatch, int batchSize);
+			int GetInputsCount(void) const;
+			int GetLabelsCount(void) const;
+		protected:
+			virtual void VisibleLayerActivation(float *visibleStatesBatch, int batchSize);
+		};
+	}
+}
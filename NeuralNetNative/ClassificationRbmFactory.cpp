@@ -0,0 +1,49 @@
+#define NEURALNETNATIVEAPI
+#include "ClassificationRbmFactory.h"
+#include "ClassificationRbm.h"
+#include <random>
+#include <algorithm>
+
+namespace NeuralNetNative {
+	namespace ClassificationRbm {
+		ClassificationRbmFactory::ClassificationRbmFactory(int inputsCount, int hiddenStatesCount, int labelsCount,
+		                                                   StartWeightGenerator startWeightGenerator) {
+			_inputsCount = inputsCount;
+			_hiddenStatesCount = hiddenStatesCount;
+			_labelsCount = labelsCount;
+			_startWeightGenerator = startWeightGenerator;
+		}
+
+		NeuralNet* ClassificationRbmFactory::CreateNeuralNet(void) {
+			ClassificationRbm *neuralNet = new ClassificationRbm(_inputsCount, _hiddenStatesCount, _labelsCount);
+
+			std::random_device rd;
+			std::mt19937 gen(rd());
+
+			int visibleStatesCount = neuralNet->GetVisibleStatesCount();
+			int weightsCount = visibleStatesCount*_hiddenStatesCount;
+			float* weights = neuralNet->GetWeights();
+
+			if (_startWeightGenerator == StartWeightGenerator::UniformDistribution) {
+				float factor = 4.0f*(sqrt(6.0/(visibleStatesCount + _hiddenStatesCount)));
+				std::uniform_real_distribution<float> disUniform(-factor, factor);
+				for (int i = 0; i < weightsCount; i++) {
+					weights[i] = disUniform(gen);
+				}
+			}
+			else if (_startWeightGenerator == StartWeightGenerator::NormalDistribution) {
+				float sigma = 2.0f*(sqrt(6.0/(visibleStatesCount + _hiddenStatesCount)));
+				std::normal_distribution<float> disNormal(0, sigma);
+				for (int i = 0; i < weightsCount; i++) {
+					weights[i] = disNormal(gen);
+				}
+			}
+
+			if (_startWeightGenerator != StartWeightGenerator::NullDistribution) {
+				std::fill(neuralNet->GetVisibleStatesBias(), neuralNet->GetVisibleStatesBias() + visibleStatesCount, 0.0f);
+				std::fill(neuralNet->GetHiddenStatesBias(), neuralNet->GetHiddenStatesBias() + _hiddenStatesCount, 0.0f);
+			}
+			return neuralNet;
+		}
+	}
+}
@@ -0,0 +1,20 @@
+#pragma once
+
+#include "ExportDll.h"
+#include "NeuralNet.h"
+#include "NeuralNetFactory.h"
+
+namespace NeuralNetNative {
+	namespace ClassificationRbm {
+		class NEURALNETNATIVE_EXPORT ClassificationRbmFactory : public NeuralNetFactory {
+		private:
+			int _inputsCount;
+			int _hiddenStatesCount;
+			int _labelsCount;
+			StartWeightGenerator _startWeightGenerator;
+		public:
+			ClassificationRbmFactory(int inputsCount, int hiddenStatesCount, int labelsCount, StartWeightGenerator startWeightGenerator);
+			NeuralNet* CreateNeuralNet(void);
+		};
+	}
+}
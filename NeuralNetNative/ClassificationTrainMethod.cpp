@@ -0,0 +1,229 @@
+#define NEURALNETNATIVEAPI
+
+#include "Platform.h"
+#include "ClassificationTrainMethod.h"
+#include "MatrixKernels.h"
+#include <tbb/tbb.h>
+#include <tbb/parallel_for.h>
+#include <tbb/blocked_range.h>
+#include "ParallelDispatch.h"
+#include <algorithm>
+
+using namespace tbb;
+using namespace NeuralNetNative::RestrictedBoltzmannMachine;
+
+namespace NeuralNetNative {
+	namespace ClassificationRbm {
+		namespace {
+			// The visible rows of the machine: the input of a train pair followed by its labels.
+			class LabeledInputTransform : public DataTransform {
+			private:
+				int _inputsCount;
+				int _labelsCount;
+			public:
+				LabeledInputTransform(int inputsCount, int labelsCount) {
+					_inputsCount = inputsCount;
+					_labelsCount = labelsCount;
+				}
+
+				virtual int GetOutputLength(void) const {
+					return _inputsCount + _labelsCount;
+				}
+
+				virtual void Transform(StandardTypesNative::TrainSingle *const *samples, int count, float *outputBatch) const {
+					for (int b = 0; b < count; b++) {
+						StandardTypesNative::TrainPair *pair = (StandardTypesNative::TrainPair*)samples[b];
+						float *output = outputBatch + (size_t)b*(_inputsCount + _labelsCount);
+						std::copy(pair->Input(), pair->Input() + _inputsCount, output);
+						std::copy(pair->Output(), pair->Output() + _labelsCount, output + _inputsCount);
+					}
+				}
+			};
+		}
+
+		ClassificationTrainMethod::
+			ClassificationTrainMethod(StandardTypesNative::TrainPair **trainData,
+			                          int trainDataSize,
+			                          GradientFunction *gradientFunction,
+			                          int methodStepsCount, float generativeWeight, float discriminativeWeight)
+			: ContrastiveDivergence((StandardTypesNative::TrainSingle**)trainData, trainDataSize, gradientFunction, methodStepsCount) {
+			_generativeWeight = generativeWeight;
+			_discriminativeWeight = discriminativeWeight;
+			_model = 0;
+			_labeledInput = 0;
+			_inputsBatch = 0;
+		}
+
+		ClassificationTrainMethod::
+			ClassificationTrainMethod(StandardTypesNative::TrainPair **trainData,
+			                          StandardTypesNative::TrainPair **testData,
+			                          int trainDataSize, int testDataSize,
+			                          GradientFunction *gradientFunction,
+			                          int methodStepsCount, float generativeWeight, float discriminativeWeight)
+			: ContrastiveDivergence((StandardTypesNative::TrainSingle**)trainData, (StandardTypesNative::TrainSingle**)testData,
+			                        trainDataSize, testDataSize, gradientFunction, methodStepsCount) {
+			_generativeWeight = generativeWeight;
+			_discriminativeWeight = discriminativeWeight;
+			_model = 0;
+			_labeledInput = 0;
+			_inputsBatch = 0;
+		}
+
+		ClassificationTrainMethod::~ClassificationTrainMethod(void) {
+			DeleteTemporaryData();
+			delete _labeledInput;
+		}
+
+		void ClassificationTrainMethod::CreateTemporaryData(void) {
+			ContrastiveDivergence::CreateTemporaryData();
+			_model = dynamic_cast<ClassificationRbm*>(neuralNet);
+			if (_model == 0) {
+				return;
+			}
+
+			int labelsCount = _model->GetLabelsCount();
+			delete _labeledInput;
+			_labeledInput = new LabeledInputTransform(_model->GetInputsCount(), labelsCount);
+			SetInputTransform(_labeledInput);
+
+			size_t packageSize = properties->PackageSize;
+			_inputsBatch = (float*)_mm_malloc(packageSize*visibleStatesCount*sizeof(float), 32);
+			_hiddenPotentialsBatch = (float*)_mm_malloc(packageSize*hiddenStatesCount*sizeof(float), 32);
+			_hiddenDerivativesBatch = (float*)_mm_malloc(packageSize*hiddenStatesCount*sizeof(float), 32);
+			_labelsBatch = (float*)_mm_malloc(packageSize*labelsCount*sizeof(float), 32);
+			_labelsErrorsBatch = (float*)_mm_malloc(packageSize*labelsCount*sizeof(float), 32);
+		}
+
+		void ClassificationTrainMethod::DeleteTemporaryData(void) {
+			ContrastiveDivergence::DeleteTemporaryData();
+			if (_inputsBatch != 0) {
+				_mm_free(_inputsBatch);
+				_mm_free(_hiddenPotentialsBatch);
+				_mm_free(_hiddenDerivativesBatch);
+				_mm_free(_labelsBatch);
+				_mm_free(_labelsErrorsBatch);
+				_inputsBatch = 0;
+			}
+		}
+
+		bool ClassificationTrainMethod::HasGenerativeGradient(void) const {
+			return _generativeWeight > 0.0f;
+		}
+
+		void ClassificationTrainMethod::CopyInputsWithoutLabels(StandardTypesNative::TrainSingle *const *samples, int count,
+		                                                        int inputsCount, float *inputsBatch) const {
+			for (int b = 0; b < count; b++) {
+				float *input = samples[b]->Input();
+				float *visibleStates = inputsBatch + (size_t)b*visibleStatesCount;
+				std::copy(input, input + inputsCount, visibleStates);
+				std::fill(visibleStates + inputsCount, visibleStates + visibleStatesCount, 0.0f);
+			}
+		}
+
+		void ClassificationTrainMethod::ScaleGenerativeGradient(void) {
+			float *packageDerivativeForWeights = gradients->GetPackageDerivativeForWeights();
+			float *packageDerivativeForHiddenBias = gradients->GetPackageDerivativeForHiddenBias();
+			float *packageDerivativeForVisibleBias = gradients->GetPackageDerivativeForVisibleBias();
+			float generativeWeight = _generativeWeight;
+			DispatchFor(hiddenStatesCount, visibleStatesCount, 2*sizeof(float),
+			[=](const blocked_range<size_t>& r)
+			{
+				for (int j = r.begin(); j < r.end(); j++) {
+					for (int i = 0; i < visibleStatesCount; i++) {
+						packageDerivativeForWeights[j*visibleStatesCount + i] *= generativeWeight;
+					}
+					packageDerivativeForHiddenBias[j] *= generativeWeight;
+				}
+			});
+			for (int i = 0; i < visibleStatesCount; i++) {
+				packageDerivativeForVisibleBias[i] *= generativeWeight;
+			}
+		}
+
+		void ClassificationTrainMethod::AddPackageGradient(StandardTypesNative::TrainSingle *const *samples, int samplesCount) {
+			if (HasGenerativeGradient() && (_generativeWeight != 1.0f)) {
+				ScaleGenerativeGradient();
+			}
+			if ((_model == 0) || (_discriminativeWeight == 0.0f)) {
+				return;
+			}
+
+			int inputsCount = _model->GetInputsCount();
+			int labelsCount = _model->GetLabelsCount();
+			CopyInputsWithoutLabels(samples, samplesCount, inputsCount, _inputsBatch);
+			_model->CalculateLabelsPosterior(_inputsBatch, _hiddenPotentialsBatch, _labelsBatch, samplesCount);
+			for (int b = 0; b < samplesCount; b++) {
+				float *labels = ((StandardTypesNative::TrainPair*)samples[b])->Output();
+				float *labelsErrors = _labelsErrorsBatch + (size_t)b*labelsCount;
+				const float *posterior = _labelsBatch + (size_t)b*labelsCount;
+				for (int k = 0; k < labelsCount; k++) {
+					labelsErrors[k] = labels[k] - posterior[k];
+				}
+			}
+
+			// d log p(y|x)/d(W_j*x + c_j) = sum over k of sigmoid(W_j*x + c_j + U_jk)*(y_k - p(k|x)), and the
+			// label weights U_jk get their own terms of the sum.
+			float factor = _discriminativeWeight/samplesCount;
+			const float *weights = neuralNet->GetWeights();
+			float *packageDerivativeForWeights = gradients->GetPackageDerivativeForWeights();
+			DispatchFor(hiddenStatesCount, samplesCount*labelsCount, 3*sizeof(float),
+			[=](const blocked_range<size_t>& r)
+			{
+				for (int j = r.begin(); j < r.end(); j++) {
+					const float *labelsWeights = weights + (size_t)j*visibleStatesCount + inputsCount;
+					float *labelsDerivatives = packageDerivativeForWeights + (size_t)j*visibleStatesCount + inputsCount;
+					for (int b = 0; b < samplesCount; b++) {
+						float hiddenPotential = _hiddenPotentialsBatch[(size_t)b*hiddenStatesCount + j];
+						const float *labelsErrors = _labelsErrorsBatch + (size_t)b*labelsCount;
+						float hiddenDerivative = 0.0f;
+						for (int k = 0; k < labelsCount; k++) {
+							float derivative = labelsErrors[k]/(1.0f + expf(-hiddenPotential - labelsWeights[k]));
+							labelsDerivatives[k] += factor*derivative;
+							hiddenDerivative += derivative;
+						}
+						_hiddenDerivativesBatch[(size_t)b*hiddenStatesCount + j] = hiddenDerivative;
+					}
+				}
+			});
+			// The label parts of the input rows are zero, so only the input weights get the product.
+			MatrixKernels::AddTransposedProduct(_hiddenDerivativesBatch, _inputsBatch, factor, packageDerivativeForWeights,
+			                                    hiddenStatesCount, visibleStatesCount, samplesCount);
+			MatrixKernels::AddColumnSums(_hiddenDerivativesBatch, factor, gradients->GetPackageDerivativeForHiddenBias(),
+			                             samplesCount, hiddenStatesCount);
+			MatrixKernels::AddColumnSums(_labelsErrorsBatch, factor, gradients->GetPackageDerivativeForVisibleBias() + inputsCount,
+			                             samplesCount, labelsCount);
+
+#if NNETS_TELEMETRY
+			double weightsCount = (double)visibleStatesCount*hiddenStatesCount;
+			double labelWeightsCount = (double)labelsCount*hiddenStatesCount;
+			TELEMETRY_WORK(Telemetry, StandardTypesNative::GradientPhase, (4.0*weightsCount + 4.0*labelWeightsCount)*samplesCount,
+			               3*sizeof(float)*weightsCount);
+#endif
+		}
+
+		float ClassificationTrainMethod::CalculateErrorsSum(RestrictedBoltzmannMachineBase *model, float *output,
+		                                                    StandardTypesNative::TrainSingle *const *samples,
+		                                                    const float *visibleStatesBatch, int count) const {
+			ClassificationRbm *classificationModel = dynamic_cast<ClassificationRbm*>(model);
+			if (classificationModel == 0) {
+				return ContrastiveDivergence::CalculateErrorsSum(model, output, samples, visibleStatesBatch, count);
+			}
+			int labelsCount = classificationModel->GetLabelsCount();
+			// The method's own buffers are not used, as asynchronous testing runs beside the training.
+			float *inputsBatch = (float*)_mm_malloc((size_t)count*visibleStatesCount*sizeof(float), 32);
+			float *hiddenPotentialsBatch = (float*)_mm_malloc((size_t)count*hiddenStatesCount*sizeof(float), 32);
+			float *labelsBatch = (float*)_mm_malloc((size_t)count*labelsCount*sizeof(float), 32);
+			CopyInputsWithoutLabels(samples, count, classificationModel->GetInputsCount(), inputsBatch);
+			classificationModel->CalculateLabelsPosterior(inputsBatch, hiddenPotentialsBatch, labelsBatch, count);
+			float sumError = 0.0f;
+			for (int b = 0; b < count; b++) {
+				sumError += properties->Metrics->Calculate(((StandardTypesNative::TrainPair*)samples[b])->Output(),
+				                                           labelsBatch + (size_t)b*labelsCount, labelsCount);
+			}
+			_mm_free(inputsBatch);
+			_mm_free(hiddenPotentialsBatch);
+			_mm_free(labelsBatch);
+			return sumError;
+		}
+	}
+}
@@ -0,0 +1,49 @@
+#pragma once
+
+#include "ExportDll.h"
+#include "ContrastiveDivergence.h"
+#include "TrainPair.h"
+#include "ClassificationRbm.h"
+
+namespace NeuralNetNative {
+	namespace ClassificationRbm {
+		// Trains a ClassificationRbm on train pairs whose outputs are the one-hot labels. The package gradient
+		// is generativeWeight times the CD-k gradient of log p(x, y) plus discriminativeWeight times the exact
+		// gradient of log p(y|x); the errors are those of the predicted labels.
+		class NEURALNETNATIVE_EXPORT ClassificationTrainMethod : public RestrictedBoltzmannMachine::ContrastiveDivergence {
+		private:
+			float _generativeWeight;
+			float _discriminativeWeight;
+			ClassificationRbm *_model;
+			DataTransform *_labeledInput;
+			float *_inputsBatch;
+			float *_hiddenPotentialsBatch;
+			float *_hiddenDerivativesBatch;
+			float *_labelsBatch;
+			float *_labelsErrorsBatch;
+		public:
+			virtual ~ClassificationTrainMethod(void);
+		protected:
+			ClassificationTrainMethod(StandardTypesNative::TrainPair **trainData,
+			                          int trainDataSize,
+			                          RestrictedBoltzmannMachine::GradientFunction *gradientFunction,
+			                          int methodStepsCount, float generativeWeight, float discriminativeWeight);
+			ClassificationTrainMethod(StandardTypesNative::TrainPair **trainData,
+			                          StandardTypesNative::TrainPair **testData,
+			                          int trainDataSize, int testDataSize,
+			                          RestrictedBoltzmannMachine::GradientFunction *gradientFunction,
+			                          int methodStepsCount, float generativeWeight, float discriminativeWeight);
+			virtual void CreateTemporaryData(void);
+			virtual void DeleteTemporaryData(void);
+			virtual bool HasGenerativeGradient(void) const;
+			virtual void AddPackageGradient(StandardTypesNative::TrainSingle *const *samples, int samplesCount);
+			virtual float CalculateErrorsSum(RestrictedBoltzmannMachine::RestrictedBoltzmannMachineBase *model, float *output,
+			                                 StandardTypesNative::TrainSingle *const *samples,
+			                                 const float *visibleStatesBatch, int count) const;
+		private:
+			void ScaleGenerativeGradient(void);
+			void CopyInputsWithoutLabels(StandardTypesNative::TrainSingle *const *samples, int count,
+			                             int inputsCount, float *inputsBatch) const;
+		};
+	}
+}
@@ -0,0 +1,115 @@
+#define NEURALNETNATIVEAPI
+
+#include "Platform.h"
+#include "ConditionalGibbsSampler.h"
+#include "ExecutionContext.h"
+#include "PackedStates.h"
+#include <tbb/tbb.h>
+#include <tbb/parallel_for.h>
+#include <tbb/blocked_range.h>
+#include "ParallelDispatch.h"
+#include <algorithm>
+
+using namespace tbb;
+
+namespace NeuralNetNative {
+	namespace RestrictedBoltzmannMachine {
+		ConditionalGibbsSampler::ConditionalGibbsSampler(RestrictedBoltzmannMachineBase *model, int chainsCount,
+		                                                 int sweepsCount, int burnInSweepsCount) {
+			_model = model;
+			_chainsCount = std::max(chainsCount, 1);
+			_sweepsCount = std::max(sweepsCount, 1);
+			_burnInSweepsCount = std::max(0, std::min(burnInSweepsCount, _sweepsCount - 1));
+		}
+
+		void ConditionalGibbsSampler::Recover(const float *inputs, const float *masks, float *reconstructions, int batchSize) {
+			int visibleStatesCount = _model->GetVisibleStatesCount();
+			int hiddenStatesCount = _model->GetHiddenStatesCount();
+			int chainsCount = batchSize*_chainsCount;
+			ExecutionContext::ExecuteIn(_model->GetExecutionContext(), [=]() {
+				float *visibleStates = (float*)_mm_malloc((size_t)chainsCount*visibleStatesCount*sizeof(float), 32);
+				float *hiddenStates = (float*)_mm_malloc((size_t)chainsCount*hiddenStatesCount*sizeof(float), 32);
+				float *sums = (float*)_mm_malloc((size_t)batchSize*visibleStatesCount*sizeof(float), 32);
+				// Binary hidden states are kept as bits, so the visible pass adds the weights of the active units only.
+				PackedStates *packedHiddenStates = _model->SupportsPackedStates() ?
+					new PackedStates(chainsCount, hiddenStatesCount) : 0;
+				std::fill(sums, sums + (size_t)batchSize*visibleStatesCount, 0.0f);
+				DispatchFor(chainsCount, visibleStatesCount, sizeof(float),
+				[=](const blocked_range<size_t>& r)
+				{
+					for (int b = r.begin(); b < r.end(); b++) {
+						const float *input = inputs + (size_t)(b/_chainsCount)*visibleStatesCount;
+						std::copy(input, input + visibleStatesCount, visibleStates + (size_t)b*visibleStatesCount);
+					}
+				});
+
+				for (int sweep = 0; sweep < _sweepsCount; sweep++) {
+					_model->HiddenLayerCalculateActivity(visibleStates, hiddenStates, chainsCount);
+					if (packedHiddenStates != 0) {
+						_model->HiddenLayerSampling(hiddenStates, *packedHiddenStates, chainsCount);
+						_model->VisibleLayerCalculateActivity(*packedHiddenStates, visibleStates, chainsCount);
+					}
+					else {
+						_model->HiddenLayerSampling(hiddenStates, chainsCount);
+						_model->VisibleLayerCalculateActivity(hiddenStates, visibleStates, chainsCount);
+					}
+					if (sweep >= _burnInSweepsCount) {
+						DispatchFor(batchSize, _chainsCount*visibleStatesCount, sizeof(float),
+						[=](const blocked_range<size_t>& r)
+						{
+							for (int b = r.begin(); b < r.end(); b++) {
+								float *sum = sums + (size_t)b*visibleStatesCount;
+								for (int c = 0; c < _chainsCount; c++) {
+									const float *states = visibleStates + (size_t)(b*_chainsCount + c)*visibleStatesCount;
+									for (int i = 0; i < visibleStatesCount; i++) {
+										sum[i] += states[i];
+									}
+								}
+							}
+						});
+					}
+					if (sweep < _sweepsCount - 1) {
+						_model->VisibleLayerSampling(visibleStates, chainsCount);
+						ClampStates(inputs, masks, visibleStates, batchSize);
+					}
+				}
+
+				float factor = 1.0f/((float)_chainsCount*(_sweepsCount - _burnInSweepsCount));
+				DispatchFor(batchSize, visibleStatesCount, 4*sizeof(float),
+				[=](const blocked_range<size_t>& r)
+				{
+					for (int b = r.begin(); b < r.end(); b++) {
+						const float *input = inputs + (size_t)b*visibleStatesCount;
+						const float *mask = masks + (size_t)b*visibleStatesCount;
+						const float *sum = sums + (size_t)b*visibleStatesCount;
+						float *reconstruction = reconstructions + (size_t)b*visibleStatesCount;
+						for (int i = 0; i < visibleStatesCount; i++) {
+							reconstruction[i] = mask[i]*input[i] + (1.0f - mask[i])*factor*sum[i];
+						}
+					}
+				});
+
+				delete packedHiddenStates;
+				_mm_free(visibleStates);
+				_mm_free(hiddenStates);
+				_mm_free(sums);
+			});
+		}
+
+		void ConditionalGibbsSampler::ClampStates(const float *inputs, const float *masks, float *states, int batchSize) const {
+			int visibleStatesCount = _model->GetVisibleStatesCount();
+			DispatchFor(batchSize*_chainsCount, visibleStatesCount, 3*sizeof(float),
+			[=](const blocked_range<size_t>& r)
+			{
+				for (int b = r.begin(); b < r.end(); b++) {
+					const float *input = inputs + (size_t)(b/_chainsCount)*visibleStatesCount;
+					const float *mask = masks + (size_t)(b/_chainsCount)*visibleStatesCount;
+					float *rowStates = states + (size_t)b*visibleStatesCount;
+					for (int i = 0; i < visibleStatesCount; i++) {
+						rowStates[i] = mask[i]*input[i] + (1.0f - mask[i])*rowStates[i];
+					}
+				}
+			});
+		}
+	}
+}
@@ -0,0 +1,31 @@
+#pragma once
+
+#include "ExportDll.h"
+#include "RestrictedBoltzmannMachine.h"
+
+namespace NeuralNetNative {
+	namespace RestrictedBoltzmannMachine {
+		// Recovers the unknown visible units of a batch of inputs. Every input runs chainsCount Gibbs
+		// chains in which the known units stay clamped to the input, all chains of the batch advance as
+		// one batch, and the visible probabilities of the unknown units are averaged over the chains and
+		// over the sweeps after the burn-in. Sampling draws from the random stream of the machine, so it
+		// must not be used on other threads meanwhile.
+		class NEURALNETNATIVE_EXPORT ConditionalGibbsSampler {
+		private:
+			RestrictedBoltzmannMachineBase *_model;
+			int _chainsCount;
+			int _sweepsCount;
+			int _burnInSweepsCount;
+		public:
+			// chainsCount and sweepsCount below one are taken as one; the burn-in is kept within [0, sweepsCount - 1].
+			ConditionalGibbsSampler(RestrictedBoltzmannMachineBase *model, int chainsCount, int sweepsCount, int burnInSweepsCount);
+			// inputs, masks and reconstructions are batchSize rows of visible states. A mask of 1 marks a
+			// known unit and 0 an unknown one, whose chains start from its input value. reconstructions
+			// receive the known units as they are and the averaged probabilities of the unknown ones.
+			void Recover(const float *inputs, const float *masks, float *reconstructions, int batchSize);
+		private:
+			// states[b] = masks[b/chainsCount]*inputs[b/chainsCount] + (1 - masks)*states[b] for every chain row b.
+			void ClampStates(const float *inputs, const float *masks, float *states, int batchSize) const;
+		};
+	}
+}
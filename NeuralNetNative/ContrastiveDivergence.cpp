@@ -1,12 +1,12 @@
 #define NEURALNETNATIVEAPI
 
-#include <mathimf.h>
+#include "Platform.h"
 #include "ContrastiveDivergence.h"
 #include <cfloat>
-#include <tbb\tbb.h>
-#include <tbb\task_scheduler_init.h>
-#include <tbb\parallel_for.h>
-#include <tbb\blocked_range.h>
+#include <tbb/tbb.h>
+#include <tbb/parallel_for.h>
+#include <tbb/blocked_range.h>
+#include "ParallelDispatch.h"
 #include <algorithm>
 
 using namespace StandardTypesNative;
@@ -21,6 +21,7 @@ namespace NeuralNetNative {
                                   int methodStepsCount)
             : RbmTrainMethod(trainData, trainDataSize, gradientFunction) {
 			_methodStepsCount = methodStepsCount;
+			_oldDeltaWeights = 0;
 		}
 
 		ContrastiveDivergence::
@@ -31,6 +32,7 @@ namespace NeuralNetNative {
                                   int methodStepsCount) 
             : RbmTrainMethod(trainData, testData, trainDataSize, testDataSize, gradientFunction) {
 			_methodStepsCount = methodStepsCount;
+			_oldDeltaWeights = 0;
 		}
 
 		ContrastiveDivergence::~ContrastiveDivergence(void) {
@@ -65,9 +67,7 @@ namespace NeuralNetNative {
 		}
 
 		void ContrastiveDivergence::DeleteTemporaryData(void) {
-			if (neuralNet != 0) {
-				_oldDeltaWeights = 0;
-                
+			if (_oldDeltaWeights != 0) {
                 _mm_free(_oldDeltaWeights);
 				_mm_free(_oldDeltaWeightsForVisibleBias);
 				_mm_free(_oldDeltaWeightsForHiddenBias);
@@ -77,6 +77,7 @@ namespace NeuralNetNative {
 				_mm_free(_learnFactors);
 				_mm_free(_learnFactorsForVisibleBias);
 				_mm_free(_learnFactorsForHiddenBias);
+				_oldDeltaWeights = 0;
 			}
 		}
 
@@ -95,6 +96,35 @@ namespace NeuralNetNative {
 			neuralNet->HiddenLayerCalculateActivity();
         }
 
+        int ContrastiveDivergence::NegativePhaseLayerPassesCount(void) const {
+            return 2*_methodStepsCount;
+        }
+
+        bool ContrastiveDivergence::SupportsBatchTraining(void) const {
+            return true;
+        }
+
+        void ContrastiveDivergence::MakeBatchNegativePhase(float *visibleStatesBatch, float *hiddenStatesBatch, int batchSize) {
+            ReconstructBatch(visibleStatesBatch, hiddenStatesBatch, batchSize);
+            for (int k = 1; k < _methodStepsCount; k++) {
+                neuralNet->HiddenLayerCalculateActivity(visibleStatesBatch, hiddenStatesBatch, batchSize);
+                ReconstructBatch(visibleStatesBatch, hiddenStatesBatch, batchSize);
+            }
+            neuralNet->HiddenLayerCalculateActivity(visibleStatesBatch, hiddenStatesBatch, batchSize);
+        }
+
+        void ContrastiveDivergence::ReconstructBatch(float *visibleStatesBatch, float *hiddenStatesBatch, int batchSize) {
+            if (packedHiddenStates != 0) {
+                // Only the weight rows of the active hidden units are read.
+                neuralNet->HiddenLayerSampling(hiddenStatesBatch, *packedHiddenStates, batchSize);
+                neuralNet->VisibleLayerCalculateActivity(*packedHiddenStates, visibleStatesBatch, batchSize);
+            }
+            else {
+                neuralNet->HiddenLayerSampling(hiddenStatesBatch, batchSize);
+                neuralNet->VisibleLayerCalculateActivity(hiddenStatesBatch, visibleStatesBatch, batchSize);
+            }
+        }
+
         float* ContrastiveDivergence::GetVisibleStatesOnNegativePhase(int packageId) {
             return neuralNet->GetVisibleStates();
         }
@@ -111,7 +141,7 @@ namespace NeuralNetNative {
 			
             float *weights = neuralNet->GetWeights();
 			float *packageDerivativeForWeights = gradients->GetPackageDerivativeForWeights();
-			parallel_for(blocked_range<size_t>(0, hiddenStatesCount),
+			DispatchFor(hiddenStatesCount, visibleStatesCount, 10*sizeof(float),
 			[=](const blocked_range<size_t>& r)
 			{
 				for (int j = r.begin(); j < r.end(); j++) {
@@ -138,7 +168,7 @@ namespace NeuralNetNative {
 
 			float *visibleStatesBias = neuralNet->GetVisibleStatesBias();
             float *packageDerivativeForVisibleBias = gradients->GetPackageDerivativeForVisibleBias();
-			parallel_for(blocked_range<size_t>(0, visibleStatesCount),
+			DispatchFor(visibleStatesCount, 1, 10*sizeof(float),
 			[=](const blocked_range<size_t>& r)
 			{
 				for (int i = r.begin(); i < r.end(); i++) {
@@ -160,7 +190,7 @@ namespace NeuralNetNative {
 
 			float *hiddenStatesBias = neuralNet->GetHiddenStatesBias();
             float *packageDerivativeForHiddenBias = gradients->GetPackageDerivativeForHiddenBias();
-			parallel_for(blocked_range<size_t>(0, hiddenStatesCount),
+			DispatchFor(hiddenStatesCount, 1, 10*sizeof(float),
 			[=](const blocked_range<size_t>& r)
 			{
 				for (int j = r.begin(); j < r.end(); j++) {
@@ -38,9 +38,15 @@ namespace NeuralNetNative {
             virtual void MakePositivePhase(float *input);
 		    virtual void MakeNegativePhase(int packageId);
 		    virtual float* GetVisibleStatesOnNegativePhase(int packageId);
+            virtual int NegativePhaseLayerPassesCount(void) const;
+            virtual bool SupportsBatchTraining(void) const;
+            virtual void MakeBatchNegativePhase(float *visibleStatesBatch, float *hiddenStatesBatch, int batchSize);
 		    virtual float* GetHiddenStatesOnNegativePhase(void);
 		    virtual void RestoreVisibleStates(int packageId);
             virtual void ModifyWeightsOfNeuronNet();
+        private:
+            // Samples the hidden batch and replaces the visible batch by its reconstruction.
+            void ReconstructBatch(float *visibleStatesBatch, float *hiddenStatesBatch, int batchSize);
 		};
 	}
 }
\ No newline at end of file
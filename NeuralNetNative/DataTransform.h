@@ -0,0 +1,15 @@
+#pragma once
+
+#include "TrainSingle.h"
+
+namespace NeuralNetNative {
+	// Produces the rows that a train method reads in place of the sample inputs, e.g. the hidden
+	// activations of the lower layers of a deep belief network. Rows are written one after another
+	// into outputBatch, GetOutputLength floats each.
+	class DataTransform {
+	public:
+		virtual ~DataTransform(void) {}
+		virtual int GetOutputLength(void) const = 0;
+		virtual void Transform(StandardTypesNative::TrainSingle *const *samples, int count, float *outputBatch) const = 0;
+	};
+}
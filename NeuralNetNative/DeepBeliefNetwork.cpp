@@ -0,0 +1,112 @@
+#define NEURALNETNATIVEAPI
+
+#include "DeepBeliefNetwork.h"
+#include "HiddenActivationsTransform.h"
+#include "SpilledTransform.h"
+#include <algorithm>
+#include <cstring>
+
+namespace NeuralNetNative {
+	namespace RestrictedBoltzmannMachine {
+		DeepBeliefNetwork::DeepBeliefNetwork(RestrictedBoltzmannMachineBase **layers, int layersCount, bool sampleStates) {
+			_layers = new RestrictedBoltzmannMachineBase*[layersCount];
+			std::copy(layers, layers + layersCount, _layers);
+			_layersCount = layersCount;
+			_sampleStates = sampleStates;
+			_spillDirectory = 0;
+		}
+
+		DeepBeliefNetwork::~DeepBeliefNetwork(void) {
+			delete[] _layers;
+			delete[] _spillDirectory;
+		}
+
+		void DeepBeliefNetwork::SetSpillDirectory(const char *directory) {
+			delete[] _spillDirectory;
+			_spillDirectory = 0;
+			if (directory != 0) {
+				_spillDirectory = new char[strlen(directory) + 1];
+				strcpy(_spillDirectory, directory);
+			}
+		}
+
+		bool DeepBeliefNetwork::Pretrain(RbmTrainMethod **trainMethods, TrainProperties **properties,
+		                                 StandardTypesNative::TrainSingle **trainData, int trainDataSize,
+		                                 StandardTypesNative::TrainSingle **testData, int testDataSize) {
+			DataTransform *input = 0;
+			for (int k = 0; k < _layersCount; k++) {
+				if (k > 0) {
+					DataTransform *lowerInput = input;
+					if (_spillDirectory != 0) {
+						// Layer k - 1 is trained, so its activations over the spilled inputs are final.
+						input = CreateSpilledInput(lowerInput, k, trainData, trainDataSize, testData, testDataSize,
+						                           properties[k]->PackageSize);
+						delete lowerInput;
+						if (input == 0) {
+							return false;
+						}
+					}
+					else {
+						delete lowerInput;
+						input = new HiddenActivationsTransform(0, _layers, k, _sampleStates);
+					}
+				}
+				trainMethods[k]->SetInputTransform(input);
+				trainMethods[k]->InitilazeMethod(_layers[k], properties[k]);
+				trainMethods[k]->Start();
+				trainMethods[k]->SetInputTransform(0);
+			}
+			delete input;
+			return true;
+		}
+
+		DataTransform* DeepBeliefNetwork::CreateSpilledInput(const DataTransform *lowerInput, int layerNum,
+		                                                     StandardTypesNative::TrainSingle **trainData, int trainDataSize,
+		                                                     StandardTypesNative::TrainSingle **testData, int testDataSize,
+		                                                     int batchSize) const {
+			StandardTypesNative::TrainSingle **samples = new StandardTypesNative::TrainSingle*[trainDataSize + testDataSize];
+			std::copy(trainData, trainData + trainDataSize, samples);
+			if (testData != 0) {
+				std::copy(testData, testData + testDataSize, samples + trainDataSize);
+			}
+			else {
+				testDataSize = 0;
+			}
+			HiddenActivationsTransform layerPass(lowerInput, _layers + layerNum - 1, 1, _sampleStates);
+			DataTransform *input = SpilledTransform::Create(&layerPass, samples, trainDataSize + testDataSize,
+			                                                batchSize, _spillDirectory);
+			delete[] samples;
+			return input;
+		}
+
+		bool DeepBeliefNetwork::InitializePerceptron(MultyLayerPerceptron::MultyLayerPerceptron *perceptron) const {
+			if (perceptron->GetLayersCount() < _layersCount) {
+				return false;
+			}
+			BaseNeuralBlock **blocks = perceptron->GetLayers();
+			for (int k = 0; k < _layersCount; k++) {
+				if ((blocks[k]->GetSize() != _layers[k]->GetHiddenStatesCount()) ||
+				    (blocks[k]->GetPreviousSize() != _layers[k]->GetVisibleStatesCount())) {
+					return false;
+				}
+			}
+			for (int k = 0; k < _layersCount; k++) {
+				// Both keep the weights as [hidden x visible], one row per neuron.
+				int weightsCount = _layers[k]->GetHiddenStatesCount()*_layers[k]->GetVisibleStatesCount();
+				std::copy(_layers[k]->GetWeights(), _layers[k]->GetWeights() + weightsCount, blocks[k]->GetWeights());
+				std::copy(_layers[k]->GetHiddenStatesBias(), _layers[k]->GetHiddenStatesBias() + _layers[k]->GetHiddenStatesCount(),
+				          blocks[k]->GetBias());
+				blocks[k]->RefreshWeightReplicas();
+			}
+			return true;
+		}
+
+		int DeepBeliefNetwork::GetLayersCount(void) const {
+			return _layersCount;
+		}
+
+		RestrictedBoltzmannMachineBase* DeepBeliefNetwork::GetLayer(int layerNum) const {
+			return _layers[layerNum];
+		}
+	}
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+#include "ExportDll.h"
+#include "TrainSingle.h"
+#include "TrainProperties.h"
+#include "DataTransform.h"
+#include "RestrictedBoltzmannMachine.h"
+#include "RbmTrainMethod.h"
+#include "MultyLayerPerceptron.h"
+
+namespace NeuralNetNative {
+	namespace RestrictedBoltzmannMachine {
+		// Stack of RBMs in which every layer models the hidden activations of the layer below it. The
+		// layers are pretrained greedily, bottom up, and the activations are passed up in batches while
+		// a layer trains, so no intermediate data set is built. The layers are not owned.
+		class NEURALNETNATIVE_EXPORT DeepBeliefNetwork {
+		private:
+			RestrictedBoltzmannMachineBase **_layers;
+			int _layersCount;
+			bool _sampleStates;
+			char *_spillDirectory;
+		public:
+			// With sampleStates the upper layers read binary states sampled from the hidden probabilities
+			// of the layers below instead of the probabilities themselves.
+			DeepBeliefNetwork(RestrictedBoltzmannMachineBase **layers, int layersCount, bool sampleStates);
+			~DeepBeliefNetwork(void);
+			// Without a directory the inputs of an upper layer are recomputed from the samples through all
+			// layers below it in every batch. With one they are computed once per layer into a memory-mapped
+			// file there, which trades the repeated passes for disk space when the stack is deep. With
+			// sampleStates the streamed inputs are sampled anew in every batch, while the spilled ones are
+			// sampled once per layer and the same states are read in every epoch.
+			void SetSpillDirectory(const char *directory);
+			// trainMethods[k] trains layers[k] with properties[k]. All train methods must be built on the
+			// given train and test samples themselves; the layers above the first read their activations.
+			// Returns false when a spill file cannot be created.
+			bool Pretrain(RbmTrainMethod **trainMethods, TrainProperties **properties,
+			              StandardTypesNative::TrainSingle **trainData, int trainDataSize,
+			              StandardTypesNative::TrainSingle **testData, int testDataSize);
+			// Copies the weights and hidden biases of the layers into the first layers of the perceptron.
+			// Returns false when the perceptron is too shallow or a layer size differs.
+			bool InitializePerceptron(MultyLayerPerceptron::MultyLayerPerceptron *perceptron) const;
+			int GetLayersCount(void) const;
+			RestrictedBoltzmannMachineBase* GetLayer(int layerNum) const;
+		private:
+			DataTransform* CreateSpilledInput(const DataTransform *lowerInput, int layerNum,
+			                                  StandardTypesNative::TrainSingle **trainData, int trainDataSize,
+			                                  StandardTypesNative::TrainSingle **testData, int testDataSize,
+			                                  int batchSize) const;
+		};
+	}
+}
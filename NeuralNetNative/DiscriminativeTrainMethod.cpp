@@ -0,0 +1,18 @@
+#define NEURALNETNATIVEAPI
+
+#include "DiscriminativeTrainMethod.h"
+
+namespace NeuralNetNative {
+	namespace ClassificationRbm {
+		DiscriminativeTrainMethod::DiscriminativeTrainMethod(StandardTypesNative::TrainPair **trainData, int trainDataSize)
+			: ClassificationTrainMethod(trainData, trainDataSize, 0, 1, 0.0f, 1.0f) {
+		}
+
+		DiscriminativeTrainMethod::
+			DiscriminativeTrainMethod(StandardTypesNative::TrainPair **trainData,
+			                          StandardTypesNative::TrainPair **testData,
+			                          int trainDataSize, int testDataSize)
+			: ClassificationTrainMethod(trainData, testData, trainDataSize, testDataSize, 0, 1, 0.0f, 1.0f) {
+		}
+	}
+}
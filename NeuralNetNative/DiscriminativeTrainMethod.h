@@ -0,0 +1,17 @@
+#pragma once
+
+#include "ExportDll.h"
+#include "ClassificationTrainMethod.h"
+
+namespace NeuralNetNative {
+	namespace ClassificationRbm {
+		// Gradient ascent on log p(y|x) only; no Gibbs sampling is done.
+		class NEURALNETNATIVE_EXPORT DiscriminativeTrainMethod : public ClassificationTrainMethod {
+		public:
+			DiscriminativeTrainMethod(StandardTypesNative::TrainPair **trainData, int trainDataSize);
+			DiscriminativeTrainMethod(StandardTypesNative::TrainPair **trainData,
+			                          StandardTypesNative::TrainPair **testData,
+			                          int trainDataSize, int testDataSize);
+		};
+	}
+}
@@ -0,0 +1,147 @@
+#define NEURALNETNATIVEAPI
+
+#include "EnhancedGradient.h"
+#include <tbb/tbb.h>
+#include <tbb/parallel_for.h>
+#include <tbb/blocked_range.h>
+#include "ParallelDispatch.h"
+#include "MatrixKernels.h"
+#include <algorithm>
+#include "Platform.h"
+
+using namespace tbb;
+
+namespace NeuralNetNative {
+	namespace RestrictedBoltzmannMachine {
+        EnhancedGradient::EnhancedGradient(void) {
+            _dataVisible = 0;
+        }
+
+        EnhancedGradient::~EnhancedGradient(void) {
+            DeleteMemory();
+        }
+
+        void EnhancedGradient::AllocateMemory(void) {
+            _dataVisible = (float*)_mm_malloc(VisibleStatesCount*sizeof(float), 32);
+            _modelVisible = (float*)_mm_malloc(VisibleStatesCount*sizeof(float), 32);
+            _visibleMeans = (float*)_mm_malloc(VisibleStatesCount*sizeof(float), 32);
+
+            _dataHidden = (float*)_mm_malloc(HiddenStatesCount*sizeof(float), 32);
+            _modelHidden = (float*)_mm_malloc(HiddenStatesCount*sizeof(float), 32);
+            _hiddenMeans = (float*)_mm_malloc(HiddenStatesCount*sizeof(float), 32);
+        }
+
+        void EnhancedGradient::DeleteMemory(void) {
+            if (_dataVisible != 0) {
+                _mm_free(_dataVisible);
+                _mm_free(_modelVisible);
+                _mm_free(_visibleMeans);
+                _mm_free(_dataHidden);
+                _mm_free(_modelHidden);
+                _mm_free(_hiddenMeans);
+
+                _dataVisible = 0;
+            }
+        }
+
+        void EnhancedGradient::PrepareToNextPackage(int nextPackageSize) {
+            std::fill(_dataVisible, _dataVisible + VisibleStatesCount, 0.0f);
+            std::fill(_modelVisible, _modelVisible + VisibleStatesCount, 0.0f);
+            std::fill(_dataHidden, _dataHidden + HiddenStatesCount, 0.0f);
+            std::fill(_modelHidden, _modelHidden + HiddenStatesCount, 0.0f);
+        }
+
+        void EnhancedGradient::StorePositivePhaseData(float *visibleStates, float *hiddenStates) {
+            AddProduct(visibleStates, hiddenStates, 1.0f);
+            for (int j = 0; j < HiddenStatesCount; j++) {
+                _dataHidden[j] += hiddenStates[j];
+            }
+            for (int i = 0; i < VisibleStatesCount; i++) {
+                _dataVisible[i] += visibleStates[i];
+            }
+        }
+
+        void EnhancedGradient::StoreNegativePhaseData(float *visibleStates, float *hiddenStates) {
+            AddProduct(visibleStates, hiddenStates, -1.0f);
+            for (int j = 0; j < HiddenStatesCount; j++) {
+                _modelHidden[j] += hiddenStates[j];
+            }
+            for (int i = 0; i < VisibleStatesCount; i++) {
+                _modelVisible[i] += visibleStates[i];
+            }
+        }
+
+        void EnhancedGradient::StorePositivePhaseBatch(float *visibleStatesBatch, float *hiddenStatesBatch, int batchSize) {
+            MatrixKernels::AddTransposedProduct(hiddenStatesBatch, visibleStatesBatch, 1.0f, Gradients->GetPackageDerivativeForWeights(),
+                                                HiddenStatesCount, VisibleStatesCount, batchSize);
+            MatrixKernels::AddColumnSums(hiddenStatesBatch, 1.0f, _dataHidden, batchSize, HiddenStatesCount);
+            MatrixKernels::AddColumnSums(visibleStatesBatch, 1.0f, _dataVisible, batchSize, VisibleStatesCount);
+        }
+
+        void EnhancedGradient::StoreNegativePhaseBatch(float *visibleStatesBatch, float *hiddenStatesBatch, int batchSize, float weight) {
+            MatrixKernels::AddTransposedProduct(hiddenStatesBatch, visibleStatesBatch, -weight, Gradients->GetPackageDerivativeForWeights(),
+                                                HiddenStatesCount, VisibleStatesCount, batchSize);
+            MatrixKernels::AddColumnSums(hiddenStatesBatch, weight, _modelHidden, batchSize, HiddenStatesCount);
+            MatrixKernels::AddColumnSums(visibleStatesBatch, weight, _modelVisible, batchSize, VisibleStatesCount);
+        }
+
+        void EnhancedGradient::AddProduct(float *visibleStates, float *hiddenStates, float alpha) {
+            float *packageDerivativeForWeights = Gradients->GetPackageDerivativeForWeights();
+            DispatchFor(HiddenStatesCount, VisibleStatesCount, 2*sizeof(float),
+			[=](const blocked_range<size_t>& r)
+			{
+				for (int j = r.begin(); j < r.end(); j++) {
+                    float *derivatives = packageDerivativeForWeights + (size_t)j*VisibleStatesCount;
+                    float hiddenState = alpha*hiddenStates[j];
+				    for (int i = 0; i < VisibleStatesCount; i++) {
+				    	derivatives[i] += visibleStates[i]*hiddenState;
+				    }
+				}
+			});
+        }
+
+        // dW = <v h>_d - <v>_d <h>_d - <v h>_m + <v>_m <h>_m,
+        // dc = <h>_d - <h>_m - dW*(<v>_d + <v>_m)/2, db = <v>_d - <v>_m - dW^T*(<h>_d + <h>_m)/2.
+        void EnhancedGradient::MakeGradient(float packageFactor) {
+            float *packageDerivativeForWeights = Gradients->GetPackageDerivativeForWeights();
+            float *packageDerivativeForHiddenBias = Gradients->GetPackageDerivativeForHiddenBias();
+            float *packageDerivativeForVisibleBias = Gradients->GetPackageDerivativeForVisibleBias();
+
+            for (int i = 0; i < VisibleStatesCount; i++) {
+                _dataVisible[i] *= packageFactor;
+                _modelVisible[i] *= packageFactor;
+                _visibleMeans[i] = 0.5f*(_dataVisible[i] + _modelVisible[i]);
+            }
+            for (int j = 0; j < HiddenStatesCount; j++) {
+                _dataHidden[j] *= packageFactor;
+                _modelHidden[j] *= packageFactor;
+                // Negated, so that the visible bias correction below is a plain product.
+                _hiddenMeans[j] = -0.5f*(_dataHidden[j] + _modelHidden[j]);
+            }
+
+            DispatchFor(HiddenStatesCount, VisibleStatesCount, 2*sizeof(float),
+			[=](const blocked_range<size_t>& r)
+			{
+                for (int j = r.begin(); j < r.end(); j++) {
+                    float *derivatives = packageDerivativeForWeights + (size_t)j*VisibleStatesCount;
+                    float dataHidden = _dataHidden[j];
+                    float modelHidden = _modelHidden[j];
+                    float hiddenStateSumGradient = 0.0f;
+                    for (int i = 0; i < VisibleStatesCount; i++) {
+                        float weightGradient = packageFactor*derivatives[i] - _dataVisible[i]*dataHidden + _modelVisible[i]*modelHidden;
+                        derivatives[i] = weightGradient;
+                        hiddenStateSumGradient += _visibleMeans[i]*weightGradient;
+                    }
+                    packageDerivativeForHiddenBias[j] = dataHidden - modelHidden - hiddenStateSumGradient;
+                }
+            });
+
+            // The visible means are no longer needed and take the bias part of the visible derivative.
+            for (int i = 0; i < VisibleStatesCount; i++) {
+                _visibleMeans[i] = _dataVisible[i] - _modelVisible[i];
+            }
+            MatrixKernels::Multiply(_hiddenMeans, packageDerivativeForWeights, _visibleMeans, packageDerivativeForVisibleBias,
+                                    1, VisibleStatesCount, HiddenStatesCount);
+        }
+    }
+}
@@ -0,0 +1,35 @@
+#pragma once
+
+#include "ExportDll.h"
+#include "GradientFunction.h"
+
+namespace NeuralNetNative {
+	namespace RestrictedBoltzmannMachine {
+        // Enhanced gradient: the weights follow the difference of the data and model covariances and
+        // the biases are corrected by the average of the data and model means.
+        class NEURALNETNATIVE_EXPORT EnhancedGradient : public GradientFunction {
+        public:
+            EnhancedGradient(void);
+            ~EnhancedGradient(void);
+            virtual void PrepareToNextPackage(int nextPackageSize);
+            virtual void StorePositivePhaseData(float *visibleStates, float *hiddenStates);
+            virtual void StoreNegativePhaseData(float *visibleStates, float *hiddenStates);
+            virtual void StorePositivePhaseBatch(float *visibleStatesBatch, float *hiddenStatesBatch, int batchSize);
+            virtual void StoreNegativePhaseBatch(float *visibleStatesBatch, float *hiddenStatesBatch, int batchSize, float weight);
+            virtual void MakeGradient(float packageFactor);
+        protected:
+            virtual void AllocateMemory(void);
+            virtual void DeleteMemory(void);
+        private:
+            // The raw products go straight into the package derivatives of Gradients, positive phase
+            // added and negative phase subtracted; only the state sums of both phases are kept here.
+            void AddProduct(float *visibleStates, float *hiddenStates, float alpha);
+		    float *_dataVisible;
+		    float *_dataHidden;
+		    float *_modelVisible;
+		    float *_modelHidden;
+		    float *_visibleMeans;
+		    float *_hiddenMeans;
+        };
+    }
+}
@@ -0,0 +1,184 @@
+#define NEURALNETNATIVEAPI
+#include "ExecutionContext.h"
+#include <tbb/tbb.h>
+#include <tbb/task_arena.h>
+#include <tbb/task_scheduler_observer.h>
+#include <vector>
+#include <cstdio>
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sched.h>
+#include <unistd.h>
+#endif
+
+namespace NeuralNetNative {
+	namespace {
+		std::vector<int> GetAvailableCores(int numaNode) {
+			std::vector<int> cores;
+#ifdef _WIN32
+			ULONGLONG mask = 0;
+			if (numaNode >= 0) {
+				GetNumaNodeProcessorMask((UCHAR)numaNode, &mask);
+			}
+			else {
+				DWORD_PTR processMask, systemMask;
+				GetProcessAffinityMask(GetCurrentProcess(), &processMask, &systemMask);
+				mask = processMask;
+			}
+			for (int core = 0; core < (int)(8*sizeof(mask)); core++) {
+				if ((mask >> core) & 1) {
+					cores.push_back(core);
+				}
+			}
+#else
+			if (numaNode >= 0) {
+				char fileName[64];
+				sprintf(fileName, "/sys/devices/system/node/node%d/cpulist", numaNode);
+				FILE *file = fopen(fileName, "r");
+				if (file != 0) {
+					int first, last;
+					while (fscanf(file, "%d", &first) == 1) {
+						last = first;
+						int separator = fgetc(file);
+						if (separator == '-') {
+							if (fscanf(file, "%d", &last) != 1) {
+								break;
+							}
+							separator = fgetc(file);
+						}
+						for (int core = first; core <= last; core++) {
+							cores.push_back(core);
+						}
+						if (separator != ',') {
+							break;
+						}
+					}
+					fclose(file);
+				}
+			}
+			else {
+				cpu_set_t set;
+				if (sched_getaffinity(0, sizeof(set), &set) == 0) {
+					for (int core = 0; core < CPU_SETSIZE; core++) {
+						if (CPU_ISSET(core, &set)) {
+							cores.push_back(core);
+						}
+					}
+				}
+			}
+#endif
+			return cores;
+		}
+
+		void SetCurrentThreadAffinity(const std::vector<int> &cores) {
+			if (cores.empty()) {
+				return;
+			}
+#ifdef _WIN32
+			DWORD_PTR mask = 0;
+			for (size_t i = 0; i < cores.size(); i++) {
+				mask |= ((DWORD_PTR)1) << cores[i];
+			}
+			SetThreadAffinityMask(GetCurrentThread(), mask);
+#else
+			cpu_set_t set;
+			CPU_ZERO(&set);
+			for (size_t i = 0; i < cores.size(); i++) {
+				CPU_SET(cores[i], &set);
+			}
+			sched_setaffinity(0, sizeof(set), &set);
+#endif
+		}
+
+		class AffinityObserver : public tbb::task_scheduler_observer {
+		private:
+			std::vector<int> _cores;
+			std::vector<int> _processCores;
+			int _firstCore;
+		public:
+			AffinityObserver(tbb::task_arena &arena, const std::vector<int> &cores, int firstCore) : tbb::task_scheduler_observer(arena) {
+				_cores = cores;
+				_processCores = GetAvailableCores(-1);
+				_firstCore = firstCore;
+				observe(true);
+			}
+
+			void on_scheduler_entry(bool isWorker) {
+				if (_firstCore < 0) {
+					SetCurrentThreadAffinity(_cores);
+					return;
+				}
+				int slot = tbb::this_task_arena::current_thread_index();
+				int coreIndex = (_firstCore + slot)%(int)_cores.size();
+				SetCurrentThreadAffinity(std::vector<int>(1, _cores[coreIndex]));
+			}
+
+			void on_scheduler_exit(bool isWorker) {
+				SetCurrentThreadAffinity(_processCores);
+			}
+		};
+	}
+
+	struct ExecutionContextData {
+	public:
+		tbb::task_arena Arena;
+		AffinityObserver *Observer;
+
+		ExecutionContextData(int concurrency) : Arena(concurrency, 1) {
+			Observer = 0;
+		}
+	};
+
+	ExecutionContext::ExecutionContext(int concurrency, int firstCore, int numaNode) {
+		std::vector<int> cores = GetAvailableCores(numaNode);
+		if (cores.empty()) {
+			numaNode = -1;
+			firstCore = -1;
+		}
+		if (concurrency <= 0) {
+			concurrency = (numaNode >= 0) || (firstCore >= 0) ? (int)cores.size() : tbb::task_arena::automatic;
+		}
+		_firstCore = firstCore;
+		_numaNode = numaNode;
+		_data = new ExecutionContextData(concurrency);
+		_data->Arena.initialize();
+		_concurrency = _data->Arena.max_concurrency();
+		if ((firstCore >= 0) || (numaNode >= 0)) {
+			_data->Observer = new AffinityObserver(_data->Arena, cores, firstCore);
+		}
+	}
+
+	ExecutionContext::~ExecutionContext(void) {
+		if (_data->Observer != 0) {
+			_data->Observer->observe(false);
+			delete _data->Observer;
+		}
+		delete _data;
+	}
+
+	int ExecutionContext::GetConcurrency(void) const {
+		return _concurrency;
+	}
+
+	int ExecutionContext::GetFirstCore(void) const {
+		return _firstCore;
+	}
+
+	int ExecutionContext::GetNumaNode(void) const {
+		return _numaNode;
+	}
+
+	void ExecutionContext::Execute(const std::function<void(void)> &function) {
+		_data->Arena.execute(function);
+	}
+
+	void ExecutionContext::ExecuteIn(ExecutionContext *context, const std::function<void(void)> &function) {
+		if (context != 0) {
+			context->Execute(function);
+		}
+		else {
+			function();
+		}
+	}
+}
@@ -0,0 +1,27 @@
+#pragma once
+
+#include "ExportDll.h"
+#include <functional>
+
+namespace NeuralNetNative {
+	struct ExecutionContextData;
+
+	// Own TBB arena for a trainer or a model, so several jobs in one process do not share the
+	// global scheduler. A negative firstCore disables pinning; otherwise arena thread k is bound
+	// to core firstCore + k (counted inside numaNode when it is set). A negative numaNode means any node.
+	class NEURALNETNATIVE_EXPORT ExecutionContext {
+	private:
+		ExecutionContextData *_data;
+		int _concurrency;
+		int _firstCore;
+		int _numaNode;
+	public:
+		ExecutionContext(int concurrency, int firstCore, int numaNode);
+		~ExecutionContext(void);
+		int GetConcurrency(void) const;
+		int GetFirstCore(void) const;
+		int GetNumaNode(void) const;
+		void Execute(const std::function<void(void)> &function);
+		static void ExecuteIn(ExecutionContext *context, const std::function<void(void)> &function);
+	};
+}
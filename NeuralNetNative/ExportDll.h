@@ -1,5 +1,9 @@
+#ifdef _WIN32
 #ifdef NEURALNETNATIVEAPI
 #define NEURALNETNATIVE_EXPORT __declspec(dllexport)
 #else
 #define NEURALNETNATIVE_EXPORT __declspec(dllimport)
+#endif
+#else
+#define NEURALNETNATIVE_EXPORT __attribute__((visibility("default")))
 #endif
\ No newline at end of file
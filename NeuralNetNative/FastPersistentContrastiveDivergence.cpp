@@ -1,12 +1,12 @@
 #define NEURALNETNATIVEAPI
 
-#include <mathimf.h>
+#include "Platform.h"
 #include "FastPersistentContrastiveDivergence.h"
 #include <cfloat>
-#include <tbb\tbb.h>
-#include <tbb\task_scheduler_init.h>
-#include <tbb\parallel_for.h>
-#include <tbb\blocked_range.h>
+#include <tbb/tbb.h>
+#include <tbb/parallel_for.h>
+#include <tbb/blocked_range.h>
+#include "ParallelDispatch.h"
 #include <algorithm>
 
 using namespace tbb;
@@ -20,6 +20,9 @@ namespace NeuralNetNative {
                                                 float fastWeightsDecreaseFactor)
         : RbmTrainMethod(trainData, trainDataSize, gradientFunction) {
 			_fastWeightsDecreaseFactor = fastWeightsDecreaseFactor;
+			_persistentVisibleStates = 0;
+			_chains = 0;
+			_fastWeights = 0;
 		}
 
 		FastPersistentContrastiveDivergence::
@@ -30,6 +33,9 @@ namespace NeuralNetNative {
                                                 float fastWeightsDecreaseFactor)
             : RbmTrainMethod(trainData, testData, trainDataSize, testDataSize, gradientFunction) {
 			_fastWeightsDecreaseFactor = fastWeightsDecreaseFactor;
+			_persistentVisibleStates = 0;
+			_chains = 0;
+			_fastWeights = 0;
 		}
 
 		FastPersistentContrastiveDivergence::~FastPersistentContrastiveDivergence(void) {
@@ -50,27 +56,54 @@ namespace NeuralNetNative {
             std::fill(_oldDeltaRegularWeightsForVisibleBias, _oldDeltaRegularWeightsForVisibleBias + visibleStatesCount, 0.0f);
             std::fill(_fastWeightsForVisibleBias, _fastWeightsForVisibleBias + visibleStatesCount, 0.0f);
 
-			_persistentVisibleStates = (float*)_mm_malloc(packagesCount*visibleStatesCount*sizeof(float), 32);
-			std::fill(_persistentVisibleStates, _persistentVisibleStates + packagesCount*visibleStatesCount, 0.0f);
+			if (properties->BatchTraining) {
+				int chainsCount = (properties->PersistentChainsCount > 0) ? properties->PersistentChainsCount : properties->PackageSize;
+				_chains = new PersistentChainPool(chainsCount, visibleStatesCount, hiddenStatesCount);
+			}
+			else {
+				_persistentVisibleStates = (float*)_mm_malloc(packagesCount*visibleStatesCount*sizeof(float), 32);
+				std::fill(_persistentVisibleStates, _persistentVisibleStates + packagesCount*visibleStatesCount, 0.0f);
+			}
 
 			_oldDeltaRegularWeightsForHiddenBias = (float*)_mm_malloc(hiddenStatesCount*sizeof(float), 32);
 			_fastWeightsForHiddenBias = (float*)_mm_malloc(hiddenStatesCount*sizeof(float), 32);
 			
             std::fill(_oldDeltaRegularWeightsForHiddenBias, _oldDeltaRegularWeightsForHiddenBias + hiddenStatesCount, 0.0f);
             std::fill(_fastWeightsForHiddenBias, _fastWeightsForHiddenBias + hiddenStatesCount, 0.0f);
+
+			_effectiveWeights = (float*)_mm_malloc(weightsCount*sizeof(float), 32);
+			_effectiveWeightsForVisibleBias = (float*)_mm_malloc(visibleStatesCount*sizeof(float), 32);
+			_effectiveWeightsForHiddenBias = (float*)_mm_malloc(hiddenStatesCount*sizeof(float), 32);
+
+			std::copy(neuralNet->GetWeights(), neuralNet->GetWeights() + weightsCount, _effectiveWeights);
+			std::copy(neuralNet->GetVisibleStatesBias(), neuralNet->GetVisibleStatesBias() + visibleStatesCount, _effectiveWeightsForVisibleBias);
+			std::copy(neuralNet->GetHiddenStatesBias(), neuralNet->GetHiddenStatesBias() + hiddenStatesCount, _effectiveWeightsForHiddenBias);
+
+			_effectiveParameters.Weights = _effectiveWeights;
+			_effectiveParameters.VisibleStatesBias = _effectiveWeightsForVisibleBias;
+			_effectiveParameters.HiddenStatesBias = _effectiveWeightsForHiddenBias;
 		}
 
 		void FastPersistentContrastiveDivergence::DeleteTemporaryData(void) {
 			if (_persistentVisibleStates != 0) {
-                _persistentVisibleStates = 0;
-
 				_mm_free(_persistentVisibleStates);
+				_persistentVisibleStates = 0;
+			}
+			if (_chains != 0) {
+				delete _chains;
+				_chains = 0;
+			}
+			if (_fastWeights != 0) {
 				_mm_free(_fastWeights);
 				_mm_free(_fastWeightsForVisibleBias);
 				_mm_free(_fastWeightsForHiddenBias);
 				_mm_free(_oldDeltaRegularWeights);
 				_mm_free(_oldDeltaRegularWeightsForVisibleBias);
 				_mm_free(_oldDeltaRegularWeightsForHiddenBias);
+				_mm_free(_effectiveWeights);
+				_mm_free(_effectiveWeightsForVisibleBias);
+				_mm_free(_effectiveWeightsForHiddenBias);
+				_fastWeights = 0;
 			}
 		}
 
@@ -80,7 +113,7 @@ namespace NeuralNetNative {
 
         void FastPersistentContrastiveDivergence::MakeNegativePhase(int packageId) {
             float *persistentVisibleStates = &_persistentVisibleStates[packageId*visibleStatesCount];
-            neuralNet->HiddenLayerCalculateActivity(persistentVisibleStates, _fastWeights, _fastWeightsForHiddenBias);
+            neuralNet->HiddenLayerCalculateActivity(persistentVisibleStates, _effectiveParameters);
         }
 
         float* FastPersistentContrastiveDivergence::GetVisibleStatesOnNegativePhase(int packageId) {
@@ -94,17 +127,41 @@ namespace NeuralNetNative {
         void FastPersistentContrastiveDivergence::RestoreVisibleStates(int packageId) {
             float *persistentVisibleStates = &_persistentVisibleStates[packageId*visibleStatesCount];
             
-            neuralNet->VisibleLayerCalculateActivity(_fastWeights, _fastWeightsForVisibleBias);
+            neuralNet->VisibleLayerCalculateActivity(_effectiveParameters);
 			neuralNet->VisibleLayerCopyTo(persistentVisibleStates);
         }
 
+        bool FastPersistentContrastiveDivergence::SupportsBatchTraining(void) const {
+            return true;
+        }
+
+        void FastPersistentContrastiveDivergence::MakeBatchNegativePhase(float *visibleStatesBatch, float *hiddenStatesBatch, int batchSize) {
+            _chains->CalculateHiddenActivity(neuralNet, _effectiveParameters);
+        }
+
+        int FastPersistentContrastiveDivergence::GetBatchNegativePhaseSize(void) const {
+            return _chains->GetChainsCount();
+        }
+
+        float* FastPersistentContrastiveDivergence::GetVisibleStatesOnBatchNegativePhase(void) {
+            return _chains->GetVisibleStates();
+        }
+
+        float* FastPersistentContrastiveDivergence::GetHiddenStatesOnBatchNegativePhase(void) {
+            return _chains->GetHiddenStates();
+        }
+
+        void FastPersistentContrastiveDivergence::RestoreBatchVisibleStates(void) {
+            _chains->SampleVisibleStates(neuralNet, _effectiveParameters);
+        }
+
         void FastPersistentContrastiveDivergence::ModifyWeightsOfNeuronNet() {
 			float curRegularLearnSpeed = properties->BaseLearnSpeed*properties->FactorStrategy->GetFactor(epochNumber);
 			float curFastLearnSpeed = properties->BaseLearnSpeed*properties->AddedFactorStrategy->GetFactor(epochNumber);
 			
 			float *regularWeights = neuralNet->GetWeights();
             float *packageDerivativeForWeights = gradients->GetPackageDerivativeForWeights();
-			parallel_for(blocked_range<size_t>(0, hiddenStatesCount),
+			DispatchFor(hiddenStatesCount, visibleStatesCount, 10*sizeof(float),
 			[=](const blocked_range<size_t>& r)
 			{
 				for (int j = r.begin(); j < r.end(); j++) {
@@ -122,13 +179,14 @@ namespace NeuralNetNative {
 
 						_fastWeights[weightIndex] = _fastWeightsDecreaseFactor*_fastWeights[weightIndex] +
                                                     curFastLearnSpeed*partialDerivative;
+						_effectiveWeights[weightIndex] = regularWeights[weightIndex] + _fastWeights[weightIndex];
 					}
 				}
 			});
 
 			float *regularVisibleStatesBias = neuralNet->GetVisibleStatesBias();
             float *packageDerivativeForVisibleBias = gradients->GetPackageDerivativeForVisibleBias();
-			parallel_for(blocked_range<size_t>(0, visibleStatesCount),
+			DispatchFor(visibleStatesCount, 1, 10*sizeof(float),
 			[=](const blocked_range<size_t>& r)
 			{
 				for (int i = r.begin(); i < r.end(); i++) {
@@ -142,12 +200,13 @@ namespace NeuralNetNative {
 
 					_fastWeightsForVisibleBias[i] = _fastWeightsDecreaseFactor*_fastWeightsForVisibleBias[i] + 
 						curFastLearnSpeed*partialDerivativeForVisibleBias;
+					_effectiveWeightsForVisibleBias[i] = regularVisibleStatesBias[i] + _fastWeightsForVisibleBias[i];
 				}
 			});		
 
 			float *regularHiddenStatesBias = neuralNet->GetHiddenStatesBias();
             float *packageDerivativeForHiddenBias = gradients->GetPackageDerivativeForHiddenBias();
-			parallel_for(blocked_range<size_t>(0, hiddenStatesCount),
+			DispatchFor(hiddenStatesCount, 1, 10*sizeof(float),
 			[=](const blocked_range<size_t>& r)
 			{
 				for (int j = r.begin(); j < r.end(); j++) {
@@ -161,6 +220,7 @@ namespace NeuralNetNative {
 
 					_fastWeightsForHiddenBias[j] = _fastWeightsDecreaseFactor*_fastWeightsForHiddenBias[j] + 
 						curFastLearnSpeed*partialDerivativeForHiddenBias;
+					_effectiveWeightsForHiddenBias[j] = regularHiddenStatesBias[j] + _fastWeightsForHiddenBias[j];
 				}
 			});
 		}
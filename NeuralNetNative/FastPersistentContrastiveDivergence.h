@@ -6,6 +6,7 @@
 #include "RandomAccessIterator.h"
 #include "TrainSingle.h"
 #include "RestrictedBoltzmannMachine.h"
+#include "PersistentChainPool.h"
 
 namespace NeuralNetNative {
 	namespace RestrictedBoltzmannMachine {
@@ -13,12 +14,17 @@ namespace NeuralNetNative {
 		private:
 			float _fastWeightsDecreaseFactor;
 			float *_persistentVisibleStates;
+			PersistentChainPool *_chains;
 			float *_fastWeights;
 			float *_fastWeightsForVisibleBias;
 			float *_fastWeightsForHiddenBias;
 			float *_oldDeltaRegularWeights;
 			float *_oldDeltaRegularWeightsForVisibleBias;
 			float *_oldDeltaRegularWeightsForHiddenBias;
+			float *_effectiveWeights;
+			float *_effectiveWeightsForVisibleBias;
+			float *_effectiveWeightsForHiddenBias;
+			RbmParameters _effectiveParameters;
 		public:
 			FastPersistentContrastiveDivergence(StandardTypesNative::TrainSingle **trainData,
                                                 int trainDataSize,
@@ -39,6 +45,12 @@ namespace NeuralNetNative {
 		    virtual float* GetHiddenStatesOnNegativePhase(void);
 		    virtual void RestoreVisibleStates(int packageId);
             virtual void ModifyWeightsOfNeuronNet();
+            virtual bool SupportsBatchTraining(void) const;
+            virtual void MakeBatchNegativePhase(float *visibleStatesBatch, float *hiddenStatesBatch, int batchSize);
+            virtual int GetBatchNegativePhaseSize(void) const;
+            virtual float* GetVisibleStatesOnBatchNegativePhase(void);
+            virtual float* GetHiddenStatesOnBatchNegativePhase(void);
+            virtual void RestoreBatchVisibleStates(void);
 		};
 	}
 }
\ No newline at end of file
@@ -0,0 +1,73 @@
+#define NEURALNETNATIVEAPI
+
+#include "Platform.h"
+#include "FeatureExtractor.h"
+#include "ExecutionContext.h"
+#include <algorithm>
+
+namespace NeuralNetNative {
+	namespace RestrictedBoltzmannMachine {
+		FeatureExtractor::FeatureExtractor(RestrictedBoltzmannMachineBase *model, int batchSize, bool sampleStates) {
+			_model = model;
+			_batchSize = std::max(batchSize, 1);
+			_sampleStates = sampleStates;
+		}
+
+		bool FeatureExtractor::Extract(const float *inputRows, int rowsCount, MemoryMappedMatrix *output) const {
+			if ((output->GetRowsCount() < rowsCount) || (output->GetColumnsCount() != _model->GetHiddenStatesCount())) {
+				return false;
+			}
+			ExtractRows(inputRows, 0, rowsCount, output);
+			return true;
+		}
+
+		bool FeatureExtractor::Extract(const MemoryMappedMatrix *input, MemoryMappedMatrix *output) const {
+			int rowsCount = input->GetRowsCount();
+			if ((input->GetColumnsCount() != _model->GetVisibleStatesCount()) || (output->GetRowsCount() < rowsCount) ||
+			    (output->GetColumnsCount() != _model->GetHiddenStatesCount())) {
+				return false;
+			}
+			if (input->GetPrecision() == SinglePrecision) {
+				ExtractRows(input->GetRow(0), 0, rowsCount, output);
+			}
+			else {
+				ExtractRows(0, input, rowsCount, output);
+			}
+			return true;
+		}
+
+		void FeatureExtractor::ExtractRows(const float *inputRows, const MemoryMappedMatrix *input, int rowsCount,
+		                                   MemoryMappedMatrix *output) const {
+			int visibleStatesCount = _model->GetVisibleStatesCount();
+			int hiddenStatesCount = _model->GetHiddenStatesCount();
+			int batchSize = std::min(_batchSize, rowsCount);
+			ExecutionContext::ExecuteIn(_model->GetExecutionContext(), [=]() {
+				// Single precision rows are read and written in place; the others go through buffers.
+				float *visibleStatesBatch = (inputRows == 0) ?
+					(float*)_mm_malloc((size_t)batchSize*visibleStatesCount*sizeof(float), 32) : 0;
+				float *hiddenStatesBatch = (output->GetPrecision() != SinglePrecision) ?
+					(float*)_mm_malloc((size_t)batchSize*hiddenStatesCount*sizeof(float), 32) : 0;
+				for (int first = 0; first < rowsCount; first += batchSize) {
+					int count = std::min(batchSize, rowsCount - first);
+					const float *visibleStates = visibleStatesBatch;
+					if (inputRows != 0) {
+						visibleStates = inputRows + (size_t)first*visibleStatesCount;
+					}
+					else {
+						input->ReadRows(first, count, visibleStatesBatch);
+					}
+					float *hiddenStates = (hiddenStatesBatch != 0) ? hiddenStatesBatch : output->GetRow(first);
+					_model->HiddenLayerCalculateActivity(visibleStates, hiddenStates, count);
+					if (_sampleStates) {
+						_model->HiddenLayerSampling(hiddenStates, count);
+					}
+					if (hiddenStatesBatch != 0) {
+						output->WriteRows(first, count, hiddenStatesBatch);
+					}
+				}
+				_mm_free(visibleStatesBatch);
+				_mm_free(hiddenStatesBatch);
+			});
+		}
+	}
+}
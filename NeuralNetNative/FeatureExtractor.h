@@ -0,0 +1,31 @@
+#pragma once
+
+#include "ExportDll.h"
+#include "MemoryMappedMatrix.h"
+#include "RestrictedBoltzmannMachine.h"
+
+namespace NeuralNetNative {
+	namespace RestrictedBoltzmannMachine {
+		// Streams a data set through the hidden layer of a trained machine and writes the hidden
+		// probabilities, or binary states sampled from them, of every row into a memory-mapped matrix.
+		// Rows go batchSize at a time through the batched products, which spread over the threads of the
+		// machine's execution context, so neither data set has to fit in memory. Sampling draws from the
+		// random stream of the machine, so it must not be used on other threads meanwhile.
+		class NEURALNETNATIVE_EXPORT FeatureExtractor {
+		private:
+			RestrictedBoltzmannMachineBase *_model;
+			int _batchSize;
+			bool _sampleStates;
+		public:
+			// A batchSize below one is taken as one.
+			FeatureExtractor(RestrictedBoltzmannMachineBase *model, int batchSize, bool sampleStates);
+			// rowsCount rows of visible states one after another, e.g. an array in memory or the rows of a
+			// single precision mapped matrix. Row b of the input goes to row b of the output. Returns false
+			// when the output has fewer rows or its columns are not the hidden units.
+			bool Extract(const float *inputRows, int rowsCount, MemoryMappedMatrix *output) const;
+			bool Extract(const MemoryMappedMatrix *input, MemoryMappedMatrix *output) const;
+		private:
+			void ExtractRows(const float *inputRows, const MemoryMappedMatrix *input, int rowsCount, MemoryMappedMatrix *output) const;
+		};
+	}
+}
@@ -1,10 +1,11 @@
 #define NEURALNETNATIVEAPI
-#include <mathimf.h>
+#include "Platform.h"
 #include <immintrin.h>
-#include <tbb\tbb.h>
-#include <tbb\task_scheduler_init.h>
-#include <tbb\parallel_for.h>
-#include <tbb\blocked_range.h>
+#include <tbb/tbb.h>
+#include <tbb/parallel_for.h>
+#include <tbb/blocked_range.h>
+#include "ParallelDispatch.h"
+#include "MatrixKernels.h"
 #include "GaussianBinaryRbm.h"
 
 using namespace tbb;
@@ -12,30 +13,33 @@ using namespace tbb;
 namespace NeuralNetNative {
 	namespace RestrictedBoltzmannMachine {
 		GaussianBinaryRbm::GaussianBinaryRbm(int visibleStatesCount, int hiddenStatesCount) : RestrictedBoltzmannMachineBase(visibleStatesCount, hiddenStatesCount) {
-			_normalDistribution = new std::normal_distribution<float>(0.0f, 1.0f);
 		}
 
 		GaussianBinaryRbm::~GaussianBinaryRbm(void) {
-			delete _normalDistribution;
+		}
+
+		RestrictedBoltzmannMachineBase* GaussianBinaryRbm::Clone(void) {
+			GaussianBinaryRbm *rbm = new GaussianBinaryRbm(_visibleStatesCount, _hiddenStatesCount);
+			rbm->EnableTransposedWeights(_transposedWeights != 0);
+			CopyParametersTo(rbm);
+			return rbm;
 		}
 		
 		void GaussianBinaryRbm::VisibleLayerCalculateActivity(void) {
-			for (int i = 0; i < _visibleStatesCount; i++) {
-				_visibleStates[i] = _visibleStatesBias[i] + (*_normalDistribution)(*_randomDevice);
-				//_visibleStates[i] = 0.0f;
+			if (_transposedWeights != 0) {
+				MatrixKernels::MultiplyTransposed(_hiddenStates, _transposedWeights, _visibleStatesBias, _visibleStates,
+				                                  1, _visibleStatesCount, _hiddenStatesCount);
 			}
-
-			for (int j = 0; j < _hiddenStatesCount; j++) {
-				int weightsStartPos = j*_visibleStatesCount;
-				float hiddenState = _hiddenStates[j];
-				for (int i = 0; i < _visibleStatesCount; i++) {
-					_visibleStates[i] += hiddenState*_weights[weightsStartPos + i];
-				}
+			else {
+				MatrixKernels::Multiply(_hiddenStates, _weights, _visibleStatesBias, _visibleStates,
+				                        1, _visibleStatesCount, _hiddenStatesCount);
 			}
+
+			_random->AddNormal(_visibleStates, _visibleStatesCount);
 		}
 
 		void GaussianBinaryRbm::HiddenLayerCalculateActivity(void) {
-			parallel_for( blocked_range<size_t>(0, _hiddenStatesCount),
+			DispatchFor(_hiddenStatesCount, _visibleStatesCount, sizeof(float),
 			[=](const blocked_range<size_t>& r)
 			{
 				for (int j = r.begin(); j < r.end(); j++) {
@@ -44,13 +48,14 @@ namespace NeuralNetNative {
 					for (int i = 0; i < _visibleStatesCount; i++) {
 						sum += _visibleStates[i]*_weights[weightsStartPos + i];
 					}
-					_hiddenStates[j] = 1.0f/(1.0f + expf(-sum));
+					_hiddenStates[j] = sum;
 				}
 			});
+			HiddenLayerActivation(_hiddenStates, 1);
 		}
 
 		void GaussianBinaryRbm::HiddenLayerCalculateActivity(const float *newVisibleState) {
-			parallel_for( blocked_range<size_t>(0, _hiddenStatesCount),
+			DispatchFor(_hiddenStatesCount, _visibleStatesCount, sizeof(float),
 			[=](const blocked_range<size_t>& r)
 			{
 				for (int j = r.begin(); j < r.end(); j++) {
@@ -59,16 +64,18 @@ namespace NeuralNetNative {
 					for (int i = 0; i < _visibleStatesCount; i++) {
 						sum += newVisibleState[i]*_weights[weightsStartPos + i];
 					}
-					_hiddenStates[j] = 1.0f/(1.0f + expf(-sum));
+					_hiddenStates[j] = sum;
 				}
 			});
+			HiddenLayerActivation(_hiddenStates, 1);
 		}
 
 		void GaussianBinaryRbm::VisibleLayerCalculateActivity(const float *addedWeight, const float *addedVisibleBias) {
 			for (int i = 0; i < _visibleStatesCount; i++) {
-				_visibleStates[i] = _visibleStatesBias[i] + addedVisibleBias[i] + (*_normalDistribution)(*_randomDevice);
+				_visibleStates[i] = _visibleStatesBias[i] + addedVisibleBias[i];
 				//_visibleStates[i] = 0.0f;
 			}
+			_random->AddNormal(_visibleStates, _visibleStatesCount);
 
 			for (int j = 0; j < _hiddenStatesCount; j++) {
 				int weightsStartPos = j*_visibleStatesCount;
@@ -80,7 +87,7 @@ namespace NeuralNetNative {
 		}
 
 		void GaussianBinaryRbm::HiddenLayerCalculateActivity(const float *addedWeight, const float *addedHiddenBias) {
-			parallel_for( blocked_range<size_t>(0, _hiddenStatesCount),
+			DispatchFor(_hiddenStatesCount, _visibleStatesCount, 2*sizeof(float),
 			[=](const blocked_range<size_t>& r)
 			{
 				for (int j = r.begin(); j < r.end(); j++) {
@@ -89,13 +96,14 @@ namespace NeuralNetNative {
 					for (int i = 0; i < _visibleStatesCount; i++) {
 						sum += _visibleStates[i]*(_weights[weightsStartPos + i] + addedWeight[weightsStartPos + i]);
 					}
-					_hiddenStates[j] = 1.0f/(1.0f + expf(-sum));
+					_hiddenStates[j] = sum;
 				}
 			});
+			HiddenLayerActivation(_hiddenStates, 1);
 		}
 
 		void GaussianBinaryRbm::HiddenLayerCalculateActivity(const float *newVisibleState, const float *addedWeight, const float *addedHiddenBias) {
-			parallel_for( blocked_range<size_t>(0, _hiddenStatesCount),
+			DispatchFor(_hiddenStatesCount, _visibleStatesCount, 2*sizeof(float),
 			[=](const blocked_range<size_t>& r)
 			{
 				for (int j = r.begin(); j < r.end(); j++) {
@@ -104,9 +112,87 @@ namespace NeuralNetNative {
 					for (int i = 0; i < _visibleStatesCount; i++) {
 						sum += newVisibleState[i]*(_weights[weightsStartPos + i] + addedWeight[weightsStartPos + i]);
 					}
-					_hiddenStates[j] = 1.0f/(1.0f + expf(-sum));
+					_hiddenStates[j] = sum;
 				}
 			});
+			HiddenLayerActivation(_hiddenStates, 1);
+		}
+
+		void GaussianBinaryRbm::HiddenLayerCalculateActivity(const float *newVisibleState, const RbmParameters &parameters) {
+			MatrixKernels::MultiplyTransposed(newVisibleState, parameters.Weights, parameters.HiddenStatesBias, _hiddenStates,
+			                                  1, _hiddenStatesCount, _visibleStatesCount);
+			HiddenLayerActivation(_hiddenStates, 1);
+		}
+
+		void GaussianBinaryRbm::VisibleLayerCalculateActivity(const RbmParameters &parameters) {
+			MatrixKernels::Multiply(_hiddenStates, parameters.Weights, parameters.VisibleStatesBias, _visibleStates,
+			                        1, _visibleStatesCount, _hiddenStatesCount);
+
+			_random->AddNormal(_visibleStates, _visibleStatesCount);
+		}
+
+		void GaussianBinaryRbm::HiddenLayerCalculateActivity(const float *visibleStatesBatch, float *hiddenStatesBatch, int batchSize) {
+			HiddenLayerCalculatePotentials(visibleStatesBatch, hiddenStatesBatch, batchSize);
+			HiddenLayerActivation(hiddenStatesBatch, batchSize);
+		}
+
+		void GaussianBinaryRbm::VisibleLayerCalculateActivity(const float *hiddenStatesBatch, float *visibleStatesBatch, int batchSize) {
+			MatrixKernels::Multiply(hiddenStatesBatch, _weights, _visibleStatesBias, visibleStatesBatch,
+			                        batchSize, _visibleStatesCount, _hiddenStatesCount);
+			_random->AddNormal(visibleStatesBatch, batchSize*_visibleStatesCount);
+		}
+
+		void GaussianBinaryRbm::HiddenLayerCalculateActivity(const float *visibleStatesBatch, float *hiddenStatesBatch, int batchSize,
+		                                                     const RbmParameters &parameters) {
+			MatrixKernels::MultiplyTransposed(visibleStatesBatch, parameters.Weights, parameters.HiddenStatesBias, hiddenStatesBatch,
+			                                  batchSize, _hiddenStatesCount, _visibleStatesCount);
+			HiddenLayerActivation(hiddenStatesBatch, batchSize);
+		}
+
+		void GaussianBinaryRbm::VisibleLayerCalculateActivity(const float *hiddenStatesBatch, float *visibleStatesBatch, int batchSize,
+		                                                      const RbmParameters &parameters) {
+			MatrixKernels::Multiply(hiddenStatesBatch, parameters.Weights, parameters.VisibleStatesBias, visibleStatesBatch,
+			                        batchSize, _visibleStatesCount, _hiddenStatesCount);
+			_random->AddNormal(visibleStatesBatch, batchSize*_visibleStatesCount);
+		}
+
+		void GaussianBinaryRbm::VisibleLayerCalculateActivity(const float *hiddenStatesBatch, float *visibleStatesBatch, int batchSize,
+		                                                      const float *inverseTemperatures) {
+			// At inverse temperature beta the visible units are N(mean, 1/beta): the mean is scaled by
+			// sqrt(beta), unit noise added and the sum scaled back.
+			float *deviations = (float*)_mm_malloc(2*batchSize*sizeof(float), 32);
+			float *inverseDeviations = deviations + batchSize;
+			for (int b = 0; b < batchSize; b++) {
+				inverseDeviations[b] = sqrtf(inverseTemperatures[b]);
+				deviations[b] = 1.0f/inverseDeviations[b];
+			}
+			MatrixKernels::Multiply(hiddenStatesBatch, _weights, _visibleStatesBias, visibleStatesBatch,
+			                        batchSize, _visibleStatesCount, _hiddenStatesCount);
+			MatrixKernels::ScaleRows(visibleStatesBatch, inverseDeviations, batchSize, _visibleStatesCount);
+			_random->AddNormal(visibleStatesBatch, batchSize*_visibleStatesCount);
+			MatrixKernels::ScaleRows(visibleStatesBatch, deviations, batchSize, _visibleStatesCount);
+			_mm_free(deviations);
+		}
+
+		void GaussianBinaryRbm::CalculateVisibleEnergies(const float *visibleStatesBatch, const float *visibleBias, float *energies, int batchSize) {
+			DispatchFor(batchSize, _visibleStatesCount, 2*sizeof(float),
+			[=](const blocked_range<size_t>& r)
+			{
+				for (int b = r.begin(); b < r.end(); b++) {
+					const float *visibleStates = visibleStatesBatch + (size_t)b*_visibleStatesCount;
+					float energy = 0.0f;
+					for (int i = 0; i < _visibleStatesCount; i++) {
+						float deviation = visibleStates[i] - visibleBias[i];
+						energy += 0.5f*deviation*deviation;
+					}
+					energies[b] = energy;
+				}
+			});
+		}
+
+		float GaussianBinaryRbm::CalculateIndependentLogPartitionFunction(const float *visibleBias) {
+			// Unit variance visible units integrate to sqrt(2*pi) each whatever the bias.
+			return 0.5f*_visibleStatesCount*logf(6.28318530718f) + _hiddenStatesCount*logf(2.0f);
 		}
 
 		void GaussianBinaryRbm::VisibleLayerSampling(void) {
@@ -117,5 +203,8 @@ namespace NeuralNetNative {
 				target[i] = _visibleStates[i];
 			}
 		}
+
+		void GaussianBinaryRbm::VisibleLayerSampling(float *visibleStatesBatch, int batchSize) {
+		}
 	}
 }
\ No newline at end of file
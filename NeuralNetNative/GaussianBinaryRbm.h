@@ -6,19 +6,31 @@
 namespace NeuralNetNative {
 	namespace RestrictedBoltzmannMachine {
 		class NEURALNETNATIVE_EXPORT GaussianBinaryRbm : public RestrictedBoltzmannMachineBase {
-		private:
-			std::normal_distribution<float> *_normalDistribution;
 		public:
 			GaussianBinaryRbm(int visibleStatesCount, int hiddenStatesCount);
 			virtual ~GaussianBinaryRbm(void);
+			virtual RestrictedBoltzmannMachineBase* Clone(void);
 			virtual void VisibleLayerCalculateActivity(void);
 			virtual void HiddenLayerCalculateActivity(void);
 			virtual void HiddenLayerCalculateActivity(const float *newVisibleState);
 			virtual void VisibleLayerCalculateActivity(const float *addedWeight, const float *addedVisibleBias);
 			virtual void HiddenLayerCalculateActivity(const float *addedWeight, const float *addedHiddenBias);
 			virtual void HiddenLayerCalculateActivity(const float *newVisibleState, const float *addedWeight, const float *addedHiddenBias);
+			virtual void HiddenLayerCalculateActivity(const float *newVisibleState, const RbmParameters &parameters);
+			virtual void VisibleLayerCalculateActivity(const RbmParameters &parameters);
+			virtual void HiddenLayerCalculateActivity(const float *visibleStatesBatch, float *hiddenStatesBatch, int batchSize);
+			virtual void VisibleLayerCalculateActivity(const float *hiddenStatesBatch, float *visibleStatesBatch, int batchSize);
+			virtual void HiddenLayerCalculateActivity(const float *visibleStatesBatch, float *hiddenStatesBatch, int batchSize,
+			                                          const RbmParameters &parameters);
+			virtual void VisibleLayerCalculateActivity(const float *hiddenStatesBatch, float *visibleStatesBatch, int batchSize,
+			                                           const RbmParameters &parameters);
+			virtual void VisibleLayerCalculateActivity(const float *hiddenStatesBatch, float *visibleStatesBatch, int batchSize,
+			                                           const float *inverseTemperatures);
+			virtual void CalculateVisibleEnergies(const float *visibleStatesBatch, const float *visibleBias, float *energies, int batchSize);
+			virtual float CalculateIndependentLogPartitionFunction(const float *visibleBias);
 			virtual void VisibleLayerSampling(void);
 			virtual void VisibleLayerSampling(float *target);
+			virtual void VisibleLayerSampling(float *visibleStatesBatch, int batchSize);
 		};
 	}
 }
\ No newline at end of file
@@ -0,0 +1,27 @@
+#define NEURALNETNATIVEAPI
+#include "Platform.h"
+#include "GaussianNreluRbm.h"
+
+namespace NeuralNetNative {
+	namespace RestrictedBoltzmannMachine {
+		GaussianNreluRbm::GaussianNreluRbm(int visibleStatesCount, int hiddenStatesCount) : GaussianBinaryRbm(visibleStatesCount, hiddenStatesCount) {
+		}
+
+		RestrictedBoltzmannMachineBase* GaussianNreluRbm::Clone(void) {
+			GaussianNreluRbm *rbm = new GaussianNreluRbm(_visibleStatesCount, _hiddenStatesCount);
+			rbm->EnableTransposedWeights(_transposedWeights != 0);
+			CopyParametersTo(rbm);
+			return rbm;
+		}
+
+		void GaussianNreluRbm::HiddenLayerSampling(void) {
+		}
+
+		void GaussianNreluRbm::HiddenLayerSampling(float *hiddenStatesBatch, int batchSize) {
+		}
+
+		void GaussianNreluRbm::HiddenLayerActivation(float *hiddenStatesBatch, int batchSize) {
+			_random->NoisyRectifier(hiddenStatesBatch, batchSize*_hiddenStatesCount);
+		}
+	}
+}
@@ -0,0 +1,21 @@
+#pragma once
+
+#include "ExportDll.h"
+#include "GaussianBinaryRbm.h"
+
+namespace NeuralNetNative {
+	namespace RestrictedBoltzmannMachine {
+		// Unit variance Gaussian visible units and noisy rectified linear hidden units. The hidden activity is already the
+		// sample max(0, x + N(0, sigmoid(x))) of the potential x, so hidden sampling keeps it. Free energies
+		// and annealed importance sampling still treat the hidden units as binary.
+		class NEURALNETNATIVE_EXPORT GaussianNreluRbm : public GaussianBinaryRbm {
+		public:
+			GaussianNreluRbm(int visibleStatesCount, int hiddenStatesCount);
+			virtual RestrictedBoltzmannMachineBase* Clone(void);
+			virtual void HiddenLayerSampling(void);
+			virtual void HiddenLayerSampling(float *hiddenStatesBatch, int batchSize);
+		protected:
+			virtual void HiddenLayerActivation(float *hiddenStatesBatch, int batchSize);
+		};
+	}
+}
@@ -0,0 +1,24 @@
+#define NEURALNETNATIVEAPI
+
+#include "GenerativeTrainMethod.h"
+
+namespace NeuralNetNative {
+	namespace ClassificationRbm {
+		GenerativeTrainMethod::
+			GenerativeTrainMethod(StandardTypesNative::TrainPair **trainData,
+			                      int trainDataSize,
+			                      RestrictedBoltzmannMachine::GradientFunction *gradientFunction,
+			                      int methodStepsCount)
+			: ClassificationTrainMethod(trainData, trainDataSize, gradientFunction, methodStepsCount, 1.0f, 0.0f) {
+		}
+
+		GenerativeTrainMethod::
+			GenerativeTrainMethod(StandardTypesNative::TrainPair **trainData,
+			                      StandardTypesNative::TrainPair **testData,
+			                      int trainDataSize, int testDataSize,
+			                      RestrictedBoltzmannMachine::GradientFunction *gradientFunction,
+			                      int methodStepsCount)
+			: ClassificationTrainMethod(trainData, testData, trainDataSize, testDataSize, gradientFunction, methodStepsCount, 1.0f, 0.0f) {
+		}
+	}
+}
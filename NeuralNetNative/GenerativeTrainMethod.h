@@ -0,0 +1,22 @@
+#pragma once
+
+#include "ExportDll.h"
+#include "ClassificationTrainMethod.h"
+
+namespace NeuralNetNative {
+	namespace ClassificationRbm {
+		// CD-k on the joint distribution of the inputs and the labels.
+		class NEURALNETNATIVE_EXPORT GenerativeTrainMethod : public ClassificationTrainMethod {
+		public:
+			GenerativeTrainMethod(StandardTypesNative::TrainPair **trainData,
+			                      int trainDataSize,
+			                      RestrictedBoltzmannMachine::GradientFunction *gradientFunction,
+			                      int methodStepsCount);
+			GenerativeTrainMethod(StandardTypesNative::TrainPair **trainData,
+			                      StandardTypesNative::TrainPair **testData,
+			                      int trainDataSize, int testDataSize,
+			                      RestrictedBoltzmannMachine::GradientFunction *gradientFunction,
+			                      int methodStepsCount);
+		};
+	}
+}
@@ -1,6 +1,7 @@
 #define NEURALNETNATIVEAPI
 
 #include "GradientFunction.h"
+#include <cstddef>
 
 namespace NeuralNetNative {
 	namespace RestrictedBoltzmannMachine {
@@ -14,6 +15,18 @@ namespace NeuralNetNative {
             AllocateMemory();
         }
 
+        void GradientFunction::StorePositivePhaseBatch(float *visibleStatesBatch, float *hiddenStatesBatch, int batchSize) {
+            for (int b = 0; b < batchSize; b++) {
+                StorePositivePhaseData(visibleStatesBatch + (size_t)b*VisibleStatesCount, hiddenStatesBatch + (size_t)b*HiddenStatesCount);
+            }
+        }
+
+        void GradientFunction::StoreNegativePhaseBatch(float *visibleStatesBatch, float *hiddenStatesBatch, int batchSize, float weight) {
+            for (int b = 0; b < batchSize; b++) {
+                StoreNegativePhaseData(visibleStatesBatch + (size_t)b*VisibleStatesCount, hiddenStatesBatch + (size_t)b*HiddenStatesCount);
+            }
+        }
+
         void GradientFunction::AllocateMemory(void) {}
 
         void GradientFunction::DeleteMemory(void) {}
@@ -11,6 +11,10 @@ namespace NeuralNetNative {
             virtual void PrepareToNextPackage(int nextPackageSize) = 0;
             virtual void StorePositivePhaseData(float *visibleStates, float *hiddenStates) = 0;
             virtual void StoreNegativePhaseData(float *visibleStates, float *hiddenStates) = 0;
+            virtual void StorePositivePhaseBatch(float *visibleStatesBatch, float *hiddenStatesBatch, int batchSize);
+            // Every sample counts weight times, so the negative phase may run a different number of chains than
+            // the package has samples. The default implementation stores the samples one by one and ignores weight.
+            virtual void StoreNegativePhaseBatch(float *visibleStatesBatch, float *hiddenStatesBatch, int batchSize, float weight);
             virtual void MakeGradient(float packageFactor) = 0;
         protected:
             RbmGradients *Gradients;
@@ -1,12 +0,0 @@
-#pragma once
-
-#define HyperbolicTangensFunctionGrainSize 20
-#define SigmoidFunctionGrainSize 20
-#define SoftmaxFunctionGrainSize 20
-
-#define SimpleNeuronBlockGrainSize 20
-#define SoftmaxNeuronBlockGrainSize 20
-
-#define BPACollectWeightsGrainSize 1
-#define BPAModifyWeightsGrainSize 1
-#define BPALocalGradientGrainSize 1
\ No newline at end of file
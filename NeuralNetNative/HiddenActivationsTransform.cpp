@@ -0,0 +1,52 @@
+#define NEURALNETNATIVEAPI
+
+#include "Platform.h"
+#include "HiddenActivationsTransform.h"
+#include <algorithm>
+
+namespace NeuralNetNative {
+	namespace RestrictedBoltzmannMachine {
+		HiddenActivationsTransform::HiddenActivationsTransform(const DataTransform *source, RestrictedBoltzmannMachineBase **layers,
+		                                                       int layersCount, bool sampleStates) {
+			_source = source;
+			_layers = layers;
+			_layersCount = layersCount;
+			_sampleStates = sampleStates;
+			_maxStatesCount = layers[0]->GetVisibleStatesCount();
+			for (int l = 0; l < layersCount; l++) {
+				_maxStatesCount = std::max(_maxStatesCount, layers[l]->GetHiddenStatesCount());
+			}
+		}
+
+		int HiddenActivationsTransform::GetOutputLength(void) const {
+			return _layers[_layersCount - 1]->GetHiddenStatesCount();
+		}
+
+		void HiddenActivationsTransform::Transform(StandardTypesNative::TrainSingle *const *samples, int count, float *outputBatch) const {
+			// The buffers are local, so the asynchronous tester can stream batches while training does.
+			float *statesBatch = (float*)_mm_malloc((size_t)count*_maxStatesCount*sizeof(float), 32);
+			float *nextStatesBatch = (float*)_mm_malloc((size_t)count*_maxStatesCount*sizeof(float), 32);
+			int inputLength = _layers[0]->GetVisibleStatesCount();
+			if (_source != 0) {
+				_source->Transform(samples, count, statesBatch);
+			}
+			else {
+				for (int b = 0; b < count; b++) {
+					float *input = samples[b]->Input();
+					std::copy(input, input + inputLength, statesBatch + (size_t)b*inputLength);
+				}
+			}
+			for (int l = 0; l < _layersCount; l++) {
+				float *hiddenStatesBatch = (l == _layersCount - 1) ? outputBatch : nextStatesBatch;
+				_layers[l]->HiddenLayerCalculateActivity(statesBatch, hiddenStatesBatch, count);
+				if (_sampleStates) {
+					std::lock_guard<std::mutex> lock(_samplingMutex);
+					_layers[l]->HiddenLayerSampling(hiddenStatesBatch, count);
+				}
+				std::swap(statesBatch, nextStatesBatch);
+			}
+			_mm_free(statesBatch);
+			_mm_free(nextStatesBatch);
+		}
+	}
+}
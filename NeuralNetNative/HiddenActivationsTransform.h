@@ -0,0 +1,30 @@
+#pragma once
+
+#include "ExportDll.h"
+#include "DataTransform.h"
+#include "RestrictedBoltzmannMachine.h"
+#include <mutex>
+
+namespace NeuralNetNative {
+	namespace RestrictedBoltzmannMachine {
+		// Passes the samples up through a stack of trained layers in batches and returns the hidden
+		// probabilities, or binary states sampled from them, of the top layer. The stack reads the
+		// sample inputs, or the rows of the source transform when one is given. Sampling draws from
+		// the random streams of the layers, so concurrent calls take turns at it, and the states of a
+		// batch then depend on the order in which the calls reach the layers.
+		class NEURALNETNATIVE_EXPORT HiddenActivationsTransform : public DataTransform {
+		private:
+			const DataTransform *_source;
+			RestrictedBoltzmannMachineBase **_layers;
+			int _layersCount;
+			bool _sampleStates;
+			int _maxStatesCount;
+			mutable std::mutex _samplingMutex;
+		public:
+			HiddenActivationsTransform(const DataTransform *source, RestrictedBoltzmannMachineBase **layers,
+			                           int layersCount, bool sampleStates);
+			virtual int GetOutputLength(void) const;
+			virtual void Transform(StandardTypesNative::TrainSingle *const *samples, int count, float *outputBatch) const;
+		};
+	}
+}
@@ -0,0 +1,25 @@
+#define NEURALNETNATIVEAPI
+
+#include "HybridTrainMethod.h"
+
+namespace NeuralNetNative {
+	namespace ClassificationRbm {
+		HybridTrainMethod::
+			HybridTrainMethod(StandardTypesNative::TrainPair **trainData,
+			                  int trainDataSize,
+			                  RestrictedBoltzmannMachine::GradientFunction *gradientFunction,
+			                  int methodStepsCount, float methodsMixRate)
+			: ClassificationTrainMethod(trainData, trainDataSize, gradientFunction, methodStepsCount, methodsMixRate, 1.0f) {
+		}
+
+		HybridTrainMethod::
+			HybridTrainMethod(StandardTypesNative::TrainPair **trainData,
+			                  StandardTypesNative::TrainPair **testData,
+			                  int trainDataSize, int testDataSize,
+			                  RestrictedBoltzmannMachine::GradientFunction *gradientFunction,
+			                  int methodStepsCount, float methodsMixRate)
+			: ClassificationTrainMethod(trainData, testData, trainDataSize, testDataSize, gradientFunction, methodStepsCount,
+			                            methodsMixRate, 1.0f) {
+		}
+	}
+}
@@ -0,0 +1,22 @@
+#pragma once
+
+#include "ExportDll.h"
+#include "ClassificationTrainMethod.h"
+
+namespace NeuralNetNative {
+	namespace ClassificationRbm {
+		// The discriminative gradient plus methodsMixRate times the generative one.
+		class NEURALNETNATIVE_EXPORT HybridTrainMethod : public ClassificationTrainMethod {
+		public:
+			HybridTrainMethod(StandardTypesNative::TrainPair **trainData,
+			                  int trainDataSize,
+			                  RestrictedBoltzmannMachine::GradientFunction *gradientFunction,
+			                  int methodStepsCount, float methodsMixRate);
+			HybridTrainMethod(StandardTypesNative::TrainPair **trainData,
+			                  StandardTypesNative::TrainPair **testData,
+			                  int trainDataSize, int testDataSize,
+			                  RestrictedBoltzmannMachine::GradientFunction *gradientFunction,
+			                  int methodStepsCount, float methodsMixRate);
+		};
+	}
+}
@@ -1,10 +1,11 @@
 #define NEURALNETNATIVEAPI
 
 #include "LinearGradient.h"
-#include <tbb\tbb.h>
-#include <tbb\task_scheduler_init.h>
-#include <tbb\parallel_for.h>
-#include <tbb\blocked_range.h>
+#include <tbb/tbb.h>
+#include <tbb/parallel_for.h>
+#include <tbb/blocked_range.h>
+#include "ParallelDispatch.h"
+#include "MatrixKernels.h"
 
 using namespace tbb;
 
@@ -17,7 +18,7 @@ namespace NeuralNetNative {
             float *packageDerivativeForHiddenBias = Gradients->GetPackageDerivativeForHiddenBias();
             float *packageDerivativeForVisibleBias = Gradients->GetPackageDerivativeForVisibleBias();
             
-            parallel_for( blocked_range<size_t>(0, HiddenStatesCount),
+            DispatchFor(HiddenStatesCount, VisibleStatesCount, 2*sizeof(float),
 			[=](const blocked_range<size_t>& r)
 			{
 				for (int j = r.begin(); j < r.end(); j++) {
@@ -28,7 +29,7 @@ namespace NeuralNetNative {
 				}
 			});
 
-            parallel_for( blocked_range<size_t>(0, VisibleStatesCount),
+            DispatchFor(VisibleStatesCount, 1, 2*sizeof(float),
 			[=](const blocked_range<size_t>& r)
 			{
 				for (int i = r.begin(); i < r.end(); i++) {
@@ -42,7 +43,7 @@ namespace NeuralNetNative {
             float *packageDerivativeForHiddenBias = Gradients->GetPackageDerivativeForHiddenBias();
             float *packageDerivativeForVisibleBias = Gradients->GetPackageDerivativeForVisibleBias();
             
-            parallel_for( blocked_range<size_t>(0, HiddenStatesCount),
+            DispatchFor(HiddenStatesCount, VisibleStatesCount, 2*sizeof(float),
 			[=](const blocked_range<size_t>& r)
 			{
 				for (int j = r.begin(); j < r.end(); j++) {
@@ -53,7 +54,7 @@ namespace NeuralNetNative {
 				}
 			});
 
-            parallel_for( blocked_range<size_t>(0, VisibleStatesCount),
+            DispatchFor(VisibleStatesCount, 1, 2*sizeof(float),
 			[=](const blocked_range<size_t>& r)
 			{
 				for (int i = r.begin(); i < r.end(); i++) {
@@ -62,12 +63,26 @@ namespace NeuralNetNative {
 			});
         }
 
+        void LinearGradient::StorePositivePhaseBatch(float *visibleStatesBatch, float *hiddenStatesBatch, int batchSize) {
+            MatrixKernels::AddTransposedProduct(hiddenStatesBatch, visibleStatesBatch, 1.0f, Gradients->GetPackageDerivativeForWeights(),
+                                                HiddenStatesCount, VisibleStatesCount, batchSize);
+            MatrixKernels::AddColumnSums(hiddenStatesBatch, 1.0f, Gradients->GetPackageDerivativeForHiddenBias(), batchSize, HiddenStatesCount);
+            MatrixKernels::AddColumnSums(visibleStatesBatch, 1.0f, Gradients->GetPackageDerivativeForVisibleBias(), batchSize, VisibleStatesCount);
+        }
+
+        void LinearGradient::StoreNegativePhaseBatch(float *visibleStatesBatch, float *hiddenStatesBatch, int batchSize, float weight) {
+            MatrixKernels::AddTransposedProduct(hiddenStatesBatch, visibleStatesBatch, -weight, Gradients->GetPackageDerivativeForWeights(),
+                                                HiddenStatesCount, VisibleStatesCount, batchSize);
+            MatrixKernels::AddColumnSums(hiddenStatesBatch, -weight, Gradients->GetPackageDerivativeForHiddenBias(), batchSize, HiddenStatesCount);
+            MatrixKernels::AddColumnSums(visibleStatesBatch, -weight, Gradients->GetPackageDerivativeForVisibleBias(), batchSize, VisibleStatesCount);
+        }
+
         void LinearGradient::MakeGradient(float packageFactor) {
             float *packageDerivativeForWeights = Gradients->GetPackageDerivativeForWeights();
             float *packageDerivativeForHiddenBias = Gradients->GetPackageDerivativeForHiddenBias();
             float *packageDerivativeForVisibleBias = Gradients->GetPackageDerivativeForVisibleBias();
 
-            parallel_for( blocked_range<size_t>(0, HiddenStatesCount),
+            DispatchFor(HiddenStatesCount, VisibleStatesCount, 2*sizeof(float),
 			[=](const blocked_range<size_t>& r)
 			{
 				for (int j = r.begin(); j < r.end(); j++) {
@@ -78,7 +93,7 @@ namespace NeuralNetNative {
 				}
 			});
 
-            parallel_for( blocked_range<size_t>(0, VisibleStatesCount),
+            DispatchFor(VisibleStatesCount, 1, 2*sizeof(float),
 			[=](const blocked_range<size_t>& r)
 			{
 				for (int i = r.begin(); i < r.end(); i++) {
@@ -10,6 +10,8 @@ namespace NeuralNetNative {
             virtual void PrepareToNextPackage(int nextPackageSize);
             virtual void StorePositivePhaseData(float *visibleStates, float *hiddenStates);
             virtual void StoreNegativePhaseData(float *visibleStates, float *hiddenStates);
+            virtual void StorePositivePhaseBatch(float *visibleStatesBatch, float *hiddenStatesBatch, int batchSize);
+            virtual void StoreNegativePhaseBatch(float *visibleStatesBatch, float *hiddenStatesBatch, int batchSize, float weight);
             virtual void MakeGradient(float packageFactor);
         };
     }
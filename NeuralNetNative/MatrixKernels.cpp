@@ -0,0 +1,291 @@
+#define NEURALNETNATIVEAPI
+
+#include "Platform.h"
+#include "MatrixKernels.h"
+#include <tbb/tbb.h>
+#include <tbb/parallel_for.h>
+#include <tbb/blocked_range.h>
+#include "ParallelDispatch.h"
+#include <algorithm>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+using namespace tbb;
+
+namespace NeuralNetNative {
+	namespace {
+		const int RowsBlock = 4;
+		const int Lanes = 32;
+		const int ColumnsBlock = 64;
+		const int TransposeBlock = 32;
+		const int WordBits = 64;
+
+		// The index of the lowest set bit of a nonzero word.
+		inline int TrailingZeros(unsigned long long word) {
+#ifdef _MSC_VER
+			unsigned long index;
+			_BitScanForward64(&index, word);
+			return (int)index;
+#else
+			return __builtin_ctzll(word);
+#endif
+		}
+
+		// Dot products of bRow with Rows consecutive rows of a. Partial sums are kept per lane so the
+		// compiler can vectorize the loop without reassociating a single float accumulator.
+		template<int Rows>
+		inline void DotProducts(const float *a, const float *bRow, int k, float *results) {
+			float sums[Rows][Lanes] = {};
+			int vectorizedCount = k - k%Lanes;
+			for (int p = 0; p < vectorizedCount; p += Lanes) {
+				const float *bChunk = bRow + p;
+				for (int l = 0; l < Lanes; l++) {
+					float value = bChunk[l];
+					for (int t = 0; t < Rows; t++) {
+						sums[t][l] += a[(size_t)t*k + p + l]*value;
+					}
+				}
+			}
+
+			for (int t = 0; t < Rows; t++) {
+				const float *aRow = a + (size_t)t*k;
+				float sum = 0.0f;
+				for (int l = 0; l < Lanes; l++) {
+					sum += sums[t][l];
+				}
+				for (int p = vectorizedCount; p < k; p++) {
+					sum += aRow[p]*bRow[p];
+				}
+				results[t] = sum;
+			}
+		}
+
+		// Columns [first, first + width) of Rows consecutive rows of c = a*b + bias.
+		template<int Rows>
+		inline void MultiplyTile(const float *a, const float *b, const float *bias, float *c, int n, int k, int first, int width) {
+			float tile[Rows][ColumnsBlock];
+			for (int t = 0; t < Rows; t++) {
+				for (int l = 0; l < width; l++) {
+					tile[t][l] = (bias != 0) ? bias[first + l] : 0.0f;
+				}
+			}
+
+			float values[Rows];
+			for (int p = 0; p < k; p++) {
+				const float *bRow = b + (size_t)p*n + first;
+				for (int t = 0; t < Rows; t++) {
+					values[t] = a[(size_t)t*k + p];
+				}
+				for (int l = 0; l < width; l++) {
+					float value = bRow[l];
+					for (int t = 0; t < Rows; t++) {
+						tile[t][l] += values[t]*value;
+					}
+				}
+			}
+
+			for (int t = 0; t < Rows; t++) {
+				std::copy(tile[t], tile[t] + width, c + (size_t)t*n + first);
+			}
+		}
+	}
+
+	void MatrixKernels::MultiplyTransposed(const float *a, const float *b, const float *bias, float *c, int m, int n, int k) {
+		DispatchFor(n, m*k, sizeof(float),
+		[=](const blocked_range<size_t>& r)
+		{
+			float results[RowsBlock];
+			for (int j = r.begin(); j < r.end(); j++) {
+				const float *bRow = b + (size_t)j*k;
+				float biasValue = (bias != 0) ? bias[j] : 0.0f;
+				int row = 0;
+				for (; row + RowsBlock <= m; row += RowsBlock) {
+					DotProducts<RowsBlock>(a + (size_t)row*k, bRow, k, results);
+					for (int t = 0; t < RowsBlock; t++) {
+						c[(size_t)(row + t)*n + j] = biasValue + results[t];
+					}
+				}
+				for (; row < m; row++) {
+					DotProducts<1>(a + (size_t)row*k, bRow, k, results);
+					c[(size_t)row*n + j] = biasValue + results[0];
+				}
+			}
+		});
+	}
+
+	void MatrixKernels::Multiply(const float *a, const float *b, const float *bias, float *c, int m, int n, int k) {
+		int blocksCount = (n + ColumnsBlock - 1)/ColumnsBlock;
+		DispatchFor(blocksCount, m*k*ColumnsBlock, sizeof(float),
+		[=](const blocked_range<size_t>& r)
+		{
+			for (int block = r.begin(); block < r.end(); block++) {
+				int first = block*ColumnsBlock;
+				int width = std::min(ColumnsBlock, n - first);
+				int row = 0;
+				for (; row + RowsBlock <= m; row += RowsBlock) {
+					MultiplyTile<RowsBlock>(a + (size_t)row*k, b, bias, c + (size_t)row*n, n, k, first, width);
+				}
+				for (; row < m; row++) {
+					MultiplyTile<1>(a + (size_t)row*k, b, bias, c + (size_t)row*n, n, k, first, width);
+				}
+			}
+		});
+	}
+
+	void MatrixKernels::MultiplyPacked(const unsigned long long *a, int wordsPerRow, const float *b, const float *bias, float *c,
+	                                   int m, int n, int k) {
+		int blocksCount = (n + ColumnsBlock - 1)/ColumnsBlock;
+		DispatchFor(blocksCount, m*k*ColumnsBlock, sizeof(float),
+		[=](const blocked_range<size_t>& r)
+		{
+			float tile[ColumnsBlock];
+			for (int block = r.begin(); block < r.end(); block++) {
+				int first = block*ColumnsBlock;
+				int width = std::min(ColumnsBlock, n - first);
+				for (int row = 0; row < m; row++) {
+					for (int l = 0; l < width; l++) {
+						tile[l] = (bias != 0) ? bias[first + l] : 0.0f;
+					}
+					const unsigned long long *aRow = a + (size_t)row*wordsPerRow;
+					for (int w = 0; w < wordsPerRow; w++) {
+						for (unsigned long long word = aRow[w]; word != 0; word &= word - 1) {
+							int p = w*WordBits + TrailingZeros(word);
+							const float *bRow = b + (size_t)p*n + first;
+							for (int l = 0; l < width; l++) {
+								tile[l] += bRow[l];
+							}
+						}
+					}
+					std::copy(tile, tile + width, c + (size_t)row*n + first);
+				}
+			}
+		});
+	}
+
+	void MatrixKernels::MultiplyTransposedPacked(const unsigned long long *a, int wordsPerRow, const float *b, const float *bias, float *c,
+	                                             int m, int n, int k) {
+		DispatchFor(n, m*k, sizeof(float),
+		[=](const blocked_range<size_t>& r)
+		{
+			for (int j = r.begin(); j < r.end(); j++) {
+				const float *bRow = b + (size_t)j*k;
+				float biasValue = (bias != 0) ? bias[j] : 0.0f;
+				for (int row = 0; row < m; row++) {
+					const unsigned long long *aRow = a + (size_t)row*wordsPerRow;
+					float sum = biasValue;
+					for (int w = 0; w < wordsPerRow; w++) {
+						for (unsigned long long word = aRow[w]; word != 0; word &= word - 1) {
+							sum += bRow[w*WordBits + TrailingZeros(word)];
+						}
+					}
+					c[(size_t)row*n + j] = sum;
+				}
+			}
+		});
+	}
+
+	void MatrixKernels::AddTransposedProduct(const float *a, const float *b, float alpha, float *c, int m, int n, int k) {
+		DispatchFor(m, n*k, sizeof(float),
+		[=](const blocked_range<size_t>& r)
+		{
+			for (int i = r.begin(); i < r.end(); i++) {
+				float *cRow = c + (size_t)i*n;
+				int p = 0;
+				for (; p + RowsBlock <= k; p += RowsBlock) {
+					float value0 = alpha*a[(size_t)p*m + i];
+					float value1 = alpha*a[(size_t)(p + 1)*m + i];
+					float value2 = alpha*a[(size_t)(p + 2)*m + i];
+					float value3 = alpha*a[(size_t)(p + 3)*m + i];
+					const float *b0 = b + (size_t)p*n;
+					const float *b1 = b0 + n;
+					const float *b2 = b1 + n;
+					const float *b3 = b2 + n;
+					for (int l = 0; l < n; l++) {
+						cRow[l] += value0*b0[l] + value1*b1[l] + value2*b2[l] + value3*b3[l];
+					}
+				}
+				for (; p < k; p++) {
+					float value = alpha*a[(size_t)p*m + i];
+					const float *bRow = b + (size_t)p*n;
+					for (int l = 0; l < n; l++) {
+						cRow[l] += value*bRow[l];
+					}
+				}
+			}
+		});
+	}
+
+	void MatrixKernels::AddColumnSums(const float *a, float alpha, float *sums, int m, int n) {
+		DispatchFor(n, m, sizeof(float),
+		[=](const blocked_range<size_t>& r)
+		{
+			for (int p = 0; p < m; p++) {
+				const float *aRow = a + (size_t)p*n;
+				for (int l = r.begin(); l < r.end(); l++) {
+					sums[l] += alpha*aRow[l];
+				}
+			}
+		});
+	}
+
+	void MatrixKernels::Transpose(const float *a, float *b, int m, int n) {
+		int blocksCount = (n + TransposeBlock - 1)/TransposeBlock;
+		DispatchFor(blocksCount, m*TransposeBlock, 2*sizeof(float),
+		[=](const blocked_range<size_t>& r)
+		{
+			for (int block = r.begin(); block < r.end(); block++) {
+				int firstColumn = block*TransposeBlock;
+				int lastColumn = std::min(firstColumn + TransposeBlock, n);
+				for (int firstRow = 0; firstRow < m; firstRow += TransposeBlock) {
+					int lastRow = std::min(firstRow + TransposeBlock, m);
+					for (int i = firstColumn; i < lastColumn; i++) {
+						for (int j = firstRow; j < lastRow; j++) {
+							b[(size_t)i*m + j] = a[(size_t)j*n + i];
+						}
+					}
+				}
+			}
+		});
+	}
+
+	void MatrixKernels::Sigmoid(float *values, int count) {
+		DispatchFor(count, 1, 2*sizeof(float),
+		[=](const blocked_range<size_t>& r)
+		{
+			for (int i = r.begin(); i < r.end(); i++) {
+				values[i] = 1.0f/(1.0f + expf(-values[i]));
+			}
+		});
+	}
+
+	void MatrixKernels::ScaleRows(float *values, const float *factors, int m, int n) {
+		DispatchFor(m, n, 2*sizeof(float),
+		[=](const blocked_range<size_t>& r)
+		{
+			for (int i = r.begin(); i < r.end(); i++) {
+				float factor = factors[i];
+				float *row = values + (size_t)i*n;
+				for (int j = 0; j < n; j++) {
+					row[j] *= factor;
+				}
+			}
+		});
+	}
+
+	void MatrixKernels::AddSoftplusRowSums(const float *a, float scale, float alpha, float *sums, int m, int n) {
+		DispatchFor(m, n, sizeof(float),
+		[=](const blocked_range<size_t>& r)
+		{
+			for (int i = r.begin(); i < r.end(); i++) {
+				const float *row = a + (size_t)i*n;
+				float sum = 0.0f;
+				for (int j = 0; j < n; j++) {
+					float x = scale*row[j];
+					sum += fmaxf(x, 0.0f) + log1pf(expf(-fabsf(x)));
+				}
+				sums[i] += alpha*sum;
+			}
+		});
+	}
+}
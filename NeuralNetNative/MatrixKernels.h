@@ -0,0 +1,32 @@
+#pragma once
+
+#include "ExportDll.h"
+
+namespace NeuralNetNative {
+	// Row-major single precision matrix products for minibatch training. A batch of states is
+	// a matrix with one sample per row; weights keep their usual [hidden x visible] layout.
+	class NEURALNETNATIVE_EXPORT MatrixKernels {
+	public:
+		// c[m x n] = a[m x k]*b[n x k]^T + bias[n]
+		static void MultiplyTransposed(const float *a, const float *b, const float *bias, float *c, int m, int n, int k);
+		// c[m x n] = a[m x k]*b[k x n] + bias[n]
+		static void Multiply(const float *a, const float *b, const float *bias, float *c, int m, int n, int k);
+		// The same products for binary a packed one bit per column, wordsPerRow words per row: every
+		// set bit adds a row of b (a column of b^T), the clear ones are skipped.
+		static void MultiplyPacked(const unsigned long long *a, int wordsPerRow, const float *b, const float *bias, float *c,
+		                           int m, int n, int k);
+		static void MultiplyTransposedPacked(const unsigned long long *a, int wordsPerRow, const float *b, const float *bias, float *c,
+		                                     int m, int n, int k);
+		// c[m x n] += alpha*a[k x m]^T*b[k x n]
+		static void AddTransposedProduct(const float *a, const float *b, float alpha, float *c, int m, int n, int k);
+		// sums[n] += alpha*(sum of the rows of a[m x n])
+		static void AddColumnSums(const float *a, float alpha, float *sums, int m, int n);
+		// b[n x m] = a[m x n]^T
+		static void Transpose(const float *a, float *b, int m, int n);
+		static void Sigmoid(float *values, int count);
+		// values[m x n], row i multiplied by factors[i]
+		static void ScaleRows(float *values, const float *factors, int m, int n);
+		// sums[i] += alpha*(sum over j of log(1 + exp(scale*a[i][j]))), a[m x n]
+		static void AddSoftplusRowSums(const float *a, float scale, float alpha, float *sums, int m, int n);
+	};
+}
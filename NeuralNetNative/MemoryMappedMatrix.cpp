@@ -0,0 +1,314 @@
+#define NEURALNETNATIVEAPI
+#include "MemoryMappedMatrix.h"
+#include <tbb/tbb.h>
+#include <tbb/parallel_for.h>
+#include <tbb/blocked_range.h>
+#include "ParallelDispatch.h"
+#include <algorithm>
+#include <climits>
+#include <cstring>
+#include <string>
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <unistd.h>
+#endif
+
+using namespace tbb;
+
+namespace NeuralNetNative {
+	namespace {
+		size_t GetElementSize(MatrixPrecision precision) {
+			return (precision == HalfPrecision) ? sizeof(unsigned short) : sizeof(float);
+		}
+
+		// Rounds to the nearest half, ties to even; values beyond the half range become infinities.
+		inline unsigned short ToHalf(float value) {
+			const unsigned int HalfOverflow = (127 + 16) << 23;
+			const unsigned int SubnormalLimit = 113 << 23;
+			const unsigned int SubnormalMagicBits = ((127 - 15) + (23 - 10) + 1) << 23;
+			unsigned int bits;
+			memcpy(&bits, &value, sizeof(bits));
+			unsigned int sign = bits & 0x80000000u;
+			bits ^= sign;
+			unsigned int half;
+			if (bits >= HalfOverflow) {
+				half = (bits > 0x7f800000u) ? 0x7e00u : 0x7c00u;
+			}
+			else if (bits < SubnormalLimit) {
+				float subnormalMagic;
+				memcpy(&subnormalMagic, &SubnormalMagicBits, sizeof(subnormalMagic));
+				float shifted;
+				memcpy(&shifted, &bits, sizeof(shifted));
+				shifted += subnormalMagic;
+				memcpy(&bits, &shifted, sizeof(bits));
+				half = bits - SubnormalMagicBits;
+			}
+			else {
+				unsigned int oddMantissa = (bits >> 13) & 1;
+				bits += ((unsigned int)(15 - 127) << 23) + 0xfff + oddMantissa;
+				half = bits >> 13;
+			}
+			return (unsigned short)(half | (sign >> 16));
+		}
+
+		inline float FromHalf(unsigned short half) {
+			const unsigned int ShiftedExponent = 0x7c00u << 13;
+			const unsigned int SubnormalMagicBits = 113 << 23;
+			unsigned int bits = (half & 0x7fffu) << 13;
+			unsigned int exponent = bits & ShiftedExponent;
+			bits += (127 - 15) << 23;
+			if (exponent == ShiftedExponent) {
+				bits += (128 - 16) << 23;
+			}
+			else if (exponent == 0) {
+				float subnormalMagic;
+				memcpy(&subnormalMagic, &SubnormalMagicBits, sizeof(subnormalMagic));
+				bits += 1 << 23;
+				float value;
+				memcpy(&value, &bits, sizeof(value));
+				value -= subnormalMagic;
+				memcpy(&bits, &value, sizeof(bits));
+			}
+			bits |= (unsigned int)(half & 0x8000u) << 16;
+			float value;
+			memcpy(&value, &bits, sizeof(value));
+			return value;
+		}
+	}
+
+	MemoryMappedMatrix::MemoryMappedMatrix(int rows, int columns, MatrixPrecision precision) {
+		_rows = rows;
+		_columns = columns;
+		_precision = precision;
+		_size = (size_t)rows*columns*GetElementSize(precision);
+		_data = 0;
+		_file = 0;
+		_mapping = 0;
+	}
+
+	MemoryMappedMatrix* MemoryMappedMatrix::Create(const char *directory, int rows, int columns) {
+		MemoryMappedMatrix *matrix = new MemoryMappedMatrix(rows, columns, SinglePrecision);
+		if (matrix->_size == 0) {
+			return matrix;
+		}
+#ifdef _WIN32
+		char path[MAX_PATH];
+		if (GetTempFileNameA(directory, "nnm", 0, path) == 0) {
+			delete matrix;
+			return 0;
+		}
+		HANDLE file = CreateFileA(path, GENERIC_READ | GENERIC_WRITE, 0, 0, CREATE_ALWAYS,
+		                          FILE_ATTRIBUTE_TEMPORARY | FILE_FLAG_DELETE_ON_CLOSE, 0);
+		if (file == INVALID_HANDLE_VALUE) {
+			DeleteFileA(path);
+			delete matrix;
+			return 0;
+		}
+		matrix->_file = file;
+		HANDLE mapping = CreateFileMappingA(file, 0, PAGE_READWRITE, (DWORD)((unsigned long long)matrix->_size >> 32),
+		                                    (DWORD)(matrix->_size & 0xFFFFFFFF), 0);
+		if (mapping == 0) {
+			delete matrix;
+			return 0;
+		}
+		matrix->_mapping = mapping;
+		matrix->_data = MapViewOfFile(mapping, FILE_MAP_ALL_ACCESS, 0, 0, matrix->_size);
+#else
+		std::string path = std::string(directory) + "/nnmXXXXXX";
+		int file = mkstemp(&path[0]);
+		if (file < 0) {
+			delete matrix;
+			return 0;
+		}
+		// The mapping keeps the unlinked file alive until it is unmapped.
+		unlink(path.c_str());
+		if (ftruncate(file, (off_t)matrix->_size) == 0) {
+			void *data = mmap(0, matrix->_size, PROT_READ | PROT_WRITE, MAP_SHARED, file, 0);
+			matrix->_data = (data == MAP_FAILED) ? 0 : data;
+		}
+		close(file);
+#endif
+		if (matrix->_data == 0) {
+			delete matrix;
+			return 0;
+		}
+		return matrix;
+	}
+
+	MemoryMappedMatrix* MemoryMappedMatrix::CreateAt(const char *path, int rows, int columns, MatrixPrecision precision) {
+		MemoryMappedMatrix *matrix = new MemoryMappedMatrix(rows, columns, precision);
+#ifdef _WIN32
+		HANDLE file = CreateFileA(path, GENERIC_READ | GENERIC_WRITE, 0, 0, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, 0);
+		if (file == INVALID_HANDLE_VALUE) {
+			delete matrix;
+			return 0;
+		}
+		matrix->_file = file;
+		if (matrix->_size == 0) {
+			return matrix;
+		}
+		HANDLE mapping = CreateFileMappingA(file, 0, PAGE_READWRITE, (DWORD)((unsigned long long)matrix->_size >> 32),
+		                                    (DWORD)(matrix->_size & 0xFFFFFFFF), 0);
+		if (mapping == 0) {
+			delete matrix;
+			return 0;
+		}
+		matrix->_mapping = mapping;
+		matrix->_data = MapViewOfFile(mapping, FILE_MAP_ALL_ACCESS, 0, 0, matrix->_size);
+#else
+		int file = open(path, O_RDWR | O_CREAT | O_TRUNC, 0644);
+		if (file < 0) {
+			delete matrix;
+			return 0;
+		}
+		if (matrix->_size == 0) {
+			close(file);
+			return matrix;
+		}
+		if (ftruncate(file, (off_t)matrix->_size) == 0) {
+			void *data = mmap(0, matrix->_size, PROT_READ | PROT_WRITE, MAP_SHARED, file, 0);
+			matrix->_data = (data == MAP_FAILED) ? 0 : data;
+		}
+		close(file);
+#endif
+		if (matrix->_data == 0) {
+			delete matrix;
+			return 0;
+		}
+		return matrix;
+	}
+
+	MemoryMappedMatrix* MemoryMappedMatrix::Open(const char *path, int columns, MatrixPrecision precision) {
+		unsigned long long rowSize = (unsigned long long)columns*GetElementSize(precision);
+#ifdef _WIN32
+		HANDLE file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, 0, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, 0);
+		if (file == INVALID_HANDLE_VALUE) {
+			return 0;
+		}
+		LARGE_INTEGER fileSize;
+		if ((GetFileSizeEx(file, &fileSize) == 0) || (rowSize == 0) || ((unsigned long long)fileSize.QuadPart%rowSize != 0) ||
+		    ((unsigned long long)fileSize.QuadPart/rowSize > INT_MAX)) {
+			CloseHandle(file);
+			return 0;
+		}
+		MemoryMappedMatrix *matrix = new MemoryMappedMatrix((int)((unsigned long long)fileSize.QuadPart/rowSize), columns, precision);
+		matrix->_file = file;
+		if (matrix->_size == 0) {
+			return matrix;
+		}
+		HANDLE mapping = CreateFileMappingA(file, 0, PAGE_READONLY, 0, 0, 0);
+		if (mapping == 0) {
+			delete matrix;
+			return 0;
+		}
+		matrix->_mapping = mapping;
+		matrix->_data = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, matrix->_size);
+#else
+		int file = open(path, O_RDONLY);
+		if (file < 0) {
+			return 0;
+		}
+		struct stat status;
+		if ((fstat(file, &status) != 0) || (rowSize == 0) || ((unsigned long long)status.st_size%rowSize != 0) ||
+		    ((unsigned long long)status.st_size/rowSize > INT_MAX)) {
+			close(file);
+			return 0;
+		}
+		MemoryMappedMatrix *matrix = new MemoryMappedMatrix((int)((unsigned long long)status.st_size/rowSize), columns, precision);
+		if (matrix->_size == 0) {
+			close(file);
+			return matrix;
+		}
+		void *data = mmap(0, matrix->_size, PROT_READ, MAP_SHARED, file, 0);
+		matrix->_data = (data == MAP_FAILED) ? 0 : data;
+		close(file);
+#endif
+		if (matrix->_data == 0) {
+			delete matrix;
+			return 0;
+		}
+		return matrix;
+	}
+
+	MemoryMappedMatrix::~MemoryMappedMatrix(void) {
+#ifdef _WIN32
+		if (_data != 0) {
+			UnmapViewOfFile(_data);
+		}
+		if (_mapping != 0) {
+			CloseHandle((HANDLE)_mapping);
+		}
+		if (_file != 0) {
+			CloseHandle((HANDLE)_file);
+		}
+#else
+		if (_data != 0) {
+			munmap(_data, _size);
+		}
+#endif
+	}
+
+	float* MemoryMappedMatrix::GetRow(int row) {
+		return (float*)_data + (size_t)row*_columns;
+	}
+
+	const float* MemoryMappedMatrix::GetRow(int row) const {
+		return (const float*)_data + (size_t)row*_columns;
+	}
+
+	void MemoryMappedMatrix::ReadRows(int firstRow, int rowsCount, float *rows) const {
+		if (_precision == SinglePrecision) {
+			const float *values = GetRow(firstRow);
+			std::copy(values, values + (size_t)rowsCount*_columns, rows);
+			return;
+		}
+		const unsigned short *halves = (const unsigned short*)_data + (size_t)firstRow*_columns;
+		DispatchFor(rowsCount, _columns, 3*sizeof(unsigned short),
+		[=](const blocked_range<size_t>& r)
+		{
+			for (int row = r.begin(); row < r.end(); row++) {
+				const unsigned short *rowHalves = halves + (size_t)row*_columns;
+				float *rowValues = rows + (size_t)row*_columns;
+				for (int i = 0; i < _columns; i++) {
+					rowValues[i] = FromHalf(rowHalves[i]);
+				}
+			}
+		});
+	}
+
+	void MemoryMappedMatrix::WriteRows(int firstRow, int rowsCount, const float *rows) {
+		if (_precision == SinglePrecision) {
+			std::copy(rows, rows + (size_t)rowsCount*_columns, GetRow(firstRow));
+			return;
+		}
+		unsigned short *halves = (unsigned short*)_data + (size_t)firstRow*_columns;
+		DispatchFor(rowsCount, _columns, 3*sizeof(unsigned short),
+		[=](const blocked_range<size_t>& r)
+		{
+			for (int row = r.begin(); row < r.end(); row++) {
+				const float *rowValues = rows + (size_t)row*_columns;
+				unsigned short *rowHalves = halves + (size_t)row*_columns;
+				for (int i = 0; i < _columns; i++) {
+					rowHalves[i] = ToHalf(rowValues[i]);
+				}
+			}
+		});
+	}
+
+	int MemoryMappedMatrix::GetRowsCount(void) const {
+		return _rows;
+	}
+
+	int MemoryMappedMatrix::GetColumnsCount(void) const {
+		return _columns;
+	}
+
+	MatrixPrecision MemoryMappedMatrix::GetPrecision(void) const {
+		return _precision;
+	}
+}
\ No newline at end of file
@@ -0,0 +1,44 @@
+#pragma once
+
+#include "ExportDll.h"
+#include <cstddef>
+
+namespace NeuralNetNative {
+	enum MatrixPrecision {
+		SinglePrecision,
+		// IEEE binary16 values, converted from and to floats by ReadRows and WriteRows.
+		HalfPrecision
+	};
+
+	// Matrix backed by a file, so that data larger than the memory is paged in and out by the system.
+	// A temporary file is deleted as soon as the matrix is released, a named one is kept.
+	class NEURALNETNATIVE_EXPORT MemoryMappedMatrix {
+	private:
+		int _rows;
+		int _columns;
+		MatrixPrecision _precision;
+		size_t _size;
+		void *_data;
+		void *_file;
+		void *_mapping;
+	public:
+		// Returns 0 when the file cannot be created in the directory or mapped.
+		static MemoryMappedMatrix* Create(const char *directory, int rows, int columns);
+		// Creates or overwrites the file at the path. Returns 0 when it cannot be created or mapped.
+		static MemoryMappedMatrix* CreateAt(const char *path, int rows, int columns, MatrixPrecision precision);
+		// Maps an existing file of rows of columns values read-only; the rows count follows from its size.
+		// Returns 0 when it cannot be opened or mapped or its size is not a whole number of rows.
+		static MemoryMappedMatrix* Open(const char *path, int columns, MatrixPrecision precision);
+		~MemoryMappedMatrix(void);
+		// Rows of single precision matrices only.
+		float* GetRow(int row);
+		const float* GetRow(int row) const;
+		void ReadRows(int firstRow, int rowsCount, float *rows) const;
+		void WriteRows(int firstRow, int rowsCount, const float *rows);
+		int GetRowsCount(void) const;
+		int GetColumnsCount(void) const;
+		MatrixPrecision GetPrecision(void) const;
+	private:
+		MemoryMappedMatrix(int rows, int columns, MatrixPrecision precision);
+	};
+}
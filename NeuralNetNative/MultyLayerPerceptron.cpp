@@ -1,5 +1,6 @@
 #define NEURALNETNATIVEAPI
 #include "MultyLayerPerceptron.h"
+#include "ExecutionContext.h"
 
 namespace NeuralNetNative {
 	namespace MultyLayerPerceptron {
@@ -13,7 +14,6 @@ namespace NeuralNetNative {
 		}
 
 		MultyLayerPerceptron::~MultyLayerPerceptron(void) {
-			_layersCount = 0;
 			if (_layers != 0) {
 				for (int i = 0; i < _layersCount; i++) {
 					if (_layers[i] != 0) {
@@ -21,6 +21,7 @@ namespace NeuralNetNative {
 					}
 				}
 			}
+			_layersCount = 0;
 			delete [] _layers;
 		}
 
@@ -35,9 +36,11 @@ namespace NeuralNetNative {
 		}
 
 		void MultyLayerPerceptron::Predict(const float *input, float *output) {
-			CalculateFirstLayer(input);
-			CalculateLeftoverLayers();
-			SetOutput(output);
+			ExecutionContext::ExecuteIn(_executionContext, [=]() {
+				CalculateFirstLayer(input);
+				CalculateLeftoverLayers();
+				SetOutput(output);
+			});
 		}
 
 		BaseNeuralBlock** MultyLayerPerceptron::GetLayers(void) {
@@ -56,6 +59,31 @@ namespace NeuralNetNative {
 			return _layers[_lastLayerNum]->GetSize();
 		}
 
+		MultyLayerPerceptron* MultyLayerPerceptron::Clone(void) {
+			MultyLayerPerceptron *neuralNet = new MultyLayerPerceptron(_layersCount);
+			BaseNeuralBlock *parent = 0;
+			for (int layerNum = FirstLayerNum; layerNum < _layersCount; layerNum++) {
+				parent = _layers[layerNum]->Clone(parent);
+				neuralNet->AddNeuralBlock(parent, layerNum);
+			}
+			return neuralNet;
+		}
+
+		void MultyLayerPerceptron::CopyParametersTo(MultyLayerPerceptron *target) {
+			for (int layerNum = FirstLayerNum; layerNum < _layersCount; layerNum++) {
+				_layers[layerNum]->CopyParametersTo(target->_layers[layerNum]);
+			}
+		}
+
+		void MultyLayerPerceptron::SetNumaPlacement(NumaPlacement placement, bool replicateWeights) {
+			for (int layerNum = FirstLayerNum; layerNum < _layersCount; layerNum++) {
+				if (_layers[layerNum]->GetWeightsPlacement() != placement) {
+					_layers[layerNum]->SetWeightsPlacement(placement);
+				}
+				_layers[layerNum]->SetWeightReplicas(replicateWeights);
+			}
+		}
+
 		void MultyLayerPerceptron::CalculateFirstLayer(const float *input) {
 			_layers[FirstLayerNum]->Calculate(input);
 		}
@@ -24,6 +24,9 @@ namespace NeuralNetNative {
 			int GetLayersCount(void);
 			int GetInputSize(void);
 			int GetOutputSize(void);
+			MultyLayerPerceptron* Clone(void);
+			void CopyParametersTo(MultyLayerPerceptron *target);
+			void SetNumaPlacement(NumaPlacement placement, bool replicateWeights);
 		private:
 			void CalculateFirstLayer(const float *input);
 			void CalculateLeftoverLayers(void);
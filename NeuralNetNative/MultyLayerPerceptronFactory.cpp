@@ -1,5 +1,5 @@
 #define NEURALNETNATIVEAPI
-#include <mathimf.h>
+#include "Platform.h"
 #include "MultyLayerPerceptronFactory.h"
 #include "BaseNeuralBlock.h"
 #include "SimpleNeuronBlock.h"
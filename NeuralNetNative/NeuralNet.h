@@ -1,7 +1,17 @@
 #pragma once
 
 namespace NeuralNetNative {
+	class ExecutionContext;
+
 	class NeuralNet {
+	protected:
+		ExecutionContext *_executionContext;
+	public:
+		NeuralNet(void) : _executionContext(0) {}
+		virtual ~NeuralNet(void) {}
+		void SetExecutionContext(ExecutionContext *context) { _executionContext = context; }
+		ExecutionContext* GetExecutionContext(void) const { return _executionContext; }
+	private:
 		virtual void Predict(const float *input, float *output) = 0;
 	};
 }
\ No newline at end of file
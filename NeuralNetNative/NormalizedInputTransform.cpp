@@ -0,0 +1,32 @@
+#define NEURALNETNATIVEAPI
+
+#include "Platform.h"
+#include "NormalizedInputTransform.h"
+#include <tbb/tbb.h>
+#include <tbb/parallel_for.h>
+#include <tbb/blocked_range.h>
+#include "ParallelDispatch.h"
+
+using namespace tbb;
+
+namespace NeuralNetNative {
+	NormalizedInputTransform::NormalizedInputTransform(StandardTypesNative::NormalizeMethod *normalizeMethod) {
+		_normalizeMethod = normalizeMethod;
+	}
+
+	int NormalizedInputTransform::GetOutputLength(void) const {
+		return _normalizeMethod->InputVectorSize();
+	}
+
+	void NormalizedInputTransform::Transform(StandardTypesNative::TrainSingle *const *samples, int count, float *outputBatch) const {
+		StandardTypesNative::NormalizeMethod *normalizeMethod = _normalizeMethod;
+		int length = normalizeMethod->InputVectorSize();
+		DispatchFor(count, length, 4*sizeof(float),
+		[=](const blocked_range<size_t>& r)
+		{
+			for (int b = r.begin(); b < r.end(); b++) {
+				normalizeMethod->CopyNormalizedInputVector(samples[b]->Input(), outputBatch + (size_t)b*length);
+			}
+		});
+	}
+}
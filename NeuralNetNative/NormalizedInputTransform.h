@@ -0,0 +1,18 @@
+#pragma once
+
+#include "ExportDll.h"
+#include "DataTransform.h"
+#include "NormalizeMethod.h"
+
+namespace NeuralNetNative {
+	// Gathers the sample inputs into the batch normalized by the method on the way, so the data itself
+	// is neither rewritten nor read a second time. The method must have collected its statistics.
+	class NEURALNETNATIVE_EXPORT NormalizedInputTransform : public DataTransform {
+	private:
+		StandardTypesNative::NormalizeMethod *_normalizeMethod;
+	public:
+		NormalizedInputTransform(StandardTypesNative::NormalizeMethod *normalizeMethod);
+		virtual int GetOutputLength(void) const;
+		virtual void Transform(StandardTypesNative::TrainSingle *const *samples, int count, float *outputBatch) const;
+	};
+}
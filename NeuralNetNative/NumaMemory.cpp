@@ -0,0 +1,203 @@
+#define NEURALNETNATIVEAPI
+#include "NumaMemory.h"
+#include "Platform.h"
+#include <cstdio>
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace NeuralNetNative {
+	namespace {
+		struct NumaBlockHeader {
+		public:
+			size_t Size;
+			int Placement;
+			bool Mapped;
+		};
+
+		const size_t HeaderSize = 64;
+		const size_t PageSize = 4096;
+#ifdef _WIN32
+		const size_t InterleaveChunkSize = 16*PageSize;
+#else
+		const int PreferredPolicy = 1;
+		const int InterleavePolicy = 3;
+#endif
+
+		size_t RoundUpToPage(size_t size) {
+			return (size + PageSize - 1)/PageSize*PageSize;
+		}
+
+		int DetectNodesCount(void) {
+#ifdef _WIN32
+			ULONG highestNode = 0;
+			if (!GetNumaHighestNodeNumber(&highestNode)) {
+				return 1;
+			}
+			return (int)highestNode + 1;
+#else
+			int nodesCount = 1;
+			FILE *file = fopen("/sys/devices/system/node/online", "r");
+			if (file != 0) {
+				int first, last;
+				if (fscanf(file, "%d-%d", &first, &last) == 2) {
+					nodesCount = last + 1;
+				}
+				fclose(file);
+			}
+			return nodesCount;
+#endif
+		}
+
+		char* MapMemory(size_t size) {
+#ifdef _WIN32
+			return (char*)VirtualAlloc(0, size, MEM_RESERVE, PAGE_READWRITE);
+#else
+			void *memory = mmap(0, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+			return (memory == MAP_FAILED) ? 0 : (char*)memory;
+#endif
+		}
+
+		void UnmapMemory(char *memory, size_t size) {
+#ifdef _WIN32
+			VirtualFree(memory, 0, MEM_RELEASE);
+#else
+			munmap(memory, size);
+#endif
+		}
+
+		void BindToNode(char *memory, size_t size, int node) {
+			if (size == 0) {
+				return;
+			}
+#ifdef _WIN32
+			VirtualAllocExNuma(GetCurrentProcess(), memory, size, MEM_COMMIT, PAGE_READWRITE, (DWORD)node);
+#else
+			unsigned long nodeMask = 1UL << node;
+			syscall(SYS_mbind, memory, size, PreferredPolicy, &nodeMask, 8*sizeof(nodeMask), 0);
+#endif
+		}
+
+		void InterleaveOverNodes(char *memory, size_t size, int nodesCount) {
+#ifdef _WIN32
+			int node = 0;
+			for (size_t offset = 0; offset < size; offset += InterleaveChunkSize) {
+				size_t chunkSize = (size - offset < InterleaveChunkSize) ? size - offset : InterleaveChunkSize;
+				BindToNode(memory + offset, chunkSize, node);
+				node = (node + 1)%nodesCount;
+			}
+#else
+			unsigned long nodeMask = (nodesCount >= (int)(8*sizeof(nodeMask))) ? ~0UL : (1UL << nodesCount) - 1;
+			syscall(SYS_mbind, memory, size, InterleavePolicy, &nodeMask, 8*sizeof(nodeMask), 0);
+#endif
+		}
+
+		float* InitializeBlock(char *base, size_t size, NumaPlacement placement, bool mapped) {
+			NumaBlockHeader *header = (NumaBlockHeader*)base;
+			header->Size = size;
+			header->Placement = placement;
+			header->Mapped = mapped;
+			return (float*)(base + HeaderSize);
+		}
+
+		float* AllocateAligned(size_t count) {
+			size_t size = HeaderSize + count*sizeof(float);
+			char *base = (char*)_mm_malloc(size, HeaderSize);
+			return InitializeBlock(base, size, LocalNode, false);
+		}
+
+		NumaBlockHeader* GetHeader(const float *memory) {
+			return (NumaBlockHeader*)((char*)memory - HeaderSize);
+		}
+	}
+
+	int NumaMemory::GetNodesCount(void) {
+		static int nodesCount = DetectNodesCount();
+		return nodesCount;
+	}
+
+	int NumaMemory::GetCurrentNode(void) {
+		if (GetNodesCount() == 1) {
+			return 0;
+		}
+#ifdef _WIN32
+		PROCESSOR_NUMBER processor;
+		USHORT node = 0;
+		GetCurrentProcessorNumberEx(&processor);
+		GetNumaProcessorNodeEx(&processor, &node);
+		return (int)node;
+#else
+		unsigned cpu = 0, node = 0;
+		if (syscall(SYS_getcpu, &cpu, &node, 0) != 0) {
+			return 0;
+		}
+		return (int)node;
+#endif
+	}
+
+	float* NumaMemory::Allocate(int rows, int columns, NumaPlacement placement) {
+		size_t count = (size_t)rows*columns;
+		int nodesCount = GetNodesCount();
+		if ((placement == LocalNode) || (nodesCount == 1)) {
+			return AllocateAligned(count);
+		}
+
+		size_t size = RoundUpToPage(HeaderSize + count*sizeof(float));
+		char *base = MapMemory(size);
+		if (base == 0) {
+			return AllocateAligned(count);
+		}
+
+		if (placement == Interleaved) {
+			InterleaveOverNodes(base, size, nodesCount);
+		}
+		else {
+			size_t rowSize = (size_t)columns*sizeof(float);
+			size_t blockStart = 0;
+			for (int node = 0; node < nodesCount; node++) {
+				size_t lastRow = (size_t)rows*(node + 1)/nodesCount;
+				size_t blockEnd = (node == nodesCount - 1) ? size : (HeaderSize + lastRow*rowSize)/PageSize*PageSize;
+				if (blockEnd > blockStart) {
+					BindToNode(base + blockStart, blockEnd - blockStart, node);
+					blockStart = blockEnd;
+				}
+			}
+		}
+		return InitializeBlock(base, size, placement, true);
+	}
+
+	float* NumaMemory::AllocateOnNode(size_t count, int node) {
+		if (GetNodesCount() == 1) {
+			return AllocateAligned(count);
+		}
+
+		size_t size = RoundUpToPage(HeaderSize + count*sizeof(float));
+		char *base = MapMemory(size);
+		if (base == 0) {
+			return AllocateAligned(count);
+		}
+		BindToNode(base, size, node);
+		return InitializeBlock(base, size, LocalNode, true);
+	}
+
+	void NumaMemory::Free(float *memory) {
+		if (memory == 0) {
+			return;
+		}
+		NumaBlockHeader *header = GetHeader(memory);
+		if (header->Mapped) {
+			UnmapMemory((char*)header, header->Size);
+		}
+		else {
+			_mm_free(header);
+		}
+	}
+
+	NumaPlacement NumaMemory::GetPlacement(const float *memory) {
+		return (NumaPlacement)GetHeader(memory)->Placement;
+	}
+}
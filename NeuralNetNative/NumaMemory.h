@@ -0,0 +1,25 @@
+#pragma once
+
+#include "ExportDll.h"
+#include <cstddef>
+
+namespace NeuralNetNative {
+	enum NumaPlacement {
+		LocalNode,
+		Interleaved,
+		PartitionedByRows
+	};
+
+	// Float buffers placed over NUMA nodes. Interleaved spreads pages round-robin over all nodes,
+	// PartitionedByRows gives node k the k-th contiguous block of rows. With a single node both
+	// fall back to an ordinary aligned allocation. Buffers must be released with NumaMemory::Free.
+	class NEURALNETNATIVE_EXPORT NumaMemory {
+	public:
+		static int GetNodesCount(void);
+		static int GetCurrentNode(void);
+		static float* Allocate(int rows, int columns, NumaPlacement placement);
+		static float* AllocateOnNode(size_t count, int node);
+		static void Free(float *memory);
+		static NumaPlacement GetPlacement(const float *memory);
+	};
+}
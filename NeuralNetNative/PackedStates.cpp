@@ -0,0 +1,104 @@
+#define NEURALNETNATIVEAPI
+
+#include "Platform.h"
+#include "PackedStates.h"
+#include <tbb/tbb.h>
+#include <tbb/parallel_for.h>
+#include <tbb/blocked_range.h>
+#include "ParallelDispatch.h"
+#include <algorithm>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+using namespace tbb;
+
+namespace NeuralNetNative {
+	namespace {
+		const int WordBits = 64;
+
+		inline int CountBits(unsigned long long word) {
+#ifdef _MSC_VER
+			return (int)__popcnt64(word);
+#else
+			return __builtin_popcountll(word);
+#endif
+		}
+	}
+
+	PackedStates::PackedStates(int rowsCount, int columnsCount) {
+		_rowsCount = rowsCount;
+		_columnsCount = columnsCount;
+		_wordsPerRow = (columnsCount + WordBits - 1)/WordBits;
+		_words = (unsigned long long*)_mm_malloc((size_t)rowsCount*_wordsPerRow*sizeof(unsigned long long), 32);
+		std::fill(_words, _words + (size_t)rowsCount*_wordsPerRow, 0ull);
+	}
+
+	PackedStates::~PackedStates(void) {
+		_mm_free(_words);
+	}
+
+	void PackedStates::Pack(const float *states, int rowsCount) {
+		DispatchFor(rowsCount, _columnsCount, sizeof(float),
+		[=](const blocked_range<size_t>& r)
+		{
+			for (int row = r.begin(); row < r.end(); row++) {
+				const float *rowStates = states + (size_t)row*_columnsCount;
+				unsigned long long *rowWords = _words + (size_t)row*_wordsPerRow;
+				for (int w = 0; w < _wordsPerRow; w++) {
+					int first = w*WordBits;
+					int count = std::min(WordBits, _columnsCount - first);
+					unsigned long long word = 0;
+					for (int l = 0; l < count; l++) {
+						word |= (unsigned long long)(rowStates[first + l] > 0.5f) << l;
+					}
+					rowWords[w] = word;
+				}
+			}
+		});
+	}
+
+	void PackedStates::Unpack(float *states, int rowsCount) const {
+		DispatchFor(rowsCount, _columnsCount, sizeof(float),
+		[=](const blocked_range<size_t>& r)
+		{
+			for (int row = r.begin(); row < r.end(); row++) {
+				float *rowStates = states + (size_t)row*_columnsCount;
+				const unsigned long long *rowWords = _words + (size_t)row*_wordsPerRow;
+				for (int i = 0; i < _columnsCount; i++) {
+					rowStates[i] = (float)((rowWords[i/WordBits] >> (i%WordBits)) & 1);
+				}
+			}
+		});
+	}
+
+	int PackedStates::CountDifferences(int row, const PackedStates &other, int otherRow) const {
+		const unsigned long long *rowWords = _words + (size_t)row*_wordsPerRow;
+		const unsigned long long *otherWords = other._words + (size_t)otherRow*other._wordsPerRow;
+		int count = 0;
+		for (int w = 0; w < _wordsPerRow; w++) {
+			count += CountBits(rowWords[w] ^ otherWords[w]);
+		}
+		return count;
+	}
+
+	int PackedStates::GetRowsCount(void) const {
+		return _rowsCount;
+	}
+
+	int PackedStates::GetColumnsCount(void) const {
+		return _columnsCount;
+	}
+
+	int PackedStates::GetWordsPerRow(void) const {
+		return _wordsPerRow;
+	}
+
+	unsigned long long* PackedStates::GetWords(void) {
+		return _words;
+	}
+
+	const unsigned long long* PackedStates::GetWords(void) const {
+		return _words;
+	}
+}
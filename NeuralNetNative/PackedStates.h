@@ -0,0 +1,28 @@
+#pragma once
+
+#include "ExportDll.h"
+
+namespace NeuralNetNative {
+	// Rows of binary states kept one bit per state. Every row starts at a 64-bit word and its unused
+	// tail bits stay zero, so rows can be compared and scanned word by word.
+	class NEURALNETNATIVE_EXPORT PackedStates {
+	private:
+		int _rowsCount;
+		int _columnsCount;
+		int _wordsPerRow;
+		unsigned long long *_words;
+	public:
+		PackedStates(int rowsCount, int columnsCount);
+		~PackedStates(void);
+		// Sets the bits of the states above one half in rowsCount rows of states.
+		void Pack(const float *states, int rowsCount);
+		void Unpack(float *states, int rowsCount) const;
+		// The number of states in which the row differs from otherRow of other.
+		int CountDifferences(int row, const PackedStates &other, int otherRow) const;
+		int GetRowsCount(void) const;
+		int GetColumnsCount(void) const;
+		int GetWordsPerRow(void) const;
+		unsigned long long* GetWords(void);
+		const unsigned long long* GetWords(void) const;
+	};
+}
@@ -0,0 +1,182 @@
+#define NEURALNETNATIVEAPI
+#include "ParallelDispatch.h"
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <algorithm>
+
+using namespace tbb;
+
+namespace NeuralNetNative {
+	namespace {
+		const char *ThresholdsFileVariable = "NNETS_DISPATCH_THRESHOLDS";
+
+		bool ReadThresholds(const char *fileName, DispatchThresholds &thresholds) {
+			FILE *file = fopen(fileName, "r");
+			if (file == 0) {
+				return false;
+			}
+			char name[64];
+			float value;
+			int readCount = 0;
+			while (fscanf(file, " %63[^=]=%f", name, &value) == 2) {
+				readCount++;
+				if (strcmp(name, "NsPerElement") == 0) thresholds.NsPerElement = value;
+				else if (strcmp(name, "NsPerByte") == 0) thresholds.NsPerByte = value;
+				else if (strcmp(name, "LaunchNs") == 0) thresholds.LaunchNs = value;
+				else if (strcmp(name, "TaskNs") == 0) thresholds.TaskNs = value;
+				else if (strcmp(name, "TaskGranularity") == 0) thresholds.TaskGranularity = value;
+				else readCount--;
+			}
+			fclose(file);
+			return (readCount > 0);
+		}
+
+		DispatchThresholds LoadInitialThresholds(void) {
+			DispatchThresholds thresholds = ParallelDispatch::GetDefaultThresholds();
+			const char *fileName = getenv(ThresholdsFileVariable);
+			if (fileName != 0) {
+				ReadThresholds(fileName, thresholds);
+			}
+			return thresholds;
+		}
+
+		double ElapsedNs(std::chrono::high_resolution_clock::time_point start) {
+			return (double)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::high_resolution_clock::now() - start).count();
+		}
+
+		float MeasureNsPerElement(void) {
+			const int length = 4096;
+			const int repeats = 4000;
+			float *a = new float[length];
+			float *b = new float[length];
+			for (int i = 0; i < length; i++) {
+				a[i] = 1.0f/(i + 1);
+				b[i] = 1.0f - a[i];
+			}
+			volatile float sink = 0.0f;
+			auto start = std::chrono::high_resolution_clock::now();
+			for (int k = 0; k < repeats; k++) {
+				float sum = 0.0f;
+				for (int i = 0; i < length; i++) {
+					sum += a[i]*b[i];
+				}
+				sink = sink + sum;
+			}
+			double ns = ElapsedNs(start);
+			delete[] a;
+			delete[] b;
+			return (float)(ns/((double)length*repeats));
+		}
+
+		float MeasureNsPerByte(void) {
+			const int length = 16*1024*1024;
+			const int repeats = 3;
+			float *x = new float[length];
+			std::fill(x, x + length, 1.0f);
+			double bestNs = 0.0;
+			for (int k = 0; k < repeats; k++) {
+				auto start = std::chrono::high_resolution_clock::now();
+				for (int i = 0; i < length; i++) {
+					x[i] = 0.5f*x[i] + 0.5f;
+				}
+				double ns = ElapsedNs(start);
+				if (k == 0 || ns < bestNs) {
+					bestNs = ns;
+				}
+			}
+			volatile float sink = x[length/2];
+			(void)sink;
+			delete[] x;
+			return (float)(bestNs/(2.0*sizeof(float)*length));
+		}
+
+		double MeasureEmptyParallelFor(int count, int repeats) {
+			auto start = std::chrono::high_resolution_clock::now();
+			for (int k = 0; k < repeats; k++) {
+				parallel_for(blocked_range<size_t>(0, count, 1), [](const blocked_range<size_t>& r) {}, simple_partitioner());
+			}
+			return ElapsedNs(start)/repeats;
+		}
+	}
+
+	DispatchThresholds ParallelDispatch::_thresholds = LoadInitialThresholds();
+
+	DispatchThresholds ParallelDispatch::GetDefaultThresholds(void) {
+		DispatchThresholds thresholds;
+		thresholds.NsPerElement = 0.5f;
+		thresholds.NsPerByte = 0.1f;
+		thresholds.LaunchNs = 5000.0f;
+		thresholds.TaskNs = 300.0f;
+		thresholds.TaskGranularity = 10.0f;
+		return thresholds;
+	}
+
+	const DispatchThresholds& ParallelDispatch::GetThresholds(void) {
+		return _thresholds;
+	}
+
+	void ParallelDispatch::SetThresholds(const DispatchThresholds &thresholds) {
+		_thresholds = thresholds;
+	}
+
+	bool ParallelDispatch::LoadThresholds(const char *fileName) {
+		DispatchThresholds thresholds = GetDefaultThresholds();
+		if (!ReadThresholds(fileName, thresholds)) {
+			return false;
+		}
+		_thresholds = thresholds;
+		return true;
+	}
+
+	bool ParallelDispatch::SaveThresholds(const char *fileName) {
+		FILE *file = fopen(fileName, "w");
+		if (file == 0) {
+			return false;
+		}
+		fprintf(file, "NsPerElement=%g\n", _thresholds.NsPerElement);
+		fprintf(file, "NsPerByte=%g\n", _thresholds.NsPerByte);
+		fprintf(file, "LaunchNs=%g\n", _thresholds.LaunchNs);
+		fprintf(file, "TaskNs=%g\n", _thresholds.TaskNs);
+		fprintf(file, "TaskGranularity=%g\n", _thresholds.TaskGranularity);
+		fclose(file);
+		return true;
+	}
+
+	DispatchThresholds ParallelDispatch::Calibrate(void) {
+		DispatchThresholds thresholds = GetDefaultThresholds();
+		thresholds.NsPerElement = MeasureNsPerElement();
+		thresholds.NsPerByte = MeasureNsPerByte();
+
+		int concurrency = this_task_arena::max_concurrency();
+		const int tasksPerThread = 256;
+		const int repeats = 1000;
+		MeasureEmptyParallelFor(concurrency, repeats/10);
+		double launchNs = MeasureEmptyParallelFor(concurrency, repeats);
+		double manyTasksNs = MeasureEmptyParallelFor(concurrency*tasksPerThread, repeats/10);
+		thresholds.LaunchNs = (float)launchNs;
+		thresholds.TaskNs = (float)std::max(0.0, manyTasksNs - launchNs)/(tasksPerThread - 1);
+
+		_thresholds = thresholds;
+		return thresholds;
+	}
+
+	int ParallelDispatch::GetGrainSize(int rows, int columns, size_t bytesPerElement) {
+		int concurrency = this_task_arena::max_concurrency();
+		if ((rows <= 1) || (concurrency <= 1)) {
+			return std::max(rows, 1);
+		}
+
+		double rowNs = std::max(columns, 1)*(_thresholds.NsPerElement + bytesPerElement*_thresholds.NsPerByte);
+		double serialNs = rowNs*rows;
+		if (serialNs*(concurrency - 1) <= _thresholds.LaunchNs*concurrency) {
+			return rows;
+		}
+
+		int grainSize = (int)ceil(_thresholds.TaskGranularity*_thresholds.TaskNs/rowNs);
+		int maxGrainSize = (rows + concurrency - 1)/concurrency;
+		return std::min(std::max(grainSize, 1), maxGrainSize);
+	}
+}
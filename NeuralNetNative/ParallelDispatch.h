@@ -0,0 +1,57 @@
+#pragma once
+
+#include "ExportDll.h"
+#include <tbb/tbb.h>
+#include <tbb/task_arena.h>
+#include <tbb/parallel_for.h>
+#include <tbb/parallel_reduce.h>
+#include <tbb/blocked_range.h>
+
+namespace NeuralNetNative {
+	// Machine costs used to decide whether a loop is worth splitting into TBB tasks.
+	// Work of a call is estimated as rows*columns elements, each costing one multiply-add
+	// plus bytesPerElement bytes of memory traffic.
+	struct DispatchThresholds {
+	public:
+		float NsPerElement;
+		float NsPerByte;
+		float LaunchNs;
+		float TaskNs;
+		float TaskGranularity;
+	};
+
+	// Thresholds start from the file named by NNETS_DISPATCH_THRESHOLDS, if set. Calibrate() measures
+	// them on the current machine and SaveThresholds() stores the result for later runs.
+	class NEURALNETNATIVE_EXPORT ParallelDispatch {
+	private:
+		static DispatchThresholds _thresholds;
+	public:
+		static DispatchThresholds GetDefaultThresholds(void);
+		static const DispatchThresholds& GetThresholds(void);
+		static void SetThresholds(const DispatchThresholds &thresholds);
+		static bool LoadThresholds(const char *fileName);
+		static bool SaveThresholds(const char *fileName);
+		static DispatchThresholds Calibrate(void);
+		static int GetGrainSize(int rows, int columns, size_t bytesPerElement);
+	};
+
+	template<typename Body>
+	inline void DispatchFor(int rows, int columns, size_t bytesPerElement, const Body &body) {
+		int grainSize = ParallelDispatch::GetGrainSize(rows, columns, bytesPerElement);
+		if (grainSize >= rows) {
+			body(tbb::blocked_range<size_t>(0, rows));
+		}
+		else {
+			tbb::parallel_for(tbb::blocked_range<size_t>(0, rows, grainSize), body);
+		}
+	}
+
+	template<typename Value, typename Body, typename Join>
+	inline Value DispatchReduce(int rows, int columns, size_t bytesPerElement, const Value &identity, const Body &body, const Join &join) {
+		int grainSize = ParallelDispatch::GetGrainSize(rows, columns, bytesPerElement);
+		if (grainSize >= rows) {
+			return body(tbb::blocked_range<size_t>(0, rows), identity);
+		}
+		return tbb::parallel_reduce(tbb::blocked_range<size_t>(0, rows, grainSize), identity, body, join);
+	}
+}
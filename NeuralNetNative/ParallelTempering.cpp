@@ -0,0 +1,250 @@
+#define NEURALNETNATIVEAPI
+
+#include "Platform.h"
+#include "ParallelTempering.h"
+#include <tbb/tbb.h>
+#include <tbb/parallel_for.h>
+#include <tbb/blocked_range.h>
+#include "ParallelDispatch.h"
+#include <algorithm>
+
+using namespace tbb;
+
+namespace NeuralNetNative {
+	namespace RestrictedBoltzmannMachine {
+		ParallelTempering::
+            ParallelTempering(StandardTypesNative::TrainSingle **trainData,
+                              int trainDataSize,
+                              GradientFunction *gradientFunction,
+                              int temperaturesCount)
+            : RbmTrainMethod(trainData, trainDataSize, gradientFunction) {
+			_temperaturesCount = std::max(temperaturesCount, 1);
+			_chainsCount = 0;
+			_visibleStates = 0;
+		}
+
+		ParallelTempering::
+            ParallelTempering(StandardTypesNative::TrainSingle **trainData,
+                              StandardTypesNative::TrainSingle **testData,
+                              int trainDataSize, int testDataSize,
+                              GradientFunction *gradientFunction,
+                              int temperaturesCount)
+            : RbmTrainMethod(trainData, testData, trainDataSize, testDataSize, gradientFunction) {
+			_temperaturesCount = std::max(temperaturesCount, 1);
+			_chainsCount = 0;
+			_visibleStates = 0;
+		}
+
+		ParallelTempering::~ParallelTempering(void) {
+			DeleteTemporaryData();
+		}
+
+		void ParallelTempering::CreateTemporaryData(void) {
+			int weightsCount = visibleStatesCount*hiddenStatesCount;
+			_oldDeltaWeights = (float*)_mm_malloc(weightsCount*sizeof(float), 32);
+			_oldDeltaWeightsForVisibleBias = (float*)_mm_malloc(visibleStatesCount*sizeof(float), 32);
+			_oldDeltaWeightsForHiddenBias = (float*)_mm_malloc(hiddenStatesCount*sizeof(float), 32);
+			std::fill(_oldDeltaWeights, _oldDeltaWeights + weightsCount, 0.0f);
+			std::fill(_oldDeltaWeightsForVisibleBias, _oldDeltaWeightsForVisibleBias + visibleStatesCount, 0.0f);
+			std::fill(_oldDeltaWeightsForHiddenBias, _oldDeltaWeightsForHiddenBias + hiddenStatesCount, 0.0f);
+
+			if (properties->BatchTraining) {
+				_chainsCount = (properties->PersistentChainsCount > 0) ? properties->PersistentChainsCount : properties->PackageSize;
+			}
+			else {
+				_chainsCount = 1;
+			}
+			size_t rowsCount = (size_t)_temperaturesCount*_chainsCount;
+			_visibleStates = (float*)_mm_malloc(rowsCount*visibleStatesCount*sizeof(float), 32);
+			_hiddenStates = (float*)_mm_malloc(rowsCount*hiddenStatesCount*sizeof(float), 32);
+			_inverseTemperatures = (float*)_mm_malloc(rowsCount*sizeof(float), 32);
+			_temperatureRows = (int*)_mm_malloc(rowsCount*sizeof(int), 32);
+			_energies = (float*)_mm_malloc(rowsCount*sizeof(float), 32);
+			_uniforms = (float*)_mm_malloc(rowsCount*sizeof(float), 32);
+			_negativeVisibleStates = (float*)_mm_malloc((size_t)_chainsCount*visibleStatesCount*sizeof(float), 32);
+			_negativeHiddenStates = (float*)_mm_malloc((size_t)_chainsCount*hiddenStatesCount*sizeof(float), 32);
+
+			std::fill(_visibleStates, _visibleStates + rowsCount*visibleStatesCount, 0.0f);
+			for (int t = 0; t < _temperaturesCount; t++) {
+				float inverseTemperature = 1.0f - (float)t/_temperaturesCount;
+				for (int c = 0; c < _chainsCount; c++) {
+					int row = t*_chainsCount + c;
+					_inverseTemperatures[row] = inverseTemperature;
+					_temperatureRows[row] = row;
+				}
+			}
+			_swapParity = 0;
+		}
+
+		void ParallelTempering::DeleteTemporaryData(void) {
+			if (_visibleStates != 0) {
+				_mm_free(_visibleStates);
+				_mm_free(_hiddenStates);
+				_mm_free(_inverseTemperatures);
+				_mm_free(_temperatureRows);
+				_mm_free(_energies);
+				_mm_free(_uniforms);
+				_mm_free(_negativeVisibleStates);
+				_mm_free(_negativeHiddenStates);
+				_mm_free(_oldDeltaWeights);
+				_mm_free(_oldDeltaWeightsForVisibleBias);
+				_mm_free(_oldDeltaWeightsForHiddenBias);
+				_visibleStates = 0;
+			}
+		}
+
+        void ParallelTempering::AdvanceLadder(void) {
+            int rowsCount = _temperaturesCount*_chainsCount;
+            neuralNet->HiddenLayerCalculateActivity(_visibleStates, _hiddenStates, rowsCount, _inverseTemperatures);
+            neuralNet->HiddenLayerSampling(_hiddenStates, rowsCount);
+            neuralNet->VisibleLayerCalculateActivity(_hiddenStates, _visibleStates, rowsCount, _inverseTemperatures);
+            neuralNet->VisibleLayerSampling(_visibleStates, rowsCount);
+            if (_temperaturesCount > 1) {
+                neuralNet->CalculateEnergies(_visibleStates, _hiddenStates, _energies, rowsCount);
+                SwapTemperatures();
+            }
+        }
+
+        void ParallelTempering::SwapTemperatures(void) {
+            // Pairs (t, t + 1) with t of the current parity are independent, so every chain of every
+            // pair is decided at once. A swap exchanges the temperatures of two rows, not their states.
+            int firstTemperature = _swapParity;
+            int pairsCount = (_temperaturesCount - firstTemperature)/2;
+            _swapParity = 1 - _swapParity;
+            if (pairsCount == 0) {
+                return;
+            }
+            int proposalsCount = pairsCount*_chainsCount;
+            neuralNet->GetRandom()->FillUniform(_uniforms, proposalsCount);
+            for (int p = 0; p < pairsCount; p++) {
+                int *lowRows = _temperatureRows + (size_t)(firstTemperature + 2*p)*_chainsCount;
+                int *highRows = lowRows + _chainsCount;
+                const float *uniforms = _uniforms + (size_t)p*_chainsCount;
+                for (int c = 0; c < _chainsCount; c++) {
+                    int lowRow = lowRows[c];
+                    int highRow = highRows[c];
+                    float lowInverseTemperature = _inverseTemperatures[lowRow];
+                    float highInverseTemperature = _inverseTemperatures[highRow];
+                    float logAcceptance = (lowInverseTemperature - highInverseTemperature)*(_energies[lowRow] - _energies[highRow]);
+                    bool accepted = uniforms[c] < expf(logAcceptance);
+                    lowRows[c] = accepted ? highRow : lowRow;
+                    highRows[c] = accepted ? lowRow : highRow;
+                    _inverseTemperatures[lowRow] = accepted ? highInverseTemperature : lowInverseTemperature;
+                    _inverseTemperatures[highRow] = accepted ? lowInverseTemperature : highInverseTemperature;
+                }
+            }
+        }
+
+        void ParallelTempering::GatherNegativeVisibleStates(void) {
+            for (int c = 0; c < _chainsCount; c++) {
+                const float *row = _visibleStates + (size_t)_temperatureRows[c]*visibleStatesCount;
+                std::copy(row, row + visibleStatesCount, _negativeVisibleStates + (size_t)c*visibleStatesCount);
+            }
+        }
+
+        void ParallelTempering::MakePositivePhase(float *input) {
+            neuralNet->HiddenLayerCalculateActivity(input);
+        }
+
+        void ParallelTempering::MakeNegativePhase(int packageId) {
+            AdvanceLadder();
+            GatherNegativeVisibleStates();
+            neuralNet->HiddenLayerCalculateActivity(_negativeVisibleStates);
+        }
+
+        float* ParallelTempering::GetVisibleStatesOnNegativePhase(int packageId) {
+            return _negativeVisibleStates;
+        }
+
+        float* ParallelTempering::GetHiddenStatesOnNegativePhase(void) {
+            return neuralNet->GetHiddenStates();
+        }
+
+        void ParallelTempering::RestoreVisibleStates(int packageId) {
+        }
+
+        int ParallelTempering::NegativePhaseLayerPassesCount(void) const {
+            // Hidden, visible and energy passes over the whole ladder, and the hidden pass of the
+            // chains at temperature 1.
+            return 3*_temperaturesCount + 1;
+        }
+
+        bool ParallelTempering::SupportsBatchTraining(void) const {
+            return true;
+        }
+
+        void ParallelTempering::MakeBatchNegativePhase(float *visibleStatesBatch, float *hiddenStatesBatch, int batchSize) {
+            AdvanceLadder();
+            GatherNegativeVisibleStates();
+            neuralNet->HiddenLayerCalculateActivity(_negativeVisibleStates, _negativeHiddenStates, _chainsCount);
+        }
+
+        int ParallelTempering::GetBatchNegativePhaseSize(void) const {
+            return _chainsCount;
+        }
+
+        float* ParallelTempering::GetVisibleStatesOnBatchNegativePhase(void) {
+            return _negativeVisibleStates;
+        }
+
+        float* ParallelTempering::GetHiddenStatesOnBatchNegativePhase(void) {
+            return _negativeHiddenStates;
+        }
+
+        void ParallelTempering::ModifyWeightsOfNeuronNet() {
+			float curLearnSpeed = properties->BaseLearnSpeed*properties->FactorStrategy->GetFactor(epochNumber);
+
+			float *weights = neuralNet->GetWeights();
+            float *packageDerivativeForWeights = gradients->GetPackageDerivativeForWeights();
+			DispatchFor(hiddenStatesCount, visibleStatesCount, 10*sizeof(float),
+			[=](const blocked_range<size_t>& r)
+			{
+				for (int j = r.begin(); j < r.end(); j++) {
+					for (int i = 0; i < visibleStatesCount; i++) {
+						int weightIndex = j*visibleStatesCount + i;
+
+						float partialDerivative = packageDerivativeForWeights[weightIndex];
+						packageDerivativeForWeights[weightIndex] = 0.0f;
+
+						float newDeltaWeight = properties->Momentum*_oldDeltaWeights[weightIndex] +
+						    curLearnSpeed*(partialDerivative - properties->Regularization->GetDerivative(weights[weightIndex]));
+						_oldDeltaWeights[weightIndex] = newDeltaWeight;
+						weights[weightIndex] += (1.0f + properties->Momentum)*newDeltaWeight;
+					}
+				}
+			});
+
+			float *visibleStatesBias = neuralNet->GetVisibleStatesBias();
+            float *packageDerivativeForVisibleBias = gradients->GetPackageDerivativeForVisibleBias();
+			DispatchFor(visibleStatesCount, 1, 10*sizeof(float),
+			[=](const blocked_range<size_t>& r)
+			{
+				for (int i = r.begin(); i < r.end(); i++) {
+					float partialDerivativeForVisibleBias = packageDerivativeForVisibleBias[i];
+					packageDerivativeForVisibleBias[i] = 0.0f;
+
+					float newDeltaForVisibleBias = curLearnSpeed*partialDerivativeForVisibleBias +
+					                               properties->Momentum*_oldDeltaWeightsForVisibleBias[i];
+					_oldDeltaWeightsForVisibleBias[i] = newDeltaForVisibleBias;
+					visibleStatesBias[i] += (1.0f + properties->Momentum)*newDeltaForVisibleBias;
+				}
+			});
+
+			float *hiddenStatesBias = neuralNet->GetHiddenStatesBias();
+            float *packageDerivativeForHiddenBias = gradients->GetPackageDerivativeForHiddenBias();
+			DispatchFor(hiddenStatesCount, 1, 10*sizeof(float),
+			[=](const blocked_range<size_t>& r)
+			{
+				for (int j = r.begin(); j < r.end(); j++) {
+					float partialDerivativeForHiddenBias = packageDerivativeForHiddenBias[j];
+					packageDerivativeForHiddenBias[j] = 0.0f;
+
+					float newDeltaForHiddenBias = curLearnSpeed*partialDerivativeForHiddenBias +
+					                              properties->Momentum*_oldDeltaWeightsForHiddenBias[j];
+					_oldDeltaWeightsForHiddenBias[j] = newDeltaForHiddenBias;
+					hiddenStatesBias[j] += (1.0f + properties->Momentum)*newDeltaForHiddenBias;
+				}
+			});
+		}
+	}
+}
@@ -0,0 +1,63 @@
+#pragma once
+
+#include "ExportDll.h"
+#include "RbmTrainMethod.h"
+#include "TrainProperties.h"
+#include "RandomAccessIterator.h"
+#include "TrainSingle.h"
+#include "RestrictedBoltzmannMachine.h"
+
+namespace NeuralNetNative {
+	namespace RestrictedBoltzmannMachine {
+		// Negative phase from a ladder of persistent chains at inverse temperatures 1, 1 - 1/T, ..., 1/T.
+		// All T*C chains are one state matrix advanced by batched passes; after every update adjacent
+		// temperatures propose to exchange their states and the chains at temperature 1 feed the gradient.
+		class NEURALNETNATIVE_EXPORT ParallelTempering : public RbmTrainMethod {
+		private:
+			int _temperaturesCount;
+			int _chainsCount;
+			int _swapParity;
+			float *_visibleStates;
+			float *_hiddenStates;
+			float *_inverseTemperatures;
+			int *_temperatureRows;
+			float *_energies;
+			float *_uniforms;
+			float *_negativeVisibleStates;
+			float *_negativeHiddenStates;
+			float *_oldDeltaWeights;
+			float *_oldDeltaWeightsForVisibleBias;
+			float *_oldDeltaWeightsForHiddenBias;
+		public:
+			ParallelTempering(StandardTypesNative::TrainSingle **trainData,
+                              int trainDataSize,
+                              GradientFunction *gradientFunction,
+                              int temperaturesCount);
+			ParallelTempering(StandardTypesNative::TrainSingle **trainData,
+                              StandardTypesNative::TrainSingle **testData,
+                              int trainDataSize, int testDataSize,
+                              GradientFunction *gradientFunction,
+                              int temperaturesCount);
+			virtual ~ParallelTempering(void);
+        protected:
+            virtual void CreateTemporaryData(void);
+			virtual void DeleteTemporaryData(void);
+            virtual void MakePositivePhase(float *input);
+		    virtual void MakeNegativePhase(int packageId);
+		    virtual float* GetVisibleStatesOnNegativePhase(int packageId);
+		    virtual float* GetHiddenStatesOnNegativePhase(void);
+		    virtual void RestoreVisibleStates(int packageId);
+            virtual void ModifyWeightsOfNeuronNet();
+            virtual int NegativePhaseLayerPassesCount(void) const;
+            virtual bool SupportsBatchTraining(void) const;
+            virtual void MakeBatchNegativePhase(float *visibleStatesBatch, float *hiddenStatesBatch, int batchSize);
+            virtual int GetBatchNegativePhaseSize(void) const;
+            virtual float* GetVisibleStatesOnBatchNegativePhase(void);
+            virtual float* GetHiddenStatesOnBatchNegativePhase(void);
+        private:
+            void AdvanceLadder(void);
+            void SwapTemperatures(void);
+            void GatherNegativeVisibleStates(void);
+		};
+	}
+}
@@ -0,0 +1,49 @@
+#define NEURALNETNATIVEAPI
+
+#include "Platform.h"
+#include "PersistentChainPool.h"
+#include <algorithm>
+
+namespace NeuralNetNative {
+	namespace RestrictedBoltzmannMachine {
+		PersistentChainPool::PersistentChainPool(int chainsCount, int visibleStatesCount, int hiddenStatesCount) {
+			_chainsCount = chainsCount;
+			_visibleStatesCount = visibleStatesCount;
+			_hiddenStatesCount = hiddenStatesCount;
+			_visibleStates = (float*)_mm_malloc((size_t)chainsCount*visibleStatesCount*sizeof(float), 32);
+			_hiddenStates = (float*)_mm_malloc((size_t)chainsCount*hiddenStatesCount*sizeof(float), 32);
+			Reset();
+		}
+
+		PersistentChainPool::~PersistentChainPool(void) {
+			_mm_free(_visibleStates);
+			_mm_free(_hiddenStates);
+		}
+
+		void PersistentChainPool::Reset(void) {
+			std::fill(_visibleStates, _visibleStates + (size_t)_chainsCount*_visibleStatesCount, 0.0f);
+			std::fill(_hiddenStates, _hiddenStates + (size_t)_chainsCount*_hiddenStatesCount, 0.0f);
+		}
+
+		void PersistentChainPool::CalculateHiddenActivity(RestrictedBoltzmannMachineBase *neuralNet, const RbmParameters &parameters) {
+			neuralNet->HiddenLayerCalculateActivity(_visibleStates, _hiddenStates, _chainsCount, parameters);
+		}
+
+		void PersistentChainPool::SampleVisibleStates(RestrictedBoltzmannMachineBase *neuralNet, const RbmParameters &parameters) {
+			neuralNet->HiddenLayerSampling(_hiddenStates, _chainsCount);
+			neuralNet->VisibleLayerCalculateActivity(_hiddenStates, _visibleStates, _chainsCount, parameters);
+		}
+
+		int PersistentChainPool::GetChainsCount(void) const {
+			return _chainsCount;
+		}
+
+		float* PersistentChainPool::GetVisibleStates(void) {
+			return _visibleStates;
+		}
+
+		float* PersistentChainPool::GetHiddenStates(void) {
+			return _hiddenStates;
+		}
+	}
+}
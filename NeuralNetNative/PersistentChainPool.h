@@ -0,0 +1,30 @@
+#pragma once
+
+#include "ExportDll.h"
+#include "RestrictedBoltzmannMachine.h"
+
+namespace NeuralNetNative {
+	namespace RestrictedBoltzmannMachine {
+		// Fantasy particles of persistent training methods, one row per chain. All chains are advanced
+		// together with batched layer passes, so their number does not depend on the package count.
+		class NEURALNETNATIVE_EXPORT PersistentChainPool {
+		private:
+			int _chainsCount;
+			int _visibleStatesCount;
+			int _hiddenStatesCount;
+			float *_visibleStates;
+			float *_hiddenStates;
+		public:
+			PersistentChainPool(int chainsCount, int visibleStatesCount, int hiddenStatesCount);
+			~PersistentChainPool(void);
+			void Reset(void);
+			// Hidden probabilities of the current visible states.
+			void CalculateHiddenActivity(RestrictedBoltzmannMachineBase *neuralNet, const RbmParameters &parameters);
+			// Samples the hidden states and replaces the visible states by their reconstruction.
+			void SampleVisibleStates(RestrictedBoltzmannMachineBase *neuralNet, const RbmParameters &parameters);
+			int GetChainsCount(void) const;
+			float* GetVisibleStates(void);
+			float* GetHiddenStates(void);
+		};
+	}
+}
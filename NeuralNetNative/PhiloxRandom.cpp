@@ -0,0 +1,288 @@
+#define NEURALNETNATIVEAPI
+
+#include "Platform.h"
+#include "PhiloxRandom.h"
+#include <tbb/tbb.h>
+#include <tbb/parallel_for.h>
+#include <tbb/blocked_range.h>
+#include "ParallelDispatch.h"
+#include <algorithm>
+#include <cstring>
+
+using namespace tbb;
+
+namespace NeuralNetNative {
+	namespace {
+		const unsigned int PhiloxM0 = 0xD2511F53u;
+		const unsigned int PhiloxM1 = 0xCD9E8D57u;
+		const unsigned int PhiloxW0 = 0x9E3779B9u;
+		const unsigned int PhiloxW1 = 0xBB67AE85u;
+		const int PhiloxRounds = 10;
+		const int ChunkSize = 1024;
+		const int WordBits = 64;
+		const int GenerationCost = 8;
+		const float UniformScale = 1.0f/16777216.0f;
+		const float TwoPi = 6.28318530718f;
+		const float SqrtHalf = 0.707106781186547524f;
+
+		// bits[4*b + lane] = lane of Philox4x32-10(counter = firstBlock + b, stream). Blocks are
+		// independent, so the loop vectorizes over b.
+		inline void GenerateBlocks(const unsigned int *key, unsigned long long stream, unsigned long long firstBlock,
+		                           int blocksCount, unsigned int *bits) {
+			unsigned int streamLow = (unsigned int)stream;
+			unsigned int streamHigh = (unsigned int)(stream >> 32);
+			for (int b = 0; b < blocksCount; b++) {
+				unsigned long long counter = firstBlock + b;
+				unsigned int c0 = (unsigned int)counter;
+				unsigned int c1 = (unsigned int)(counter >> 32);
+				unsigned int c2 = streamLow;
+				unsigned int c3 = streamHigh;
+				unsigned int k0 = key[0];
+				unsigned int k1 = key[1];
+				for (int round = 0; round < PhiloxRounds; round++) {
+					unsigned long long product0 = (unsigned long long)PhiloxM0*c0;
+					unsigned long long product1 = (unsigned long long)PhiloxM1*c2;
+					c0 = (unsigned int)(product1 >> 32) ^ c1 ^ k0;
+					c1 = (unsigned int)product1;
+					c2 = (unsigned int)(product0 >> 32) ^ c3 ^ k1;
+					c3 = (unsigned int)product0;
+					k0 += PhiloxW0;
+					k1 += PhiloxW1;
+				}
+				bits[4*b] = c0;
+				bits[4*b + 1] = c1;
+				bits[4*b + 2] = c2;
+				bits[4*b + 3] = c3;
+			}
+		}
+
+		inline float ToUniform(unsigned int bits) {
+			return (bits >> 8)*UniformScale;
+		}
+
+		// Natural logarithm of a positive normal float (Cephes logf), written without calls so that
+		// the Box-Muller loop vectorizes.
+		inline float Log(float value) {
+			unsigned int bits;
+			memcpy(&bits, &value, sizeof(bits));
+			int exponent = (int)((bits >> 23) & 0xff) - 126;
+			bits = (bits & 0x807fffffu) | 0x3f000000u;
+			float x;
+			memcpy(&x, &bits, sizeof(x));
+			if (x < SqrtHalf) {
+				exponent -= 1;
+				x = x + x - 1.0f;
+			}
+			else {
+				x = x - 1.0f;
+			}
+			float e = (float)exponent;
+			float z = x*x;
+			float y = 7.0376836292e-2f;
+			y = y*x - 1.1514610310e-1f;
+			y = y*x + 1.1676998740e-1f;
+			y = y*x - 1.2420140846e-1f;
+			y = y*x + 1.4249322787e-1f;
+			y = y*x - 1.6668057665e-1f;
+			y = y*x + 2.0000714765e-1f;
+			y = y*x - 2.4999993993e-1f;
+			y = y*x + 3.3333331174e-1f;
+			y = y*x*z - 2.12194440e-4f*e - 0.5f*z;
+			return x + y + 0.693359375f*e;
+		}
+
+		// Exponent of a float (Cephes expf) with the argument clamped to the normal range, written
+		// without calls so that the noisy rectifier loop vectorizes.
+		inline float Exp(float value) {
+			float x = std::min(std::max(value, -87.0f), 87.0f);
+			float scaled = x*1.44269504088896341f + 0.5f;
+			int exponent = (int)scaled;
+			exponent -= (exponent > scaled) ? 1 : 0;
+			float e = (float)exponent;
+			x = x - 0.693359375f*e + 2.12194440e-4f*e;
+			float z = x*x;
+			float y = 1.9875691500e-4f;
+			y = y*x + 1.3981999507e-3f;
+			y = y*x + 8.3334519073e-3f;
+			y = y*x + 4.1665795894e-2f;
+			y = y*x + 1.6666665459e-1f;
+			y = y*x + 5.0000001201e-1f;
+			y = y*z + x + 1.0f;
+			unsigned int bits = (unsigned int)(exponent + 127) << 23;
+			float power;
+			memcpy(&power, &bits, sizeof(power));
+			return y*power;
+		}
+
+		// Cosine and sine of TwoPi*turns for turns in [0, 1): the angle is reduced to a quarter turn
+		// and rotated back by the quadrant.
+		inline void SinCos(float turns, float &cosine, float &sine) {
+			int q = (int)(4.0f*turns + 0.5f);
+			float x = TwoPi*(turns - 0.25f*q);
+			float z = x*x;
+			float s = x + x*z*((-1.9515295891e-4f*z + 8.3321608736e-3f)*z - 1.6666654611e-1f);
+			float c = 1.0f - 0.5f*z + z*z*((2.443315711809948e-5f*z - 1.388731625493765e-3f)*z + 4.166664568298827e-2f);
+			bool swap = (q & 1) != 0;
+			cosine = (float)(1 - ((q + 1) & 2))*(swap ? s : c);
+			sine = (float)(1 - (q & 2))*(swap ? c : s);
+		}
+
+		// Calls body(first, count, bits) for consecutive chunks of the values, in parallel. Value n
+		// always takes lane n%4 of block firstBlock + n/4.
+		template<typename Body>
+		inline void ForEachChunk(const unsigned int *key, unsigned long long stream, unsigned long long firstBlock,
+		                         int count, const Body &body) {
+			int chunksCount = (count + ChunkSize - 1)/ChunkSize;
+			DispatchFor(chunksCount, ChunkSize*GenerationCost, sizeof(float),
+			[=](const blocked_range<size_t>& r)
+			{
+				unsigned int bits[ChunkSize];
+				for (int chunk = r.begin(); chunk < r.end(); chunk++) {
+					int first = chunk*ChunkSize;
+					int chunkCount = std::min(ChunkSize, count - first);
+					GenerateBlocks(key, stream, firstBlock + first/4, (chunkCount + 3)/4, bits);
+					body(first, chunkCount, bits);
+				}
+			});
+		}
+
+		// ForEachChunk that hands body(first, count, normals) standard normal values, made from the
+		// bits by the Box-Muller transform.
+		template<typename Body>
+		inline void ForEachNormalChunk(const unsigned int *key, unsigned long long stream, unsigned long long firstBlock,
+		                               int count, const Body &body) {
+			ForEachChunk(key, stream, firstBlock, count, [=](int first, int chunkCount, const unsigned int *bits) {
+				float normals[ChunkSize];
+				int pairsCount = (chunkCount + 1)/2;
+				const unsigned int *angleBits = bits + pairsCount;
+				float *sines = normals + pairsCount;
+				for (int i = 0; i < pairsCount; i++) {
+					float radius = sqrtf(-2.0f*Log(ToUniform(bits[i]) + UniformScale));
+					float cosine, sine;
+					SinCos(ToUniform(angleBits[i]), cosine, sine);
+					normals[i] = radius*cosine;
+					sines[i] = radius*sine;
+				}
+				body(first, chunkCount, normals);
+			});
+		}
+	}
+
+	PhiloxRandom::PhiloxRandom(unsigned long long seed, unsigned long long stream) {
+		Reset(seed, stream);
+	}
+
+	void PhiloxRandom::Reset(unsigned long long seed, unsigned long long stream) {
+		_key[0] = (unsigned int)seed;
+		_key[1] = (unsigned int)(seed >> 32);
+		_stream = stream;
+		_position = 0;
+	}
+
+	unsigned long long PhiloxRandom::GetSeed(void) const {
+		return ((unsigned long long)_key[1] << 32) | _key[0];
+	}
+
+	unsigned long long PhiloxRandom::GetStream(void) const {
+		return _stream;
+	}
+
+	unsigned long long PhiloxRandom::GetPosition(void) const {
+		return _position;
+	}
+
+	void PhiloxRandom::FillUniform(float *values, int count) {
+		unsigned long long firstBlock = _position;
+		_position += (count + 3)/4;
+		ForEachChunk(_key, _stream, firstBlock, count, [=](int first, int chunkCount, const unsigned int *bits) {
+			float *chunk = values + first;
+			for (int i = 0; i < chunkCount; i++) {
+				chunk[i] = ToUniform(bits[i]);
+			}
+		});
+	}
+
+	void PhiloxRandom::AddNormal(float *values, int count) {
+		unsigned long long firstBlock = _position;
+		_position += (count + 3)/4;
+		ForEachNormalChunk(_key, _stream, firstBlock, count, [=](int first, int chunkCount, const float *normals) {
+			float *chunk = values + first;
+			for (int i = 0; i < chunkCount; i++) {
+				chunk[i] += normals[i];
+			}
+		});
+	}
+
+	void PhiloxRandom::NoisyRectifier(float *potentials, int count) {
+		unsigned long long firstBlock = _position;
+		_position += (count + 3)/4;
+		ForEachNormalChunk(_key, _stream, firstBlock, count, [=](int first, int chunkCount, const float *normals) {
+			float *chunk = potentials + first;
+			for (int i = 0; i < chunkCount; i++) {
+				float potential = chunk[i];
+				float deviation = sqrtf(1.0f/(1.0f + Exp(-potential)));
+				chunk[i] = std::max(0.0f, potential + deviation*normals[i]);
+			}
+		});
+	}
+
+	void PhiloxRandom::RectifiedNormal(float *means, int count) {
+		unsigned long long firstBlock = _position;
+		_position += (count + 3)/4;
+		ForEachNormalChunk(_key, _stream, firstBlock, count, [=](int first, int chunkCount, const float *normals) {
+			float *chunk = means + first;
+			for (int i = 0; i < chunkCount; i++) {
+				chunk[i] = std::max(0.0f, chunk[i] + normals[i]);
+			}
+		});
+	}
+
+	void PhiloxRandom::Bernoulli(float *probabilities, int count) {
+		unsigned long long firstBlock = _position;
+		_position += (count + 3)/4;
+		ForEachChunk(_key, _stream, firstBlock, count, [=](int first, int chunkCount, const unsigned int *bits) {
+			float *chunk = probabilities + first;
+			for (int i = 0; i < chunkCount; i++) {
+				chunk[i] = (ToUniform(bits[i]) < chunk[i]) ? 1.0f : 0.0f;
+			}
+		});
+	}
+
+	void PhiloxRandom::Bernoulli(const float *probabilities, int rowsCount, int columnsCount, unsigned long long *words, int wordsPerRow) {
+		unsigned long long firstBlock = _position;
+		_position += ((size_t)rowsCount*columnsCount + 3)/4;
+		// Segments of ChunkSize columns start at a word of their row, so they are filled independently. A
+		// segment starts within a block of the stream, so its values begin at the lane of that start.
+		int segmentsCount = (columnsCount + ChunkSize - 1)/ChunkSize;
+		DispatchFor(rowsCount*segmentsCount, ChunkSize*GenerationCost, sizeof(float),
+		[=](const blocked_range<size_t>& r)
+		{
+			unsigned int bits[ChunkSize + 4];
+			for (int segment = r.begin(); segment < r.end(); segment++) {
+				int row = segment/segmentsCount;
+				int first = (segment%segmentsCount)*ChunkSize;
+				int count = std::min(ChunkSize, columnsCount - first);
+				size_t index = (size_t)row*columnsCount + first;
+				int lane = (int)(index%4);
+				GenerateBlocks(_key, _stream, firstBlock + index/4, (lane + count + 3)/4, bits);
+				const float *segmentProbabilities = probabilities + index;
+				const unsigned int *segmentBits = bits + lane;
+				unsigned long long *segmentWords = words + (size_t)row*wordsPerRow + first/WordBits;
+				for (int w = 0; w*WordBits < count; w++) {
+					int wordFirst = w*WordBits;
+					int wordCount = std::min(WordBits, count - wordFirst);
+					unsigned long long word = 0;
+					for (int l = 0; l < wordCount; l++) {
+						word |= (unsigned long long)(ToUniform(segmentBits[wordFirst + l]) <
+						                             segmentProbabilities[wordFirst + l]) << l;
+					}
+					segmentWords[w] = word;
+				}
+			}
+		});
+		int usedWords = (columnsCount + WordBits - 1)/WordBits;
+		for (int row = 0; row < rowsCount; row++) {
+			std::fill(words + (size_t)row*wordsPerRow + usedWords, words + (size_t)(row + 1)*wordsPerRow, 0ull);
+		}
+	}
+}
@@ -0,0 +1,33 @@
+#pragma once
+
+#include "ExportDll.h"
+
+namespace NeuralNetNative {
+	// Counter-based Philox4x32-10 generator. The n-th value of a stream depends only on the seed, the
+	// stream number and n, so fills are split between threads without changing the result, and every
+	// chain can own an independent reproducible stream. Each fill of count values consumes
+	// (count + 3)/4 blocks of the stream.
+	class NEURALNETNATIVE_EXPORT PhiloxRandom {
+	private:
+		unsigned int _key[2];
+		unsigned long long _stream;
+		unsigned long long _position;
+	public:
+		PhiloxRandom(unsigned long long seed, unsigned long long stream);
+		void Reset(unsigned long long seed, unsigned long long stream);
+		unsigned long long GetSeed(void) const;
+		unsigned long long GetStream(void) const;
+		unsigned long long GetPosition(void) const;
+		void FillUniform(float *values, int count);
+		void AddNormal(float *values, int count);
+		// Replaces every potential x by the noisy rectified linear state max(0, x + N(0, sigmoid(x))).
+		void NoisyRectifier(float *potentials, int count);
+		// Replaces every mean m by the rectified Gaussian state max(0, m + N(0, 1)).
+		void RectifiedNormal(float *means, int count);
+		// Replaces every probability p by 1 with probability p and by 0 otherwise.
+		void Bernoulli(float *probabilities, int count);
+		// The same draws for rowsCount rows of columnsCount probabilities, stored as bits: row b starts at
+		// words + b*wordsPerRow and its unused tail bits are cleared.
+		void Bernoulli(const float *probabilities, int rowsCount, int columnsCount, unsigned long long *words, int wordsPerRow);
+	};
+}
@@ -1,7 +1,7 @@
 #define NEURALNETNATIVEAPI
 
 #include "RbmGradients.h"
-#include <malloc.h>
+#include "Platform.h"
 #include <algorithm>
 
 namespace NeuralNetNative {
@@ -1,21 +1,41 @@
 #define NEURALNETNATIVEAPI
 
-#include <mathimf.h>
+#include "Platform.h"
 #include "RbmTrainMethod.h"
+#include "AsyncModelTester.h"
+#include "AnnealedImportanceSampling.h"
+#include "ExecutionContext.h"
+#include "HammingDistance.h"
 #include <cfloat>
+#include <algorithm>
 
 namespace NeuralNetNative {
 	namespace RestrictedBoltzmannMachine {
+		// The snapshot tested asynchronously samples from the stream of the model with the top bit set, so
+		// the evaluation thread never repeats the draws of training.
+		const unsigned long long SnapshotStreamBit = 1ULL << 63;
+
         RbmTrainMethod::RbmTrainMethod(StandardTypesNative::TrainSingle **trainData,
                        int trainDataSize,
                        GradientFunction *gradientFunction) {
             _trainDataIterator = new StandardTypesNative::RandomAccessIterator<StandardTypesNative::
                                                           TrainSingle*>(trainData, trainDataSize);
-            _neuronNetOutput = (float*)_mm_malloc(trainData[0]->InputLength()*sizeof(float), 32);
+            _neuronNetOutput = 0;
 			_testData = 0;
 			_testDataSize = 0;
 
             _gradientFunction = gradientFunction;
+            gradients = 0;
+            _asyncTester = 0;
+            _snapshotNeuralNet = 0;
+            _visibleStatesBatch = 0;
+            packedHiddenStates = 0;
+            _likelihoodEstimator = 0;
+            _likelihoodEstimationInterval = 0;
+            _inputTransform = 0;
+            _transformedInput = 0;
+            _packageSamples = 0;
+            LikelihoodEstimated = 0;
         }
 
         RbmTrainMethod::RbmTrainMethod(StandardTypesNative::TrainSingle **trainData,
@@ -24,17 +44,29 @@ namespace NeuralNetNative {
                        GradientFunction *gradientFunction) {
             _trainDataIterator = new StandardTypesNative::RandomAccessIterator<StandardTypesNative::
                                                           TrainSingle*>(trainData, trainDataSize);
-            _neuronNetOutput = (float*)_mm_malloc(trainData[0]->InputLength()*sizeof(float), 32);
+            _neuronNetOutput = 0;
 			_testData = testData;
 			_testDataSize = testDataSize;
 
             _gradientFunction = gradientFunction;
+            gradients = 0;
+            _asyncTester = 0;
+            _snapshotNeuralNet = 0;
+            _visibleStatesBatch = 0;
+            packedHiddenStates = 0;
+            _likelihoodEstimator = 0;
+            _likelihoodEstimationInterval = 0;
+            _inputTransform = 0;
+            _transformedInput = 0;
+            _packageSamples = 0;
+            LikelihoodEstimated = 0;
         }
 
         RbmTrainMethod::~RbmTrainMethod(void) {
-            _mm_free(_neuronNetOutput);
-            
             delete _trainDataIterator;
+            DeleteAsyncTestingData();
+            DeleteBatchData();
+            DeleteInputData();
             
             if (gradients != 0) {
                 delete gradients;
@@ -43,17 +75,24 @@ namespace NeuralNetNative {
         }
 
         void RbmTrainMethod::RunIterativeProcess(void) {
-            if (IsTestDataAvailable()) {
-	            RunTraingWithTesting();
-	        }
-			else {
-				RunTraingWithoutTesting();
-			}
+            ExecutionContext::ExecuteIn(properties->Context, [this]() {
+                if (properties->AsyncTesting) {
+                    RunTraingWithAsyncTesting();
+                }
+                else if (IsTestDataAvailable()) {
+                    RunTraingWithTesting();
+                }
+                else {
+                    RunTraingWithoutTesting();
+                }
+            });
         }
 
         void RbmTrainMethod::ApplyResults(void) {
             if (ProcessSate == StandardTypesNative::IterativeProcessState::Finished) {
 				DeleteTemporaryData();
+                DeleteAsyncTestingData();
+                DeleteBatchData();
 
                 if (gradients != 0) {
                     delete gradients;
@@ -67,20 +106,22 @@ namespace NeuralNetNative {
         }
 
         void RbmTrainMethod::RunTraingWithTesting(void) {
-            float trainError = TestModel(_trainDataIterator->Collection(), _trainDataIterator->Size());
-			float slidingTestError = TestModel(_testData, _testDataSize);
+            float trainError = TestModel(neuralNet, _neuronNetOutput, _trainDataIterator->Collection(), GetTestedTrainDataSize());
+			float slidingTestError = ToTestError(TestModel(neuralNet, _neuronNetOutput, _testData, _testDataSize), trainError);
 			float minTestError = slidingTestError;
 			epochNumber = 1;
 			while ((ProcessSate == StandardTypesNative::IterativeProcessState::InProgress) && 
-				(trainError > properties->Epsilon) && 
+				!IsEpsilonReached(trainError) && 
 				(epochNumber <= properties->MaxIterationCount) &&
 				((epochNumber <= properties->SkipCvLimitFirstIterations) ||
                  (fabsf(slidingTestError - minTestError) < properties->CvLimit))) {
 
+				TELEMETRY_BEGIN_EPOCH(Telemetry, epochNumber);
 				TrainEpoch();
+				EstimateLikelihood();
 
-				trainError = TestModel(_trainDataIterator->Collection(), _trainDataIterator->Size());
-				float testError = TestModel(_testData, _testDataSize);
+				trainError = EvaluateModel(_trainDataIterator->Collection(), GetTestedTrainDataSize());
+				float testError = ToTestError(EvaluateModel(_testData, _testDataSize), trainError);
                 slidingTestError = properties->CvSlidingFactor*testError +
 					(1.0f - properties->CvSlidingFactor)*slidingTestError;
 
@@ -89,23 +130,27 @@ namespace NeuralNetNative {
 				}
 
 				OnIterationCompleted(epochNumber, trainError, testError);
+				TELEMETRY_END_EPOCH();
 				epochNumber++;
 			}
 			OnIterativeProcessFinished(epochNumber);
         }
 
         void RbmTrainMethod::RunTraingWithoutTesting(void) {
-            float trainError = TestModel(_trainDataIterator->Collection(), _trainDataIterator->Size());
+            float trainError = TestModel(neuralNet, _neuronNetOutput, _trainDataIterator->Collection(), GetTestedTrainDataSize());
 			epochNumber = 1;
 			while ((ProcessSate == StandardTypesNative::IterativeProcessState::InProgress) && 
-				   (trainError > properties->Epsilon) && 
+				   !IsEpsilonReached(trainError) && 
 				   (epochNumber <= properties->MaxIterationCount)) {
 
+				TELEMETRY_BEGIN_EPOCH(Telemetry, epochNumber);
 				TrainEpoch();
+				EstimateLikelihood();
 
-				trainError = TestModel(_trainDataIterator->Collection(), _trainDataIterator->Size());
+				trainError = EvaluateModel(_trainDataIterator->Collection(), GetTestedTrainDataSize());
 
 				OnIterationCompleted(epochNumber, trainError, std::numeric_limits<float>::quiet_NaN());
+				TELEMETRY_END_EPOCH();
 				epochNumber++;
 			}
 			OnIterativeProcessFinished(epochNumber);
@@ -119,36 +164,427 @@ namespace NeuralNetNative {
 			return count;
         }
 
-        float RbmTrainMethod::TestModel(StandardTypesNative::TrainSingle **data, int dataSize) const {
+        void RbmTrainMethod::RunTraingWithAsyncTesting(void) {
+            bool isTestDataAvailable = IsTestDataAvailable();
+            float trainError = TestModel(neuralNet, _neuronNetOutput, _trainDataIterator->Collection(), GetTestedTrainDataSize());
+			float slidingTestError = isTestDataAvailable ?
+				ToTestError(TestModel(neuralNet, _neuronNetOutput, _testData, _testDataSize), trainError) : 0.0f;
+			float minTestError = slidingTestError;
+			ModelTestResult testResult;
+			epochNumber = 1;
+			while ((ProcessSate == StandardTypesNative::IterativeProcessState::InProgress) && 
+				!IsEpsilonReached(trainError) && 
+				(epochNumber <= properties->MaxIterationCount) &&
+				(!isTestDataAvailable || (epochNumber <= properties->SkipCvLimitFirstIterations) ||
+                 (fabsf(slidingTestError - minTestError) < properties->CvLimit))) {
+
+				TELEMETRY_BEGIN_EPOCH(Telemetry, epochNumber);
+				TrainEpoch();
+				EstimateLikelihood();
+
+				if (_asyncTester->TryGetResult(testResult)) {
+					ApplyAsyncTestResult(testResult, trainError, slidingTestError, minTestError);
+				}
+				if (!_asyncTester->IsBusy()) {
+					StartAsyncTesting();
+				}
+				TELEMETRY_END_EPOCH();
+				epochNumber++;
+			}
+
+			if (_asyncTester->WaitResult(testResult)) {
+				ApplyAsyncTestResult(testResult, trainError, slidingTestError, minTestError);
+			}
+			OnIterativeProcessFinished(epochNumber);
+        }
+
+        void RbmTrainMethod::StartAsyncTesting(void) {
+            neuralNet->CopyParametersTo(_snapshotNeuralNet);
+            _asyncTester->Run(epochNumber, [this](ModelTestResult &result) {
+                ExecutionContext::ExecuteIn(properties->Context, [this, &result]() {
+                    result.TrainError = TestModel(_snapshotNeuralNet, _snapshotOutput,
+                                                  _trainDataIterator->Collection(), GetTestedTrainDataSize());
+                    result.TestError = IsTestDataAvailable() ?
+                        ToTestError(TestModel(_snapshotNeuralNet, _snapshotOutput, _testData, _testDataSize), result.TrainError) :
+                        std::numeric_limits<float>::quiet_NaN();
+                });
+            });
+        }
+
+        void RbmTrainMethod::ApplyAsyncTestResult(const ModelTestResult &result, float &trainError,
+                                                  float &slidingTestError, float &minTestError) {
+            TELEMETRY_TIME(Telemetry, StandardTypesNative::EvaluationPhase, result.Seconds);
+            AddEvaluationWork(GetTestedTrainDataSize());
+            if (IsTestDataAvailable()) {
+                AddEvaluationWork(_testDataSize);
+            }
+            trainError = result.TrainError;
+            if (IsTestDataAvailable()) {
+                slidingTestError = properties->CvSlidingFactor*result.TestError +
+                    (1.0f - properties->CvSlidingFactor)*slidingTestError;
+                if (result.TestError < minTestError) {
+                    minTestError = result.TestError;
+                }
+            }
+            OnIterationCompleted(result.IterationNum, result.TrainError, result.TestError);
+        }
+
+        void RbmTrainMethod::DeleteAsyncTestingData(void) {
+            if (_asyncTester != 0) {
+                delete _asyncTester;
+                delete _snapshotNeuralNet;
+                _mm_free(_snapshotOutput);
+                _asyncTester = 0;
+                _snapshotNeuralNet = 0;
+            }
+        }
+
+        void RbmTrainMethod::DeleteBatchData(void) {
+            if (_visibleStatesBatch != 0) {
+                _mm_free(_visibleStatesBatch);
+                _mm_free(_hiddenStatesBatch);
+                _visibleStatesBatch = 0;
+            }
+            if (packedHiddenStates != 0) {
+                delete packedHiddenStates;
+                packedHiddenStates = 0;
+            }
+        }
+
+        void RbmTrainMethod::DeleteInputData(void) {
+            if (_neuronNetOutput != 0) {
+                _mm_free(_neuronNetOutput);
+                _neuronNetOutput = 0;
+            }
+            if (_transformedInput != 0) {
+                _mm_free(_transformedInput);
+                _transformedInput = 0;
+            }
+            if (_packageSamples != 0) {
+                delete[] _packageSamples;
+                _packageSamples = 0;
+            }
+        }
+
+        void RbmTrainMethod::CopyInputs(StandardTypesNative::TrainSingle *const *samples, int count, float *inputBatch) const {
+            if (_inputTransform != 0) {
+                _inputTransform->Transform(samples, count, inputBatch);
+                return;
+            }
+            for (int b = 0; b < count; b++) {
+                float *input = samples[b]->Input();
+                std::copy(input, input + visibleStatesCount, inputBatch + (size_t)b*visibleStatesCount);
+            }
+        }
+
+        bool RbmTrainMethod::IsFreeEnergyMonitoring(void) const {
+            return properties->FreeEnergyTrainSamples > 0;
+        }
+
+        int RbmTrainMethod::GetTestedTrainDataSize(void) const {
+            return IsFreeEnergyMonitoring() ? std::min(properties->FreeEnergyTrainSamples, _trainDataIterator->Size()) :
+                                              _trainDataIterator->Size();
+        }
+
+        bool RbmTrainMethod::IsEpsilonReached(float trainError) const {
+            // An average free energy is not an error, so only the reconstruction error stops on Epsilon.
+            return !IsFreeEnergyMonitoring() && (trainError <= properties->Epsilon);
+        }
+
+        float RbmTrainMethod::ToTestError(float testValue, float trainError) const {
+            // The free energy of the test data rises above that of the train data as the model overfits,
+            // so the gap takes the place of the test error.
+            return IsFreeEnergyMonitoring() ? testValue - trainError : testValue;
+        }
+
+        float RbmTrainMethod::TestModel(RestrictedBoltzmannMachineBase *model, float *output,
+                                        StandardTypesNative::TrainSingle **data, int dataSize) const {
+            if (IsFreeEnergyMonitoring()) {
+                return CalculateAverageFreeEnergy(model, data, dataSize);
+            }
+            int batchSize = std::min(properties->PackageSize, dataSize);
+            float *visibleStatesBatch = (float*)_mm_malloc((size_t)batchSize*visibleStatesCount*sizeof(float), 32);
             float sumError = 0.0f;
-            for (int i = 0; i < dataSize; i++) {
-                StandardTypesNative::TrainSingle *testExample = data[i];
-                neuralNet->Predict(testExample->Input(), _neuronNetOutput);
-                sumError += properties->Metrics->Calculate(testExample->Input(), _neuronNetOutput, visibleStatesCount);
+            for (int first = 0; first < dataSize; first += batchSize) {
+                int count = std::min(batchSize, dataSize - first);
+                CopyInputs(data + first, count, visibleStatesBatch);
+                sumError += CalculateErrorsSum(model, output, data + first, visibleStatesBatch, count);
             }
+            _mm_free(visibleStatesBatch);
             return sumError / dataSize;
         }
 
+        bool RbmTrainMethod::IsPackedTesting(RestrictedBoltzmannMachineBase *model) const {
+            return properties->PackedStates && model->SupportsPackedStates() &&
+                   (dynamic_cast<const StandardTypesNative::HammingDistance*>(properties->Metrics) != 0);
+        }
+
+        float RbmTrainMethod::CalculatePackedDifferencesSum(RestrictedBoltzmannMachineBase *model, const float *visibleStatesBatch,
+                                                            int count) const {
+            // The buffers are local so that the asynchronous tester can run next to the training.
+            PackedStates inputs(count, visibleStatesCount);
+            PackedStates hiddenStates(count, hiddenStatesCount);
+            PackedStates reconstructions(count, visibleStatesCount);
+            float *hiddenStatesBatch = (float*)_mm_malloc((size_t)count*hiddenStatesCount*sizeof(float), 32);
+            float *reconstructionsBatch = (float*)_mm_malloc((size_t)count*visibleStatesCount*sizeof(float), 32);
+            inputs.Pack(visibleStatesBatch, count);
+            model->HiddenLayerCalculateActivity(inputs, hiddenStatesBatch, count);
+            model->HiddenLayerSampling(hiddenStatesBatch, hiddenStates, count);
+            model->VisibleLayerCalculateActivity(hiddenStates, reconstructionsBatch, count);
+            model->VisibleLayerSampling(reconstructionsBatch, reconstructions, count);
+            int differencesCount = 0;
+            for (int b = 0; b < count; b++) {
+                differencesCount += inputs.CountDifferences(b, reconstructions, b);
+            }
+            _mm_free(hiddenStatesBatch);
+            _mm_free(reconstructionsBatch);
+            return (float)differencesCount;
+        }
+
+        float RbmTrainMethod::CalculateAverageFreeEnergy(RestrictedBoltzmannMachineBase *model,
+                                                         StandardTypesNative::TrainSingle **data, int dataSize) const {
+            int batchSize = std::min(properties->PackageSize, dataSize);
+            float *visibleStatesBatch = (float*)_mm_malloc((size_t)batchSize*visibleStatesCount*sizeof(float), 32);
+            float *freeEnergies = (float*)_mm_malloc(batchSize*sizeof(float), 32);
+            double sumFreeEnergy = 0.0;
+            for (int first = 0; first < dataSize; first += batchSize) {
+                int count = std::min(batchSize, dataSize - first);
+                CopyInputs(data + first, count, visibleStatesBatch);
+                model->CalculateFreeEnergies(visibleStatesBatch, freeEnergies, count);
+                for (int b = 0; b < count; b++) {
+                    sumFreeEnergy += freeEnergies[b];
+                }
+            }
+            _mm_free(visibleStatesBatch);
+            _mm_free(freeEnergies);
+            return (float)(sumFreeEnergy/dataSize);
+        }
+
+        float RbmTrainMethod::EvaluateModel(StandardTypesNative::TrainSingle **data, int dataSize) {
+            TELEMETRY_SCOPE(Telemetry, StandardTypesNative::EvaluationPhase);
+            AddEvaluationWork(dataSize);
+            return TestModel(neuralNet, _neuronNetOutput, data, dataSize);
+        }
+
+        void RbmTrainMethod::AddEvaluationWork(int dataSize) {
+#if NNETS_TELEMETRY
+            double weightsCount = (double)visibleStatesCount*hiddenStatesCount;
+            if (IsFreeEnergyMonitoring()) {
+                // One batched hidden pass, which streams the weights once per batch.
+                double batchesCount = ceil((double)dataSize/properties->PackageSize);
+                TELEMETRY_WORK(Telemetry, StandardTypesNative::EvaluationPhase, 2.0*weightsCount*dataSize, sizeof(float)*weightsCount*batchesCount);
+            }
+            else {
+                TELEMETRY_WORK(Telemetry, StandardTypesNative::EvaluationPhase, 4.0*weightsCount*dataSize, 2*sizeof(float)*weightsCount*dataSize);
+            }
+#endif
+        }
+
+        void RbmTrainMethod::EstimateLikelihood(void) {
+            if ((_likelihoodEstimator == 0) || (epochNumber%_likelihoodEstimationInterval != 0)) {
+                return;
+            }
+            StandardTypesNative::TrainSingle **data = IsTestDataAvailable() ? _testData : _trainDataIterator->Collection();
+            int dataSize = IsTestDataAvailable() ? _testDataSize : _trainDataIterator->Size();
+            TELEMETRY_SCOPE(Telemetry, StandardTypesNative::EvaluationPhase);
+#if NNETS_TELEMETRY
+            double weightsCount = (double)visibleStatesCount*hiddenStatesCount;
+            double annealingPasses = 2.0*_likelihoodEstimator->GetRunsCount()*_likelihoodEstimator->GetTemperaturesCount();
+            TELEMETRY_WORK(Telemetry, StandardTypesNative::EvaluationPhase, 2.0*weightsCount*(annealingPasses + dataSize),
+                           sizeof(float)*weightsCount*(2.0*_likelihoodEstimator->GetTemperaturesCount() + 1.0));
+#endif
+            float logLikelihood = _likelihoodEstimator->EstimateAverageLogLikelihood(neuralNet, data, dataSize, _inputTransform);
+            if (LikelihoodEstimated != 0) {
+                LikelihoodEstimated->Invoke(epochNumber, _likelihoodEstimator->GetLogPartitionFunction(), logLikelihood);
+            }
+        }
+
+        void RbmTrainMethod::SetLikelihoodEstimator(AnnealedImportanceSampling *estimator, int epochsInterval) {
+            _likelihoodEstimator = (epochsInterval > 0) ? estimator : 0;
+            _likelihoodEstimationInterval = epochsInterval;
+        }
+
+        void RbmTrainMethod::SetInputTransform(const DataTransform *inputTransform) {
+            _inputTransform = inputTransform;
+        }
+
+        int RbmTrainMethod::NegativePhaseLayerPassesCount(void) const {
+            return 2;
+        }
+
+        bool RbmTrainMethod::SupportsBatchTraining(void) const {
+            return false;
+        }
+
+        void RbmTrainMethod::MakeBatchNegativePhase(float *visibleStatesBatch, float *hiddenStatesBatch, int batchSize) {
+        }
+
+        int RbmTrainMethod::GetBatchNegativePhaseSize(void) const {
+            return properties->PackageSize;
+        }
+
+        float* RbmTrainMethod::GetVisibleStatesOnBatchNegativePhase(void) {
+            return _visibleStatesBatch;
+        }
+
+        float* RbmTrainMethod::GetHiddenStatesOnBatchNegativePhase(void) {
+            return _hiddenStatesBatch;
+        }
+
+        void RbmTrainMethod::RestoreBatchVisibleStates(void) {
+        }
+
+        bool RbmTrainMethod::HasGenerativeGradient(void) const {
+            return true;
+        }
+
+        void RbmTrainMethod::AddPackageGradient(StandardTypesNative::TrainSingle *const *samples, int samplesCount) {
+        }
+
+        float RbmTrainMethod::CalculateErrorsSum(RestrictedBoltzmannMachineBase *model, float *output,
+                                                 StandardTypesNative::TrainSingle *const *samples,
+                                                 const float *visibleStatesBatch, int count) const {
+            if (IsPackedTesting(model)) {
+                return CalculatePackedDifferencesSum(model, visibleStatesBatch, count);
+            }
+            float sumError = 0.0f;
+            for (int b = 0; b < count; b++) {
+                const float *input = visibleStatesBatch + (size_t)b*visibleStatesCount;
+                model->Predict(input, output);
+                sumError += properties->Metrics->Calculate(input, output, visibleStatesCount);
+            }
+            return sumError;
+        }
+
         void RbmTrainMethod::TrainEpoch(void) {
-            _trainDataIterator->RefreshRandomAccess();
+            {
+                TELEMETRY_SCOPE(Telemetry, StandardTypesNative::ShufflePhase);
+                _trainDataIterator->RefreshRandomAccess();
+            }
 			for (int i = 0; i < packagesCount; i++) {
-				TrainPackage(i);
+				if (_visibleStatesBatch != 0) {
+					TrainPackageBatch();
+				}
+				else {
+					TrainPackage(i);
+				}
 			}
         }
 
         void RbmTrainMethod::TrainPackage(int packageId) {
-            _gradientFunction->PrepareToNextPackage(properties->PackageSize);
+            bool hasGenerativeGradient = HasGenerativeGradient();
+            if (hasGenerativeGradient) {
+                _gradientFunction->PrepareToNextPackage(properties->PackageSize);
+            }
+			double forwardSeconds = 0.0, backwardSeconds = 0.0, gradientSeconds = 0.0;
 			for (int i = 0; i < properties->PackageSize; i++) {
-				float *input = _trainDataIterator->Next()->Input();
-
+				StandardTypesNative::TrainSingle *sample = _trainDataIterator->Next();
+				_packageSamples[i] = sample;
+				if (!hasGenerativeGradient) {
+					continue;
+				}
+				double time = TELEMETRY_NOW();
+				float *input = sample->Input();
+				if (_inputTransform != 0) {
+					_inputTransform->Transform(&sample, 1, _transformedInput);
+					input = _transformedInput;
+				}
 				MakePositivePhase(input);
-                _gradientFunction->StorePositivePhaseData(input, neuralNet->GetHiddenStates());
+				TELEMETRY_LAP(forwardSeconds, time);
+				_gradientFunction->StorePositivePhaseData(input, neuralNet->GetHiddenStates());
+				TELEMETRY_LAP(gradientSeconds, time);
 				MakeNegativePhase(packageId);
+				TELEMETRY_LAP(backwardSeconds, time);
 				_gradientFunction->StoreNegativePhaseData(GetVisibleStatesOnNegativePhase(packageId), GetHiddenStatesOnNegativePhase());
+				TELEMETRY_LAP(gradientSeconds, time);
 				RestoreVisibleStates(packageId);
+				TELEMETRY_LAP(backwardSeconds, time);
+			}
+			TELEMETRY_TIME(Telemetry, StandardTypesNative::ForwardPhase, forwardSeconds);
+			TELEMETRY_TIME(Telemetry, StandardTypesNative::BackwardPhase, backwardSeconds);
+			TELEMETRY_TIME(Telemetry, StandardTypesNative::GradientPhase, gradientSeconds);
+			{
+				TELEMETRY_SCOPE(Telemetry, StandardTypesNative::GradientPhase);
+				if (hasGenerativeGradient) {
+					_gradientFunction->MakeGradient(_packageFactor);
+				}
+				AddPackageGradient(_packageSamples, properties->PackageSize);
+			}
+			{
+				TELEMETRY_SCOPE(Telemetry, StandardTypesNative::UpdatePhase);
+				ModifyWeightsOfNeuronNet();
+				neuralNet->RefreshTransposedWeights();
+			}
+			AddPackageWork(false);
+        }
+
+        void RbmTrainMethod::TrainPackageBatch(void) {
+            int batchSize = properties->PackageSize;
+            for (int b = 0; b < batchSize; b++) {
+                _packageSamples[b] = _trainDataIterator->Next();
+            }
+            if (HasGenerativeGradient()) {
+                MakeGenerativeGradientBatch();
+            }
+			{
+				TELEMETRY_SCOPE(Telemetry, StandardTypesNative::GradientPhase);
+				AddPackageGradient(_packageSamples, batchSize);
+			}
+			{
+				TELEMETRY_SCOPE(Telemetry, StandardTypesNative::UpdatePhase);
+				ModifyWeightsOfNeuronNet();
+				neuralNet->RefreshTransposedWeights();
+			}
+			AddPackageWork(true);
+        }
+
+        void RbmTrainMethod::MakeGenerativeGradientBatch(void) {
+            int batchSize = properties->PackageSize;
+            _gradientFunction->PrepareToNextPackage(batchSize);
+			{
+				TELEMETRY_SCOPE(Telemetry, StandardTypesNative::ForwardPhase);
+				CopyInputs(_packageSamples, batchSize, _visibleStatesBatch);
+				neuralNet->HiddenLayerCalculateActivity(_visibleStatesBatch, _hiddenStatesBatch, batchSize);
+			}
+			{
+				TELEMETRY_SCOPE(Telemetry, StandardTypesNative::GradientPhase);
+				_gradientFunction->StorePositivePhaseBatch(_visibleStatesBatch, _hiddenStatesBatch, batchSize);
+			}
+			{
+				TELEMETRY_SCOPE(Telemetry, StandardTypesNative::BackwardPhase);
+				MakeBatchNegativePhase(_visibleStatesBatch, _hiddenStatesBatch, batchSize);
+			}
+			{
+				TELEMETRY_SCOPE(Telemetry, StandardTypesNative::GradientPhase);
+				int negativeBatchSize = GetBatchNegativePhaseSize();
+				_gradientFunction->StoreNegativePhaseBatch(GetVisibleStatesOnBatchNegativePhase(), GetHiddenStatesOnBatchNegativePhase(),
+				                                           negativeBatchSize, (float)batchSize/negativeBatchSize);
+				_gradientFunction->MakeGradient(_packageFactor);
+			}
+			{
+				TELEMETRY_SCOPE(Telemetry, StandardTypesNative::BackwardPhase);
+				RestoreBatchVisibleStates();
+			}
+        }
+
+        void RbmTrainMethod::AddPackageWork(bool isBatch) {
+#if NNETS_TELEMETRY
+			double weightsCount = (double)visibleStatesCount*hiddenStatesCount;
+			double packageSize = properties->PackageSize;
+			double negativeSize = isBatch ? GetBatchNegativePhaseSize() : packageSize;
+			double negativePasses = NegativePhaseLayerPassesCount();
+			// A batched pass streams the weights once per package instead of once per sample.
+			double weightsReads = isBatch ? 1.0 : packageSize;
+			TELEMETRY_SAMPLES(Telemetry, properties->PackageSize);
+			if (HasGenerativeGradient()) {
+				TELEMETRY_WORK(Telemetry, StandardTypesNative::ForwardPhase, 2.0*weightsCount*packageSize, sizeof(float)*weightsCount*weightsReads);
+				TELEMETRY_WORK(Telemetry, StandardTypesNative::BackwardPhase, 2.0*negativePasses*weightsCount*negativeSize,
+				               sizeof(float)*negativePasses*weightsCount*weightsReads);
+				TELEMETRY_WORK(Telemetry, StandardTypesNative::GradientPhase, (2.0*(packageSize + negativeSize) + 1.0)*weightsCount,
+				               (4.0*weightsReads + 2.0)*sizeof(float)*weightsCount);
 			}
-			_gradientFunction->MakeGradient(_packageFactor);
-			ModifyWeightsOfNeuronNet();
+			TELEMETRY_WORK(Telemetry, StandardTypesNative::UpdatePhase, 12.0*weightsCount, 10*sizeof(float)*weightsCount);
+#endif
         }
 
         void RbmTrainMethod::InitilazeMethod(NeuralNet *newNeuralNet, TrainProperties *newProperties) {
@@ -159,16 +595,44 @@ namespace NeuralNetNative {
 
             visibleStatesCount = neuralNet->GetVisibleStatesCount();
             hiddenStatesCount = neuralNet->GetHiddenStatesCount();
+            neuralNet->RefreshTransposedWeights();
 
             gradients = new RbmGradients(visibleStatesCount, hiddenStatesCount);
-			_gradientFunction->Initialize(gradients);
+			if (_gradientFunction != 0) {
+				_gradientFunction->Initialize(gradients);
+			}
 				
 			properties = newProperties;
+			neuralNet->SetExecutionContext(properties->Context);
 			_packageFactor = 1.0f/properties->PackageSize;
 			packagesCount = CalculatePackagesCount();
 
 			CreateTemporaryData();
 
+			DeleteInputData();
+			_neuronNetOutput = (float*)_mm_malloc(visibleStatesCount*sizeof(float), 32);
+			if (_inputTransform != 0) {
+				_transformedInput = (float*)_mm_malloc(visibleStatesCount*sizeof(float), 32);
+			}
+			_packageSamples = new StandardTypesNative::TrainSingle*[properties->PackageSize];
+
+			DeleteAsyncTestingData();
+			if (properties->AsyncTesting) {
+				_asyncTester = new AsyncModelTester();
+				_snapshotNeuralNet = neuralNet->Clone();
+				_snapshotNeuralNet->SetRandomStream(neuralNet->GetRandom()->GetSeed(), neuralNet->GetRandom()->GetStream() | SnapshotStreamBit);
+				_snapshotOutput = (float*)_mm_malloc(visibleStatesCount*sizeof(float), 32);
+			}
+
+			DeleteBatchData();
+			if (properties->BatchTraining && SupportsBatchTraining()) {
+				_visibleStatesBatch = (float*)_mm_malloc((size_t)properties->PackageSize*visibleStatesCount*sizeof(float), 32);
+				_hiddenStatesBatch = (float*)_mm_malloc((size_t)properties->PackageSize*hiddenStatesCount*sizeof(float), 32);
+				if (properties->PackedStates && neuralNet->SupportsPackedStates()) {
+					packedHiddenStates = new PackedStates(properties->PackageSize, hiddenStatesCount);
+				}
+			}
+
 			ProcessSate = StandardTypesNative::IterativeProcessState::NotStarted;
 		}
 
@@ -8,9 +8,16 @@
 #include "RestrictedBoltzmannMachine.h"
 #include "RbmGradients.h"
 #include "GradientFunction.h"
+#include "DataTransform.h"
+#include "PackedStates.h"
 
 namespace NeuralNetNative {
+	class AsyncModelTester;
+	struct ModelTestResult;
+
 	namespace RestrictedBoltzmannMachine {
+		class AnnealedImportanceSampling;
+
 	    class NEURALNETNATIVE_EXPORT RbmTrainMethod : public TrainMethod {
 		private:
 		    StandardTypesNative::RandomAccessIterator<StandardTypesNative::TrainSingle*> *_trainDataIterator;
@@ -19,10 +26,22 @@ namespace NeuralNetNative {
 			float _packageFactor;
 			float *_neuronNetOutput;
             GradientFunction *_gradientFunction;
+			AsyncModelTester *_asyncTester;
+			RestrictedBoltzmannMachineBase *_snapshotNeuralNet;
+			float *_snapshotOutput;
+			float *_visibleStatesBatch;
+			float *_hiddenStatesBatch;
+			AnnealedImportanceSampling *_likelihoodEstimator;
+			int _likelihoodEstimationInterval;
+			const DataTransform *_inputTransform;
+			float *_transformedInput;
+			StandardTypesNative::TrainSingle **_packageSamples;
 		protected:
 		    TrainProperties *properties;
             RbmGradients *gradients;
 			RestrictedBoltzmannMachineBase *neuralNet;
+			// Rows for the sampled hidden states of a batch when TrainProperties.PackedStates applies, else 0.
+			PackedStates *packedHiddenStates;
 			int visibleStatesCount;
 			int hiddenStatesCount;
 			int epochNumber;
@@ -46,17 +65,63 @@ namespace NeuralNetNative {
 		    virtual float* GetHiddenStatesOnNegativePhase(void) = 0;
 		    virtual void RestoreVisibleStates(int packageId) = 0;
             virtual void ModifyWeightsOfNeuronNet() = 0;
+            virtual int NegativePhaseLayerPassesCount(void) const;
+            virtual bool SupportsBatchTraining(void) const;
+            virtual void MakeBatchNegativePhase(float *visibleStatesBatch, float *hiddenStatesBatch, int batchSize);
+            virtual int GetBatchNegativePhaseSize(void) const;
+            virtual float* GetVisibleStatesOnBatchNegativePhase(void);
+            virtual float* GetHiddenStatesOnBatchNegativePhase(void);
+            virtual void RestoreBatchVisibleStates(void);
+            // Without a generative gradient the positive and negative phases are skipped and the package
+            // gradient is made by AddPackageGradient alone, which runs after the generative gradient is made.
+            // Such methods may be created without a gradient function.
+            virtual bool HasGenerativeGradient(void) const;
+            virtual void AddPackageGradient(StandardTypesNative::TrainSingle *const *samples, int samplesCount);
+            // The sum of the errors of count samples whose (transformed) inputs are the rows of visibleStatesBatch.
+            virtual float CalculateErrorsSum(RestrictedBoltzmannMachineBase *model, float *output,
+                                             StandardTypesNative::TrainSingle *const *samples,
+                                             const float *visibleStatesBatch, int count) const;
         private:
             bool IsTestDataAvailable() const;
             void RunTraingWithTesting(void);
             void RunTraingWithoutTesting(void);
+            void RunTraingWithAsyncTesting(void);
+            void StartAsyncTesting(void);
+            void ApplyAsyncTestResult(const ModelTestResult &result, float &trainError, float &slidingTestError, float &minTestError);
+            void DeleteAsyncTestingData(void);
+            void DeleteBatchData(void);
+            void DeleteInputData(void);
+            void CopyInputs(StandardTypesNative::TrainSingle *const *samples, int count, float *inputBatch) const;
             int CalculatePackagesCount(void) const;
-            float TestModel(StandardTypesNative::TrainSingle **data, int dataSize) const;
+            bool IsFreeEnergyMonitoring(void) const;
+            int GetTestedTrainDataSize(void) const;
+            bool IsEpsilonReached(float trainError) const;
+            float ToTestError(float testValue, float trainError) const;
+            float TestModel(RestrictedBoltzmannMachineBase *model, float *output,
+                            StandardTypesNative::TrainSingle **data, int dataSize) const;
+            bool IsPackedTesting(RestrictedBoltzmannMachineBase *model) const;
+            float CalculatePackedDifferencesSum(RestrictedBoltzmannMachineBase *model, const float *visibleStatesBatch, int count) const;
+            float CalculateAverageFreeEnergy(RestrictedBoltzmannMachineBase *model,
+                                             StandardTypesNative::TrainSingle **data, int dataSize) const;
+            float EvaluateModel(StandardTypesNative::TrainSingle **data, int dataSize);
+            void AddEvaluationWork(int dataSize);
             void TrainEpoch(void);
 			void TrainPackage(int packageId);
+			void TrainPackageBatch(void);
+			void MakeGenerativeGradientBatch(void);
+			void AddPackageWork(bool isBatch);
+			void EstimateLikelihood(void);
         public:
+            // Invoked with the epoch number, the estimated log Z and the estimated average log-likelihood
+            // of the test data (of the train data when there is none).
+            ITripleCallback *LikelihoodEstimated;
             void InitilazeMethod(NeuralNet *neuralNet, TrainProperties *trainProperties);
 			TrainProperties* Properties(void) const;
+			// Estimates the log-likelihood after every epochsInterval epochs; 0 turns the estimation off.
+			void SetLikelihoodEstimator(AnnealedImportanceSampling *estimator, int epochsInterval);
+			// The machine is trained and tested on the rows of the transform instead of the sample inputs,
+			// e.g. the hidden activations of the layers below it; 0 reads the inputs. Set before InitilazeMethod.
+			void SetInputTransform(const DataTransform *inputTransform);
         };
 	}
 }
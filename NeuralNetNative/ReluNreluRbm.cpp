@@ -0,0 +1,59 @@
+#define NEURALNETNATIVEAPI
+#include "Platform.h"
+#include <tbb/tbb.h>
+#include <tbb/parallel_for.h>
+#include <tbb/blocked_range.h>
+#include "ParallelDispatch.h"
+#include "ReluNreluRbm.h"
+
+using namespace tbb;
+
+namespace NeuralNetNative {
+	namespace RestrictedBoltzmannMachine {
+		ReluNreluRbm::ReluNreluRbm(int visibleStatesCount, int hiddenStatesCount) : BinaryNreluRbm(visibleStatesCount, hiddenStatesCount) {
+		}
+
+		RestrictedBoltzmannMachineBase* ReluNreluRbm::Clone(void) {
+			ReluNreluRbm *rbm = new ReluNreluRbm(_visibleStatesCount, _hiddenStatesCount);
+			rbm->EnableTransposedWeights(_transposedWeights != 0);
+			CopyParametersTo(rbm);
+			return rbm;
+		}
+
+		void ReluNreluRbm::CalculateVisibleEnergies(const float *visibleStatesBatch, const float *visibleBias, float *energies, int batchSize) {
+			DispatchFor(batchSize, _visibleStatesCount, 2*sizeof(float),
+			[=](const blocked_range<size_t>& r)
+			{
+				for (int b = r.begin(); b < r.end(); b++) {
+					const float *visibleStates = visibleStatesBatch + (size_t)b*_visibleStatesCount;
+					float energy = 0.0f;
+					for (int i = 0; i < _visibleStatesCount; i++) {
+						float deviation = visibleStates[i] - visibleBias[i];
+						energy += 0.5f*deviation*deviation;
+					}
+					energies[b] = energy;
+				}
+			});
+		}
+
+		float ReluNreluRbm::CalculateIndependentLogPartitionFunction(const float *visibleBias) {
+			// A unit variance Gaussian cut at zero integrates to sqrt(2*pi)*Phi(b).
+			float logPartitionFunction = 0.5f*_visibleStatesCount*logf(6.28318530718f);
+			for (int i = 0; i < _visibleStatesCount; i++) {
+				logPartitionFunction += logf(0.5f*erfcf(-0.707106781186547524f*visibleBias[i]));
+			}
+			return logPartitionFunction + _hiddenStatesCount*logf(2.0f);
+		}
+
+		void ReluNreluRbm::VisibleLayerSampling(void) {
+			_random->RectifiedNormal(_visibleStates, _visibleStatesCount);
+		}
+
+		void ReluNreluRbm::VisibleLayerSampling(float *visibleStatesBatch, int batchSize) {
+			_random->RectifiedNormal(visibleStatesBatch, batchSize*_visibleStatesCount);
+		}
+
+		void ReluNreluRbm::VisibleLayerActivation(float *visibleStatesBatch, int batchSize) {
+		}
+	}
+}
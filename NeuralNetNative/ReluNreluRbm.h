@@ -0,0 +1,23 @@
+#pragma once
+
+#include "ExportDll.h"
+#include "BinaryNreluRbm.h"
+
+namespace NeuralNetNative {
+	namespace RestrictedBoltzmannMachine {
+		// Noisy rectified linear units on both layers. The visible activity is the linear mean and
+		// visible sampling draws max(0, mean + N(0, 1)), so the visible energy is that of unit variance
+		// Gaussian units restricted to non-negative states.
+		class NEURALNETNATIVE_EXPORT ReluNreluRbm : public BinaryNreluRbm {
+		public:
+			ReluNreluRbm(int visibleStatesCount, int hiddenStatesCount);
+			virtual RestrictedBoltzmannMachineBase* Clone(void);
+			virtual void CalculateVisibleEnergies(const float *visibleStatesBatch, const float *visibleBias, float *energies, int batchSize);
+			virtual float CalculateIndependentLogPartitionFunction(const float *visibleBias);
+			virtual void VisibleLayerSampling(void);
+			virtual void VisibleLayerSampling(float *visibleStatesBatch, int batchSize);
+		protected:
+			virtual void VisibleLayerActivation(float *visibleStatesBatch, int batchSize);
+		};
+	}
+}
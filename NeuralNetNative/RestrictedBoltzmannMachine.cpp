@@ -1,12 +1,13 @@
 #define NEURALNETNATIVEAPI
-#include <mathimf.h>
+#include "Platform.h"
 #include <immintrin.h>
 #include "RestrictedBoltzmannMachine.h"
-#include "malloc.h"
-#include <tbb\tbb.h>
-#include <tbb\task_scheduler_init.h>
-#include <tbb\parallel_for.h>
-#include <tbb\blocked_range.h>
+#include "ExecutionContext.h"
+#include "MatrixKernels.h"
+#include "ParallelDispatch.h"
+#include <tbb/tbb.h>
+#include <tbb/parallel_for.h>
+#include <tbb/blocked_range.h>
 #include <algorithm>
 
 using namespace tbb;
@@ -14,8 +15,7 @@ using namespace tbb;
 namespace NeuralNetNative {
 	namespace RestrictedBoltzmannMachine {
 		RestrictedBoltzmannMachineBase::RestrictedBoltzmannMachineBase(int visibleStatesCount, int hiddenStatesCount) {
-			_randomDevice = new std::mt19937();
-			_uniformDistribution = new std::uniform_real_distribution<float>(0.0f, 1.0f);
+			_random = new PhiloxRandom(0, 0);
 			_visibleStatesCount = visibleStatesCount;
 			_hiddenStatesCount = hiddenStatesCount;
 			_visibleStates = (float*)_mm_malloc(_visibleStatesCount*sizeof(float), 32);
@@ -23,31 +23,141 @@ namespace NeuralNetNative {
 			_hiddenStates = (float*)_mm_malloc(_hiddenStatesCount*sizeof(float), 32);
 			_hiddenStatesBias = (float*)_mm_malloc(_hiddenStatesCount*sizeof(float), 32);
 			_weights = (float*)_mm_malloc(_visibleStatesCount*_hiddenStatesCount*sizeof(float), 32);
+			_transposedWeights = 0;
 		}
 
 		RestrictedBoltzmannMachineBase::~RestrictedBoltzmannMachineBase() {
-			delete _randomDevice;
-			delete _uniformDistribution;
+			delete _random;
 
 			_mm_free(_visibleStates);
 			_mm_free(_visibleStatesBias);
 			_mm_free(_hiddenStates);
 			_mm_free(_hiddenStatesBias);
 			_mm_free(_weights);
+			EnableTransposedWeights(false);
 		}
 		
-		void RestrictedBoltzmannMachineBase::VisibleLayerSampling(void) {
-			for (int i = 0; i < _visibleStatesCount; i++) {
-				_visibleStates[i] = (float) islessf((*_uniformDistribution)(*_randomDevice), _visibleStates[i]);
+		void RestrictedBoltzmannMachineBase::HiddenLayerCalculateActivity(const float *visibleStatesBatch, float *hiddenStatesBatch, int batchSize) {
+			for (int b = 0; b < batchSize; b++) {
+				HiddenLayerCalculateActivity(visibleStatesBatch + (size_t)b*_visibleStatesCount);
+				HiddenLayerCopyTo(hiddenStatesBatch + (size_t)b*_hiddenStatesCount);
 			}
 		}
 
-		void RestrictedBoltzmannMachineBase::HiddenLayerSampling(void) {
-			for (int i = 0; i < _hiddenStatesCount; i++) {
-				_hiddenStates[i] = (float) islessf((*_uniformDistribution)(*_randomDevice), _hiddenStates[i]);
+		void RestrictedBoltzmannMachineBase::VisibleLayerCalculateActivity(const float *hiddenStatesBatch, float *visibleStatesBatch, int batchSize) {
+			for (int b = 0; b < batchSize; b++) {
+				const float *hiddenStates = hiddenStatesBatch + (size_t)b*_hiddenStatesCount;
+				std::copy(hiddenStates, hiddenStates + _hiddenStatesCount, _hiddenStates);
+				VisibleLayerCalculateActivity();
+				VisibleLayerCopyTo(visibleStatesBatch + (size_t)b*_visibleStatesCount);
+			}
+		}
+
+		void RestrictedBoltzmannMachineBase::HiddenLayerCalculateActivity(const PackedStates &visibleStatesBatch, float *hiddenStatesBatch, int batchSize) {
+			float *visibleStates = (float*)_mm_malloc((size_t)batchSize*_visibleStatesCount*sizeof(float), 32);
+			visibleStatesBatch.Unpack(visibleStates, batchSize);
+			HiddenLayerCalculateActivity(visibleStates, hiddenStatesBatch, batchSize);
+			_mm_free(visibleStates);
+		}
+
+		void RestrictedBoltzmannMachineBase::VisibleLayerCalculateActivity(const PackedStates &hiddenStatesBatch, float *visibleStatesBatch, int batchSize) {
+			float *hiddenStates = (float*)_mm_malloc((size_t)batchSize*_hiddenStatesCount*sizeof(float), 32);
+			hiddenStatesBatch.Unpack(hiddenStates, batchSize);
+			VisibleLayerCalculateActivity(hiddenStates, visibleStatesBatch, batchSize);
+			_mm_free(hiddenStates);
+		}
+
+		void RestrictedBoltzmannMachineBase::HiddenLayerCalculateActivity(const float *visibleStatesBatch, float *hiddenStatesBatch, int batchSize,
+		                                                                  const float *inverseTemperatures) {
+			HiddenLayerCalculatePotentials(visibleStatesBatch, hiddenStatesBatch, batchSize);
+			MatrixKernels::ScaleRows(hiddenStatesBatch, inverseTemperatures, batchSize, _hiddenStatesCount);
+			HiddenLayerActivation(hiddenStatesBatch, batchSize);
+		}
+
+		void RestrictedBoltzmannMachineBase::HiddenLayerActivation(float *hiddenStatesBatch, int batchSize) {
+			MatrixKernels::Sigmoid(hiddenStatesBatch, batchSize*_hiddenStatesCount);
+		}
+
+		void RestrictedBoltzmannMachineBase::HiddenLayerCalculatePotentials(const float *visibleStatesBatch, float *hiddenStatesBatch, int batchSize) {
+			if (_transposedWeights != 0) {
+				MatrixKernels::Multiply(visibleStatesBatch, _transposedWeights, _hiddenStatesBias, hiddenStatesBatch,
+				                        batchSize, _hiddenStatesCount, _visibleStatesCount);
+			}
+			else {
+				MatrixKernels::MultiplyTransposed(visibleStatesBatch, _weights, _hiddenStatesBias, hiddenStatesBatch,
+				                                  batchSize, _hiddenStatesCount, _visibleStatesCount);
 			}
 		}
 
+		void RestrictedBoltzmannMachineBase::CalculateEnergies(const float *visibleStatesBatch, const float *hiddenStatesBatch,
+		                                                       float *energies, int batchSize) {
+			float *potentials = (float*)_mm_malloc((size_t)batchSize*_hiddenStatesCount*sizeof(float), 32);
+			CalculateVisibleEnergies(visibleStatesBatch, _visibleStatesBias, energies, batchSize);
+			HiddenLayerCalculatePotentials(visibleStatesBatch, potentials, batchSize);
+			DispatchFor(batchSize, _hiddenStatesCount, 2*sizeof(float),
+			[=](const blocked_range<size_t>& r)
+			{
+				for (int b = r.begin(); b < r.end(); b++) {
+					const float *hiddenStates = hiddenStatesBatch + (size_t)b*_hiddenStatesCount;
+					const float *hiddenPotentials = potentials + (size_t)b*_hiddenStatesCount;
+					float energy = 0.0f;
+					for (int j = 0; j < _hiddenStatesCount; j++) {
+						energy -= hiddenStates[j]*hiddenPotentials[j];
+					}
+					energies[b] += energy;
+				}
+			});
+			_mm_free(potentials);
+		}
+
+		void RestrictedBoltzmannMachineBase::CalculateFreeEnergies(const float *visibleStatesBatch, float *freeEnergies, int batchSize) {
+			float *potentials = (float*)_mm_malloc((size_t)batchSize*_hiddenStatesCount*sizeof(float), 32);
+			CalculateVisibleEnergies(visibleStatesBatch, _visibleStatesBias, freeEnergies, batchSize);
+			HiddenLayerCalculatePotentials(visibleStatesBatch, potentials, batchSize);
+			MatrixKernels::AddSoftplusRowSums(potentials, 1.0f, -1.0f, freeEnergies, batchSize, _hiddenStatesCount);
+			_mm_free(potentials);
+		}
+
+		void RestrictedBoltzmannMachineBase::VisibleLayerSampling(float *visibleStatesBatch, int batchSize) {
+			StatesSampling(visibleStatesBatch, batchSize*_visibleStatesCount);
+		}
+
+		void RestrictedBoltzmannMachineBase::HiddenLayerSampling(float *hiddenStatesBatch, int batchSize) {
+			StatesSampling(hiddenStatesBatch, batchSize*_hiddenStatesCount);
+		}
+
+		void RestrictedBoltzmannMachineBase::VisibleLayerSampling(void) {
+			StatesSampling(_visibleStates, _visibleStatesCount);
+		}
+
+		void RestrictedBoltzmannMachineBase::HiddenLayerSampling(void) {
+			StatesSampling(_hiddenStates, _hiddenStatesCount);
+		}
+
+		bool RestrictedBoltzmannMachineBase::SupportsPackedStates(void) const {
+			return false;
+		}
+
+		void RestrictedBoltzmannMachineBase::VisibleLayerSampling(const float *visibleStatesBatch, PackedStates &states, int batchSize) {
+			_random->Bernoulli(visibleStatesBatch, batchSize, _visibleStatesCount, states.GetWords(), states.GetWordsPerRow());
+		}
+
+		void RestrictedBoltzmannMachineBase::HiddenLayerSampling(const float *hiddenStatesBatch, PackedStates &states, int batchSize) {
+			_random->Bernoulli(hiddenStatesBatch, batchSize, _hiddenStatesCount, states.GetWords(), states.GetWordsPerRow());
+		}
+
+		void RestrictedBoltzmannMachineBase::StatesSampling(float *states, int statesCount) {
+			_random->Bernoulli(states, statesCount);
+		}
+
+		void RestrictedBoltzmannMachineBase::SetRandomStream(unsigned long long seed, unsigned long long stream) {
+			_random->Reset(seed, stream);
+		}
+
+		PhiloxRandom* RestrictedBoltzmannMachineBase::GetRandom(void) {
+			return _random;
+		}
+
 		void RestrictedBoltzmannMachineBase::VisibleLayerCopyTo(float *target) {
             std::copy(_visibleStates, _visibleStates + _visibleStatesCount, target);
 		}
@@ -57,11 +167,46 @@ namespace NeuralNetNative {
 		}
 		
 		void RestrictedBoltzmannMachineBase::Predict(const float *input, float *output) {
-			HiddenLayerCalculateActivity(input);
-			HiddenLayerSampling();
-			VisibleLayerCalculateActivity();
-			VisibleLayerSampling();
-            VisibleLayerCopyTo(output);
+			ExecutionContext::ExecuteIn(_executionContext, [=]() {
+				HiddenLayerCalculateActivity(input);
+				HiddenLayerSampling();
+				VisibleLayerCalculateActivity();
+				VisibleLayerSampling();
+				VisibleLayerCopyTo(output);
+			});
+		}
+
+		void RestrictedBoltzmannMachineBase::CopyParametersTo(RestrictedBoltzmannMachineBase *target) {
+			std::copy(_weights, _weights + _visibleStatesCount*_hiddenStatesCount, target->_weights);
+			std::copy(_visibleStatesBias, _visibleStatesBias + _visibleStatesCount, target->_visibleStatesBias);
+			std::copy(_hiddenStatesBias, _hiddenStatesBias + _hiddenStatesCount, target->_hiddenStatesBias);
+			if ((target->_transposedWeights != 0) && (_transposedWeights != 0)) {
+				std::copy(_transposedWeights, _transposedWeights + _visibleStatesCount*_hiddenStatesCount, target->_transposedWeights);
+			}
+			else {
+				target->RefreshTransposedWeights();
+			}
+		}
+
+		void RestrictedBoltzmannMachineBase::EnableTransposedWeights(bool enabled) {
+			if (enabled && (_transposedWeights == 0)) {
+				_transposedWeights = (float*)_mm_malloc(_visibleStatesCount*_hiddenStatesCount*sizeof(float), 32);
+				RefreshTransposedWeights();
+			}
+			else if (!enabled && (_transposedWeights != 0)) {
+				_mm_free(_transposedWeights);
+				_transposedWeights = 0;
+			}
+		}
+
+		void RestrictedBoltzmannMachineBase::RefreshTransposedWeights(void) {
+			if (_transposedWeights != 0) {
+				MatrixKernels::Transpose(_weights, _transposedWeights, _hiddenStatesCount, _visibleStatesCount);
+			}
+		}
+
+		float* RestrictedBoltzmannMachineBase::GetTransposedWeights(void) {
+			return _transposedWeights;
 		}
 
 		int RestrictedBoltzmannMachineBase::GetVisibleStatesCount(void) {
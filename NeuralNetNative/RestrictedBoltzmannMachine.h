@@ -2,14 +2,22 @@
 
 #include "ExportDll.h"
 #include "NeuralNet.h"
-#include <random>
+#include "PhiloxRandom.h"
+#include "PackedStates.h"
 
 namespace NeuralNetNative {
 	namespace RestrictedBoltzmannMachine {
+		// Weights and biases used in place of the machine's own, e.g. regular plus fast weights of FPCD.
+		struct RbmParameters {
+		public:
+			const float *Weights;
+			const float *VisibleStatesBias;
+			const float *HiddenStatesBias;
+		};
+
 		class NEURALNETNATIVE_EXPORT RestrictedBoltzmannMachineBase : public NeuralNet {
 		protected:
-			std::mt19937 *_randomDevice;
-			std::uniform_real_distribution<float> *_uniformDistribution;
+			PhiloxRandom *_random;
 			int _visibleStatesCount;
 			int _hiddenStatesCount;
 			float *_visibleStates;
@@ -17,20 +25,61 @@ namespace NeuralNetNative {
 			float *_weights;
 			float *_visibleStatesBias;
 			float *_hiddenStatesBias;
+			float *_transposedWeights;
 		public:
 			RestrictedBoltzmannMachineBase(int visibleStatesCount, int hiddenStatesCount);
-			~RestrictedBoltzmannMachineBase(void);
+			virtual ~RestrictedBoltzmannMachineBase(void);
+			virtual RestrictedBoltzmannMachineBase* Clone(void) = 0;
 			virtual void VisibleLayerCalculateActivity(void) = 0;
 			virtual void HiddenLayerCalculateActivity(void) = 0;
 			virtual void HiddenLayerCalculateActivity(const float *newVisibleState) = 0;
 			virtual void VisibleLayerCalculateActivity(const float *addedWeight, const float *addedVisibleBias) = 0;
 			virtual void HiddenLayerCalculateActivity(const float *addedWeight, const float *addedHiddenBias) = 0;
 			virtual void HiddenLayerCalculateActivity(const float *newVisibleState, const float *addedWeight, const float *addedHiddenBias) = 0;
+			virtual void HiddenLayerCalculateActivity(const float *newVisibleState, const RbmParameters &parameters) = 0;
+			virtual void VisibleLayerCalculateActivity(const RbmParameters &parameters) = 0;
+			virtual void HiddenLayerCalculateActivity(const float *visibleStatesBatch, float *hiddenStatesBatch, int batchSize);
+			virtual void VisibleLayerCalculateActivity(const float *hiddenStatesBatch, float *visibleStatesBatch, int batchSize);
+			virtual void HiddenLayerCalculateActivity(const float *visibleStatesBatch, float *hiddenStatesBatch, int batchSize,
+			                                          const RbmParameters &parameters) = 0;
+			virtual void VisibleLayerCalculateActivity(const float *hiddenStatesBatch, float *visibleStatesBatch, int batchSize,
+			                                           const RbmParameters &parameters) = 0;
+			// Tempered chains: the energy of row b is multiplied by inverseTemperatures[b].
+			virtual void HiddenLayerCalculateActivity(const float *visibleStatesBatch, float *hiddenStatesBatch, int batchSize,
+			                                          const float *inverseTemperatures);
+			virtual void VisibleLayerCalculateActivity(const float *hiddenStatesBatch, float *visibleStatesBatch, int batchSize,
+			                                           const float *inverseTemperatures) = 0;
+			// Batches whose input layer is given as bits, see SupportsPackedStates. The defaults unpack them.
+			virtual void HiddenLayerCalculateActivity(const PackedStates &visibleStatesBatch, float *hiddenStatesBatch, int batchSize);
+			virtual void VisibleLayerCalculateActivity(const PackedStates &hiddenStatesBatch, float *visibleStatesBatch, int batchSize);
+			// Batched W*v + c, the argument of the hidden activation.
+			void HiddenLayerCalculatePotentials(const float *visibleStatesBatch, float *hiddenStatesBatch, int batchSize);
+			// energies[b] = E(v_b, h_b) of batchSize visible and hidden state rows.
+			void CalculateEnergies(const float *visibleStatesBatch, const float *hiddenStatesBatch, float *energies, int batchSize);
+			// freeEnergies[b] = F(v_b) = -log(sum over h of exp(-E(v_b, h))).
+			void CalculateFreeEnergies(const float *visibleStatesBatch, float *freeEnergies, int batchSize);
+			// The part of the energy that depends on the visible states only, with the given visible bias.
+			virtual void CalculateVisibleEnergies(const float *visibleStatesBatch, const float *visibleBias, float *energies, int batchSize) = 0;
+			// log Z of the machine with zero weights and hidden bias and the given visible bias.
+			virtual float CalculateIndependentLogPartitionFunction(const float *visibleBias) = 0;
 			virtual void VisibleLayerSampling(void);
 			virtual void HiddenLayerSampling(void);
+			virtual void VisibleLayerSampling(float *visibleStatesBatch, int batchSize);
+			virtual void HiddenLayerSampling(float *hiddenStatesBatch, int batchSize);
+			// Both layers are binary, so sampled states can be kept as PackedStates bits.
+			virtual bool SupportsPackedStates(void) const;
+			// Samples batchSize rows of probabilities into the rows of the packed states.
+			void VisibleLayerSampling(const float *visibleStatesBatch, PackedStates &states, int batchSize);
+			void HiddenLayerSampling(const float *hiddenStatesBatch, PackedStates &states, int batchSize);
+			void StatesSampling(float *states, int statesCount);
+			// Sampling draws from a counter-based stream, so machines seeded with the same seed and
+			// different streams (e.g. one per chain) stay independent and reproducible.
+			void SetRandomStream(unsigned long long seed, unsigned long long stream);
+			PhiloxRandom* GetRandom(void);
 			void VisibleLayerCopyTo(float *target);
 			void HiddenLayerCopyTo(float *target);
 			void Predict(const float *input, float *output);
+			void CopyParametersTo(RestrictedBoltzmannMachineBase *target);
 			int GetVisibleStatesCount(void);
 			int GetHiddenStatesCount(void);
 			float* GetWeights(void);
@@ -38,6 +87,15 @@ namespace NeuralNetNative {
 			float* GetHiddenStatesBias(void);
 			float* GetVisibleStates(void);
 			float* GetHiddenStates(void);
+			// Keeps a [visible x hidden] copy of the weights so that passes which read the weights
+			// column-wise can stream them row by row. The copy is refreshed by the train methods after
+			// every update; call RefreshTransposedWeights after changing the weights directly.
+			void EnableTransposedWeights(bool enabled);
+			void RefreshTransposedWeights(void);
+			float* GetTransposedWeights(void);
+		protected:
+			// Turns batchSize rows of hidden potentials into the hidden activities in place.
+			virtual void HiddenLayerActivation(float *hiddenStatesBatch, int batchSize);
 		private:
 			void SetOutput(float *output);
 		};
@@ -1,7 +1,10 @@
 #define NEURALNETNATIVEAPI
 #include "RestrictedBoltzmannMachineFactory.h"
 #include "BinaryBinaryRbm.h"
+#include "BinaryNreluRbm.h"
 #include "GaussianBinaryRbm.h"
+#include "GaussianNreluRbm.h"
+#include "ReluNreluRbm.h"
 #include <random>
 
 namespace NeuralNetNative {
@@ -69,16 +72,16 @@ namespace NeuralNetNative {
 					rbm = new BinaryBinaryRbm(_visibleStatesCount, _hiddenStatesCount);
 					break;
 				case RbmType::BinaryNrelu:
-					//rbm = new BinaryNreluRbm(_visibleStatesCount, _hiddenStatesCount);
+					rbm = new BinaryNreluRbm(_visibleStatesCount, _hiddenStatesCount);
 					break;
 				case RbmType::GaussianBinary:
 					rbm = new GaussianBinaryRbm(_visibleStatesCount, _hiddenStatesCount);
 					break;
 				case RbmType::GaussianNrelu:
-					//rbm = new GaussianNreluRbm(_visibleStatesCount, _hiddenStatesCount);
+					rbm = new GaussianNreluRbm(_visibleStatesCount, _hiddenStatesCount);
 					break;
 				case RbmType::ReluNrelu:
-					//rbm = new ReluNreluRbm(_visibleStatesCount, _hiddenStatesCount);
+					rbm = new ReluNreluRbm(_visibleStatesCount, _hiddenStatesCount);
 					break;
 			}
 			return rbm;
@@ -1,11 +1,10 @@
 #define NEURALNETNATIVEAPI
-#include <mathimf.h>
+#include "Platform.h"
 #include "SigmoidFunction.h"
-#include <tbb\tbb.h>
-#include <tbb\task_scheduler_init.h>
-#include <tbb\parallel_for.h>
-#include <tbb\blocked_range.h>
-#include "GrainSizeForParallel.h"
+#include <tbb/tbb.h>
+#include <tbb/parallel_for.h>
+#include <tbb/blocked_range.h>
+#include "ParallelDispatch.h"
 
 using namespace tbb;
 
@@ -28,7 +27,7 @@ namespace NeuralNetNative {
 	}
 
 	void SigmoidFunction::CalculateFirstDerivative(float* target, const float* factors, const float* state, int stateLength) {
-		parallel_for(blocked_range<size_t>(0, stateLength, SigmoidFunctionGrainSize),
+		DispatchFor(stateLength, 1, 3*sizeof(float),
 		[=](const blocked_range<size_t>& r)
 		{
 			for (int i = r.begin(); i < r.end(); i++) {
@@ -38,7 +37,7 @@ namespace NeuralNetNative {
 	}
 
 	void SigmoidFunction::CalculateFirstDerivative(float* target, const float* state, int stateLength) {
-		parallel_for(blocked_range<size_t>(0, stateLength, SigmoidFunctionGrainSize),
+		DispatchFor(stateLength, 1, 2*sizeof(float),
 		[=](const blocked_range<size_t>& r)
 		{
 			for (int i = r.begin(); i < r.end(); i++) {
@@ -1,10 +1,9 @@
 #define NEURALNETNATIVEAPI
 #include "SimpleNeuronBlock.h"
-#include <tbb\tbb.h>
-#include <tbb\task_scheduler_init.h>
-#include <tbb\parallel_for.h>
-#include <tbb\blocked_range.h>
-#include "GrainSizeForParallel.h"
+#include <tbb/tbb.h>
+#include <tbb/parallel_for.h>
+#include <tbb/blocked_range.h>
+#include "ParallelDispatch.h"
 
 using namespace tbb;
 
@@ -19,14 +18,15 @@ namespace NeuralNetNative {
 		float *parentState = Parent->GetState();
 		int parentSize = Parent->GetSize();
 		
-		parallel_for(blocked_range<size_t>(0, Size, SimpleNeuronBlockGrainSize),
+		DispatchFor(Size, parentSize, sizeof(float),
 		[=](const blocked_range<size_t>& r)
 		{
+			const float *weights = GetReadWeights();
 			for (int neuronNum = r.begin(); neuronNum < r.end(); neuronNum++) {
 				float sum = 0.0f;
 				#pragma simd
 				for (int i = 0; i < parentSize; i++) {
-					sum += parentState[i]*Weights[neuronNum*parentSize + i];
+					sum += parentState[i]*weights[neuronNum*parentSize + i];
 				}
 				Net[neuronNum] = sum + Bias[neuronNum];
 				State[neuronNum] = Function->Calculate(sum);
@@ -35,18 +35,25 @@ namespace NeuralNetNative {
 	}
 
 	void SimpleNeuronBlock::Calculate(const float *input) {
-		parallel_for(blocked_range<size_t>(0, Size, SimpleNeuronBlockGrainSize),
+		DispatchFor(Size, PreviousSize, sizeof(float),
 		[=](const blocked_range<size_t>& r)
 		{
+			const float *weights = GetReadWeights();
 			for (int neuronNum = r.begin(); neuronNum < r.end(); neuronNum++) {
 				float sum = 0.0f;
 				#pragma simd
 				for (int i = 0; i < PreviousSize; i++) {
-					sum += input[i]*Weights[neuronNum*PreviousSize + i];
+					sum += input[i]*weights[neuronNum*PreviousSize + i];
 				}
 				Net[neuronNum] = sum + Bias[neuronNum];
 				State[neuronNum] = Function->Calculate(sum);
 			}
 		});
 	}
+
+	BaseNeuralBlock* SimpleNeuronBlock::Clone(BaseNeuralBlock *parent) {
+		BaseNeuralBlock *block = (parent != 0) ? new SimpleNeuronBlock(Size, parent, Function) : new SimpleNeuronBlock(Size, PreviousSize, Function);
+		CopyParametersTo(block);
+		return block;
+	}
 }
\ No newline at end of file
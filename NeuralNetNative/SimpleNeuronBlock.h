@@ -10,5 +10,6 @@ namespace NeuralNetNative {
 		SimpleNeuronBlock(int size, int parentSize, ActivationFunction *function);
 		void Calculate(void);
 		virtual void Calculate(const float *input);
+		virtual BaseNeuralBlock* Clone(BaseNeuralBlock *parent);
 	};
 }
\ No newline at end of file
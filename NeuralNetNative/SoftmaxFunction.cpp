@@ -1,11 +1,9 @@
 #define NEURALNETNATIVEAPI
-#include <mathimf.h>
+#include "Platform.h"
 #include "SoftmaxFunction.h"
-#include <tbb\tbb.h>
-#include <tbb\task_scheduler_init.h>
-#include <tbb\parallel_for.h>
-#include <tbb\blocked_range.h>
-#include "GrainSizeForParallel.h"
+#include <tbb/tbb.h>
+#include <tbb/parallel_for.h>
+#include <tbb/blocked_range.h>
 
 using namespace tbb;
 
@@ -27,7 +25,7 @@ namespace NeuralNetNative {
 	}
 
 	void SoftmaxFunction::CalculateFirstDerivative(float* target, const float* factors, const float* state, int stateLength) {
-		/*parallel_for(blocked_range<size_t>(0, stateLength, SoftmaxFunctionGrainSize),
+		/*parallel_for(blocked_range<size_t>(0, stateLength),
 		[=](const blocked_range<size_t>& r)
 		{
 			for (int i = r.begin(); i < r.end(); i++) {
@@ -40,7 +38,7 @@ namespace NeuralNetNative {
 	}
 
 	void SoftmaxFunction::CalculateFirstDerivative(float* target, const float* state, int stateLength) {
-		/*parallel_for(blocked_range<size_t>(0, stateLength, SoftmaxFunctionGrainSize),
+		/*parallel_for(blocked_range<size_t>(0, stateLength),
 		[=](const blocked_range<size_t>& r)
 		{
 			for (int i = r.begin(); i < r.end(); i++) {
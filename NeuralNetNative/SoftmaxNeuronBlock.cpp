@@ -1,11 +1,10 @@
 #define NEURALNETNATIVEAPI
-#include <mathimf.h>
+#include "Platform.h"
 #include "SoftmaxNeuronBlock.h"
-#include <tbb\tbb.h>
-#include <tbb\task_scheduler_init.h>
-#include <tbb\parallel_reduce.h>
-#include <tbb\blocked_range.h>
-#include "GrainSizeForParallel.h"
+#include <tbb/tbb.h>
+#include <tbb/parallel_reduce.h>
+#include <tbb/blocked_range.h>
+#include "ParallelDispatch.h"
 
 using namespace tbb;
 
@@ -19,15 +18,16 @@ namespace NeuralNetNative {
 	void SoftmaxSimpleNeuronBlock::Calculate(void) {
 		float *parentState = Parent->GetState();
 		int parentSize = Parent->GetSize();
-		float expSum = parallel_reduce(blocked_range<size_t>(0, Size, SoftmaxNeuronBlockGrainSize), 
+		float expSum = DispatchReduce(Size, parentSize, sizeof(float),
 			0.0f, 
 			[=](const blocked_range<size_t>& r, float sum)->float 
 			{
+				const float *weights = GetReadWeights();
 				for (int neuronNum = r.begin(); neuronNum < r.end(); neuronNum++) {
 					float inductionSum = 0.0f;
 					#pragma simd
 					for (int i = 0; i < parentSize; i++) {
-						inductionSum += parentState[i]*Weights[neuronNum*parentSize + i];
+						inductionSum += parentState[i]*weights[neuronNum*parentSize + i];
 					}
 					inductionSum += Bias[neuronNum];
 					Net[neuronNum] = inductionSum;
@@ -49,15 +49,16 @@ namespace NeuralNetNative {
 	}
 
 	void SoftmaxSimpleNeuronBlock::Calculate(const float *input) {
-		float expSum = parallel_reduce(blocked_range<size_t>(0, Size, SoftmaxNeuronBlockGrainSize), 
+		float expSum = DispatchReduce(Size, PreviousSize, sizeof(float),
 			0.0f, 
 			[=](const blocked_range<size_t>& r, float sum)->float 
 			{
-				for (int neuronNum = 0; neuronNum < Size; neuronNum++) {
+				const float *weights = GetReadWeights();
+				for (int neuronNum = r.begin(); neuronNum < r.end(); neuronNum++) {
 					float inductionSum = 0.0f;
 					#pragma simd
 					for (int i = 0; i < PreviousSize; i++) {
-						inductionSum += input[i]*Weights[neuronNum*PreviousSize + i];
+						inductionSum += input[i]*weights[neuronNum*PreviousSize + i];
 					}
 					inductionSum += Bias[neuronNum];
 					Net[neuronNum] = inductionSum;
@@ -77,4 +78,10 @@ namespace NeuralNetNative {
 			State[neuronNum] = State[neuronNum]/expSum;
 		}
 	}
+
+	BaseNeuralBlock* SoftmaxSimpleNeuronBlock::Clone(BaseNeuralBlock *parent) {
+		BaseNeuralBlock *block = (parent != 0) ? new SoftmaxSimpleNeuronBlock(Size, parent, Function) : new SoftmaxSimpleNeuronBlock(Size, PreviousSize, Function);
+		CopyParametersTo(block);
+		return block;
+	}
 }
\ No newline at end of file
@@ -10,5 +10,6 @@ namespace NeuralNetNative {
 		SoftmaxSimpleNeuronBlock(int size, int parentSize, ActivationFunction *function);
 		virtual void Calculate(void);
 		virtual void Calculate(const float *input);
+		virtual BaseNeuralBlock* Clone(BaseNeuralBlock *parent);
 	};
 }
\ No newline at end of file
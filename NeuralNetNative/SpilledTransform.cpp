@@ -0,0 +1,50 @@
+#define NEURALNETNATIVEAPI
+#include "SpilledTransform.h"
+#include <algorithm>
+#include <functional>
+
+namespace NeuralNetNative {
+	SpilledTransform::SpilledTransform(StandardTypesNative::TrainSingle *const *samples, int samplesCount) {
+		// Rows are stored in the order of the sorted sample pointers, so a lookup is a binary search
+		// and a sample that is both in the train and the test data is stored once.
+		_samples = new StandardTypesNative::TrainSingle*[samplesCount];
+		std::copy(samples, samples + samplesCount, _samples);
+		std::sort(_samples, _samples + samplesCount, std::less<const StandardTypesNative::TrainSingle*>());
+		_samplesCount = (int)(std::unique(_samples, _samples + samplesCount) - _samples);
+		_rows = 0;
+	}
+
+	SpilledTransform* SpilledTransform::Create(const DataTransform *source, StandardTypesNative::TrainSingle *const *samples,
+	                                           int samplesCount, int batchSize, const char *directory) {
+		SpilledTransform *transform = new SpilledTransform(samples, samplesCount);
+		transform->_rows = MemoryMappedMatrix::Create(directory, transform->_samplesCount, source->GetOutputLength());
+		if (transform->_rows == 0) {
+			delete transform;
+			return 0;
+		}
+		for (int first = 0; first < transform->_samplesCount; first += batchSize) {
+			int count = std::min(batchSize, transform->_samplesCount - first);
+			source->Transform(transform->_samples + first, count, transform->_rows->GetRow(first));
+		}
+		return transform;
+	}
+
+	SpilledTransform::~SpilledTransform(void) {
+		delete[] _samples;
+		delete _rows;
+	}
+
+	int SpilledTransform::GetOutputLength(void) const {
+		return _rows->GetColumnsCount();
+	}
+
+	void SpilledTransform::Transform(StandardTypesNative::TrainSingle *const *samples, int count, float *outputBatch) const {
+		int length = GetOutputLength();
+		for (int b = 0; b < count; b++) {
+			int row = (int)(std::lower_bound(_samples, _samples + _samplesCount, samples[b],
+			                                   std::less<const StandardTypesNative::TrainSingle*>()) - _samples);
+			const float *values = _rows->GetRow(row);
+			std::copy(values, values + length, outputBatch + (size_t)b*length);
+		}
+	}
+}
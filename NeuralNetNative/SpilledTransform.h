@@ -0,0 +1,26 @@
+#pragma once
+
+#include "ExportDll.h"
+#include "DataTransform.h"
+#include "MemoryMappedMatrix.h"
+
+namespace NeuralNetNative {
+	// Runs the source transform once over a fixed set of samples and serves the rows from a
+	// memory-mapped file afterwards. Only samples of that set can be transformed.
+	class NEURALNETNATIVE_EXPORT SpilledTransform : public DataTransform {
+	private:
+		StandardTypesNative::TrainSingle **_samples;
+		int _samplesCount;
+		MemoryMappedMatrix *_rows;
+	public:
+		// The source is run over batchSize samples at a time and is not needed afterwards. Returns 0
+		// when the file cannot be created in the directory.
+		static SpilledTransform* Create(const DataTransform *source, StandardTypesNative::TrainSingle *const *samples,
+		                                int samplesCount, int batchSize, const char *directory);
+		virtual ~SpilledTransform(void);
+		virtual int GetOutputLength(void) const;
+		virtual void Transform(StandardTypesNative::TrainSingle *const *samples, int count, float *outputBatch) const;
+	private:
+		SpilledTransform(StandardTypesNative::TrainSingle *const *samples, int samplesCount);
+	};
+}
@@ -1,5 +1,5 @@
 #define NEURALNETNATIVEAPI
-#include <mathimf.h>
+#include "Platform.h"
 #include "SqrtReverseFactor.h"
 
 namespace NeuralNetNative {
@@ -3,18 +3,37 @@
 #include "Metrics.h"
 #include "Regularization.h"
 #include "LearnFactorStrategy.h"
+#include "NumaMemory.h"
 
 namespace NeuralNetNative {
+	class ExecutionContext;
+
 	struct TrainProperties {
 	public:
 		StandardTypesNative::Metrics *Metrics;
-		Regularization *Regularization;
+		NeuralNetNative::Regularization *Regularization;
 		float Epsilon;
 		int MaxIterationCount;
 		int PackageSize;
 		float CvLimit;
         int SkipCvLimitFirstIterations;
         float CvSlidingFactor;
+        bool AsyncTesting;
+        bool BatchTraining;
+        // Chains advanced by persistent methods in batch training; 0 runs one chain per package sample.
+        int PersistentChainsCount;
+        // RBM methods monitor the average free energy of this many first train samples and its gap to
+        // the test data instead of the reconstruction error; 0 keeps the reconstruction error.
+        int FreeEnergyTrainSamples;
+        // Machines with binary layers keep sampled hidden batches of batch training as bits, and the Hamming
+        // reconstruction error compares packed inputs (above one half) with packed reconstructions.
+        bool PackedStates;
+		// Arena of the training. The trained model keeps it for its own parallel work, such as sampling or
+		// feature extraction, so it has to outlive that use or be replaced with SetExecutionContext.
+		ExecutionContext *Context;
+        // Placement of the perceptron weights over NUMA nodes, and whether every node reads its own copy.
+        NumaPlacement WeightsPlacement;
+        bool WeightReplicas;
 		float BaseLearnSpeed;
 		float SpeedBonus;
 		float SpeedPenalty;
@@ -0,0 +1,226 @@
+#include "ClassificationTrainMethodNative.h"
+#include "ClassificationRbmFactory.h"
+#include "Callback.h"
+#include "malloc.h"
+
+namespace NeuralNetNativeWrapper {
+	namespace ClassificationRbmNativeWrapper {
+		ClassificationTrainMethodNative::ClassificationTrainMethodNative(IList<TrainPair^>^ trainData, IList<TrainPair^>^ testData) {
+			_nativeAlgorithm = 0;
+			_nativeNeuralNet = 0;
+			_nativeGradientFunction = 0;
+			_nativeTestData = 0;
+			_nativeTestDataSize = 0;
+			AllocateNativeTrainData(trainData);
+			if (testData != nullptr) {
+				AllocateNativeTestData(testData);
+			}
+		}
+
+		ClassificationTrainMethodNative::~ClassificationTrainMethodNative(void) {
+			DeleteNativeTrainData();
+			DeleteNativeTestData();
+			DeleteNativeNeuralNet();
+			DeleteNativeProperties();
+			DeleteNativeAlgorithm();
+			DeleteNativeGradientFunction();
+		}
+
+		void ClassificationTrainMethodNative::Start(void) {
+			if (_nativeAlgorithm != 0) {
+				_nativeAlgorithm->Start();
+				ApplyResult();
+				DeleteNativeNeuralNet();
+				DeleteNativeProperties();
+			}
+		}
+
+		void ClassificationTrainMethodNative::Stop(void) {
+			if (_nativeAlgorithm != 0) {
+				_nativeAlgorithm->Stop();
+			}
+		}
+
+		void ClassificationTrainMethodNative::SetNativeAlgorithm(NeuralNetNative::ClassificationRbm::ClassificationTrainMethod *nativeAlgorithm) {
+			_nativeAlgorithm = nativeAlgorithm;
+			_nativeAlgorithm->IterationCompleted = new TripleCallback(gcnew IterationCompletedCallback(this,
+                &ClassificationTrainMethodNative::IterationCompletedHandler));
+			_nativeAlgorithm->IterativeProcessFinished = new SingleCallback(gcnew IterativeProcessFinishedCallback(this,
+                &ClassificationTrainMethodNative::IterativeProcessFinishedHandler));
+		}
+
+		void ClassificationTrainMethodNative::ApplyResult(void) {
+			int inputsCount = _nativeNeuralNet->GetInputsCount();
+			int labelsCount = _nativeNeuralNet->GetLabelsCount();
+			int visibleStatesCount = _nativeNeuralNet->GetVisibleStatesCount();
+			int hiddenStatesCount = _nativeNeuralNet->GetHiddenStatesCount();
+
+			array<float>^ visibleStatesWeights = _classificationRbm->VisibleStatesWeights;
+			array<float>^ labelsWeights = _classificationRbm->LabelsWeights;
+			float *nativeWeights = _nativeNeuralNet->GetWeights();
+			for (int j = 0; j < hiddenStatesCount; j++) {
+				float *nativeRow = nativeWeights + j*visibleStatesCount;
+				for (int i = 0; i < inputsCount; i++) {
+					visibleStatesWeights[j*inputsCount + i] = nativeRow[i];
+				}
+				for (int k = 0; k < labelsCount; k++) {
+					labelsWeights[j*labelsCount + k] = nativeRow[inputsCount + k];
+				}
+			}
+
+			array<float>^ visibleStatesBias = _classificationRbm->VisibleStatesBias;
+			array<float>^ labelsBias = _classificationRbm->LabelsBias;
+			float *nativeVisibleStatesBias = _nativeNeuralNet->GetVisibleStatesBias();
+			for (int i = 0; i < inputsCount; i++) {
+				visibleStatesBias[i] = nativeVisibleStatesBias[i];
+			}
+			for (int k = 0; k < labelsCount; k++) {
+				labelsBias[k] = nativeVisibleStatesBias[inputsCount + k];
+			}
+
+			array<float>^ hiddenStatesBias = _classificationRbm->HiddenStatesBias;
+			float *nativeHiddenStatesBias = _nativeNeuralNet->GetHiddenStatesBias();
+			for (int j = 0; j < hiddenStatesCount; j++) {
+				hiddenStatesBias[j] = nativeHiddenStatesBias[j];
+			}
+		}
+
+		void ClassificationTrainMethodNative::CreateNativeNeuralNet(INeuralNet^ neuralNet) {
+			_classificationRbm = dynamic_cast<NeuralNet::ClassificationRbm::ClassificationRbm^>(neuralNet);
+
+			int inputsCount = _classificationRbm->VisibleStates->Length;
+			int hiddenStatesCount = _classificationRbm->HiddenStates->Length;
+			int labelsCount = _classificationRbm->Labels->Length;
+			NeuralNetNative::ClassificationRbm::ClassificationRbmFactory *nativeFactory =
+				new NeuralNetNative::ClassificationRbm::ClassificationRbmFactory(inputsCount, hiddenStatesCount, labelsCount,
+				NeuralNetNative::StartWeightGenerator::NullDistribution);
+			_nativeNeuralNet = (NeuralNetNative::ClassificationRbm::ClassificationRbm*)(nativeFactory->CreateNeuralNet());
+			delete nativeFactory;
+
+			int visibleStatesCount = _nativeNeuralNet->GetVisibleStatesCount();
+			array<float>^ visibleStatesWeights = _classificationRbm->VisibleStatesWeights;
+			array<float>^ labelsWeights = _classificationRbm->LabelsWeights;
+			float *nativeWeights = _nativeNeuralNet->GetWeights();
+			for (int j = 0; j < hiddenStatesCount; j++) {
+				float *nativeRow = nativeWeights + j*visibleStatesCount;
+				for (int i = 0; i < inputsCount; i++) {
+					nativeRow[i] = visibleStatesWeights[j*inputsCount + i];
+				}
+				for (int k = 0; k < labelsCount; k++) {
+					nativeRow[inputsCount + k] = labelsWeights[j*labelsCount + k];
+				}
+			}
+
+			array<float>^ visibleStatesBias = _classificationRbm->VisibleStatesBias;
+			array<float>^ labelsBias = _classificationRbm->LabelsBias;
+			float *nativeVisibleStatesBias = _nativeNeuralNet->GetVisibleStatesBias();
+			for (int i = 0; i < inputsCount; i++) {
+				nativeVisibleStatesBias[i] = visibleStatesBias[i];
+			}
+			for (int k = 0; k < labelsCount; k++) {
+				nativeVisibleStatesBias[inputsCount + k] = labelsBias[k];
+			}
+
+			array<float>^ hiddenStatesBias = _classificationRbm->HiddenStatesBias;
+			float *nativeHiddenStatesBias = _nativeNeuralNet->GetHiddenStatesBias();
+			for (int j = 0; j < hiddenStatesCount; j++) {
+				nativeHiddenStatesBias[j] = hiddenStatesBias[j];
+			}
+		}
+
+		void ClassificationTrainMethodNative::InitilazeNativeAlgorithm() {
+			_nativeAlgorithm->InitilazeMethod(_nativeNeuralNet, _nativeTrainProperties);
+		}
+
+		void ClassificationTrainMethodNative::AllocateNativeTrainData(IList<TrainPair^>^ trainData) {
+			_nativeTrainDataSize = trainData->Count;
+			_nativeTrainData = new StandardTypesNative::TrainPair*[_nativeTrainDataSize];
+			int inputSize = trainData[0]->InputLength;
+			int outputSize = trainData[0]->OutputLength;
+			for (int i = 0; i < _nativeTrainDataSize; i++) {
+				TrainPair^ data = trainData[i];
+
+				array<float>^ input = data->Input;
+				float *nativeInput = (float*)_mm_malloc(inputSize*sizeof(float), 32);
+				for (int j = 0; j < inputSize; j++) {
+					nativeInput[j] = input[j];
+				}
+
+				array<float>^ output = data->Output;
+				float *nativeOutput = (float*)_mm_malloc(outputSize*sizeof(float), 32);
+				for (int j = 0; j < outputSize; j++) {
+					nativeOutput[j] = output[j];
+				}
+
+				_nativeTrainData[i] = new StandardTypesNative::TrainPair(nativeInput, nativeOutput, inputSize, outputSize);
+			}
+		}
+
+		void ClassificationTrainMethodNative::AllocateNativeTestData(IList<TrainPair^>^ testData) {
+			_nativeTestDataSize = testData->Count;
+			_nativeTestData = new StandardTypesNative::TrainPair*[_nativeTestDataSize];
+			int inputSize = testData[0]->InputLength;
+			int outputSize = testData[0]->OutputLength;
+			for (int i = 0; i < _nativeTestDataSize; i++) {
+				TrainPair^ data = testData[i];
+
+				array<float>^ input = data->Input;
+				float *nativeInput = (float*)_mm_malloc(inputSize*sizeof(float), 32);
+				for (int j = 0; j < inputSize; j++) {
+					nativeInput[j] = input[j];
+				}
+
+				array<float>^ output = data->Output;
+				float *nativeOutput = (float*)_mm_malloc(outputSize*sizeof(float), 32);
+				for (int j = 0; j < outputSize; j++) {
+					nativeOutput[j] = output[j];
+				}
+
+				_nativeTestData[i] = new StandardTypesNative::TrainPair(nativeInput, nativeOutput, inputSize, outputSize);
+			}
+		}
+
+		void ClassificationTrainMethodNative::DeleteNativeNeuralNet(void) {
+			if (_nativeNeuralNet != 0) {
+				delete _nativeNeuralNet;
+				_nativeNeuralNet = 0;
+			}
+		}
+
+		void ClassificationTrainMethodNative::DeleteNativeTrainData(void) {
+			if (_nativeTrainData != 0) {
+				for (int i = 0; i < _nativeTrainDataSize; i++) {
+					_mm_free(_nativeTrainData[i]);
+				}
+				delete [] _nativeTrainData;
+				_nativeTrainData = 0;
+			}
+		}
+
+		void ClassificationTrainMethodNative::DeleteNativeTestData(void) {
+			if (_nativeTestData != 0) {
+				for (int i = 0; i < _nativeTestDataSize; i++) {
+					_mm_free(_nativeTestData[i]);
+				}
+				delete [] _nativeTestData;
+				_nativeTestData = 0;
+			}
+		}
+
+		void ClassificationTrainMethodNative::DeleteNativeGradientFunction(void) {
+			if (_nativeGradientFunction != 0) {
+				delete _nativeGradientFunction;
+				_nativeGradientFunction = 0;
+			}
+		}
+
+		void ClassificationTrainMethodNative::DeleteNativeAlgorithm(void) {
+			if (_nativeAlgorithm != 0) {
+				delete _nativeAlgorithm->IterationCompleted;
+				delete _nativeAlgorithm->IterativeProcessFinished;
+				delete _nativeAlgorithm;
+				_nativeAlgorithm = 0;
+			}
+		}
+	}
+}
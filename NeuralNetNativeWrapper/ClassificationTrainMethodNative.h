@@ -0,0 +1,47 @@
+#pragma once
+
+#include "TrainMethodNative.h"
+#include "ClassificationRbm.h"
+#include "ClassificationTrainMethod.h"
+
+using namespace NeuralNet;
+using namespace StandardTypes;
+using namespace System;
+using namespace System::Collections::Generic;
+
+namespace NeuralNetNativeWrapper {
+	namespace ClassificationRbmNativeWrapper {
+		// Trains a managed ClassificationRbm with a native ClassificationTrainMethod. The native machine keeps
+		// the input and label weights as one matrix, which is split back into the managed arrays after training.
+		public ref class ClassificationTrainMethodNative abstract : public TrainMethodNative<TrainPair^>, public System::IDisposable {
+		internal:
+			NeuralNetNative::ClassificationRbm::ClassificationTrainMethod *_nativeAlgorithm;
+			NeuralNetNative::ClassificationRbm::ClassificationRbm *_nativeNeuralNet;
+			NeuralNetNative::RestrictedBoltzmannMachine::GradientFunction *_nativeGradientFunction;
+			StandardTypesNative::TrainPair **_nativeTrainData;
+			StandardTypesNative::TrainPair **_nativeTestData;
+			int _nativeTrainDataSize;
+			int _nativeTestDataSize;
+		protected:
+			NeuralNet::ClassificationRbm::ClassificationRbm^ _classificationRbm;
+		public:
+			~ClassificationTrainMethodNative(void);
+			virtual void Start(void) override;
+			virtual void Stop(void) override;
+		protected:
+			// Without test data testData is nullptr.
+			ClassificationTrainMethodNative(IList<TrainPair^>^ trainData, IList<TrainPair^>^ testData);
+			virtual void CreateNativeNeuralNet(INeuralNet^ neuralNet) override;
+			virtual void DeleteNativeNeuralNet(void) override;
+			virtual void InitilazeNativeAlgorithm(void) override;
+			void SetNativeAlgorithm(NeuralNetNative::ClassificationRbm::ClassificationTrainMethod *nativeAlgorithm);
+			void ApplyResult(void);
+			void DeleteNativeAlgorithm(void);
+			void DeleteNativeGradientFunction(void);
+			void AllocateNativeTrainData(IList<TrainPair^>^ trainData);
+			void AllocateNativeTestData(IList<TrainPair^>^ testData);
+			void DeleteNativeTrainData(void);
+			void DeleteNativeTestData(void);
+		};
+	}
+}
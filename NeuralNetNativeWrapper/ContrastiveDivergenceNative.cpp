@@ -14,6 +14,7 @@
 #include "SqrtReverseFactor.h"
 #include "LinearGradient.h"
 #include "CenteredGradient.h"
+#include "EnhancedGradient.h"
 
 namespace NeuralNetNativeWrapper {
 	namespace RestrictedBoltzmannMachineNativeWrapper {
@@ -244,6 +245,11 @@ namespace NeuralNetNativeWrapper {
                 delete [] visibleOffsets;
                 delete [] hiddenOffsets;
 		    }
+            else if (dynamic_cast<EnhancedGradient^>(gradient) != nullptr) {
+                _nativeGradientFunction = new NeuralNetNative
+                                              ::RestrictedBoltzmannMachine
+                                              ::EnhancedGradient();
+            }
             else {
                 _nativeGradientFunction = new NeuralNetNative
                                               ::RestrictedBoltzmannMachine
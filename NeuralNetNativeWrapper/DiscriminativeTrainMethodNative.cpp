@@ -0,0 +1,17 @@
+#include "DiscriminativeTrainMethodNative.h"
+#include "DiscriminativeTrainMethod.h"
+
+namespace NeuralNetNativeWrapper {
+	namespace ClassificationRbmNativeWrapper {
+		DiscriminativeTrainMethodNative::DiscriminativeTrainMethodNative(IList<TrainPair^>^ trainData)
+			: ClassificationTrainMethodNative(trainData, nullptr) {
+			SetNativeAlgorithm(new NeuralNetNative::ClassificationRbm::DiscriminativeTrainMethod(_nativeTrainData, _nativeTrainDataSize));
+		}
+
+		DiscriminativeTrainMethodNative::DiscriminativeTrainMethodNative(IList<TrainPair^>^ trainData, IList<TrainPair^>^ testData)
+			: ClassificationTrainMethodNative(trainData, testData) {
+			SetNativeAlgorithm(new NeuralNetNative::ClassificationRbm::DiscriminativeTrainMethod(_nativeTrainData, _nativeTestData,
+				_nativeTrainDataSize, _nativeTestDataSize));
+		}
+	}
+}
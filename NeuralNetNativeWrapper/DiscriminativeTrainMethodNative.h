@@ -0,0 +1,13 @@
+#pragma once
+
+#include "ClassificationTrainMethodNative.h"
+
+namespace NeuralNetNativeWrapper {
+	namespace ClassificationRbmNativeWrapper {
+		public ref class DiscriminativeTrainMethodNative : public ClassificationTrainMethodNative {
+		public:
+			DiscriminativeTrainMethodNative(IList<TrainPair^>^ trainData);
+			DiscriminativeTrainMethodNative(IList<TrainPair^>^ trainData, IList<TrainPair^>^ testData);
+		};
+	}
+}
@@ -0,0 +1,21 @@
+#include "GenerativeTrainMethodNative.h"
+#include "GenerativeTrainMethod.h"
+#include "LinearGradient.h"
+
+namespace NeuralNetNativeWrapper {
+	namespace ClassificationRbmNativeWrapper {
+		GenerativeTrainMethodNative::GenerativeTrainMethodNative(IList<TrainPair^>^ trainData, int methodStepsCount)
+			: ClassificationTrainMethodNative(trainData, nullptr) {
+			_nativeGradientFunction = new NeuralNetNative::RestrictedBoltzmannMachine::LinearGradient();
+			SetNativeAlgorithm(new NeuralNetNative::ClassificationRbm::GenerativeTrainMethod(_nativeTrainData, _nativeTrainDataSize,
+				_nativeGradientFunction, methodStepsCount));
+		}
+
+		GenerativeTrainMethodNative::GenerativeTrainMethodNative(IList<TrainPair^>^ trainData, IList<TrainPair^>^ testData,
+			int methodStepsCount) : ClassificationTrainMethodNative(trainData, testData) {
+			_nativeGradientFunction = new NeuralNetNative::RestrictedBoltzmannMachine::LinearGradient();
+			SetNativeAlgorithm(new NeuralNetNative::ClassificationRbm::GenerativeTrainMethod(_nativeTrainData, _nativeTestData,
+				_nativeTrainDataSize, _nativeTestDataSize, _nativeGradientFunction, methodStepsCount));
+		}
+	}
+}
@@ -0,0 +1,13 @@
+#pragma once
+
+#include "ClassificationTrainMethodNative.h"
+
+namespace NeuralNetNativeWrapper {
+	namespace ClassificationRbmNativeWrapper {
+		public ref class GenerativeTrainMethodNative : public ClassificationTrainMethodNative {
+		public:
+			GenerativeTrainMethodNative(IList<TrainPair^>^ trainData, int methodStepsCount);
+			GenerativeTrainMethodNative(IList<TrainPair^>^ trainData, IList<TrainPair^>^ testData, int methodStepsCount);
+		};
+	}
+}
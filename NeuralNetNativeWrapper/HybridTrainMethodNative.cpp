@@ -0,0 +1,21 @@
+#include "HybridTrainMethodNative.h"
+#include "HybridTrainMethod.h"
+#include "LinearGradient.h"
+
+namespace NeuralNetNativeWrapper {
+	namespace ClassificationRbmNativeWrapper {
+		HybridTrainMethodNative::HybridTrainMethodNative(IList<TrainPair^>^ trainData, int methodStepsCount, float methodsMixRate)
+			: ClassificationTrainMethodNative(trainData, nullptr) {
+			_nativeGradientFunction = new NeuralNetNative::RestrictedBoltzmannMachine::LinearGradient();
+			SetNativeAlgorithm(new NeuralNetNative::ClassificationRbm::HybridTrainMethod(_nativeTrainData, _nativeTrainDataSize,
+				_nativeGradientFunction, methodStepsCount, methodsMixRate));
+		}
+
+		HybridTrainMethodNative::HybridTrainMethodNative(IList<TrainPair^>^ trainData, IList<TrainPair^>^ testData,
+			int methodStepsCount, float methodsMixRate) : ClassificationTrainMethodNative(trainData, testData) {
+			_nativeGradientFunction = new NeuralNetNative::RestrictedBoltzmannMachine::LinearGradient();
+			SetNativeAlgorithm(new NeuralNetNative::ClassificationRbm::HybridTrainMethod(_nativeTrainData, _nativeTestData,
+				_nativeTrainDataSize, _nativeTestDataSize, _nativeGradientFunction, methodStepsCount, methodsMixRate));
+		}
+	}
+}
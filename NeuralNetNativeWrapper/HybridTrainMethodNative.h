@@ -0,0 +1,14 @@
+#pragma once
+
+#include "ClassificationTrainMethodNative.h"
+
+namespace NeuralNetNativeWrapper {
+	namespace ClassificationRbmNativeWrapper {
+		public ref class HybridTrainMethodNative : public ClassificationTrainMethodNative {
+		public:
+			HybridTrainMethodNative(IList<TrainPair^>^ trainData, int methodStepsCount, float methodsMixRate);
+			HybridTrainMethodNative(IList<TrainPair^>^ trainData, IList<TrainPair^>^ testData, int methodStepsCount,
+			                        float methodsMixRate);
+		};
+	}
+}
@@ -14,6 +14,7 @@
 #include "ReverseFactor.h"
 #include "SqrtReverseFactor.h"
 #include "LinearFactor.h"
+#include "ExecutionContext.h"
 
 using namespace NeuralNet::RegularizationFunctions;
 using namespace StandardTypes::FactorStrategy;
@@ -43,6 +44,30 @@ namespace NeuralNetNativeWrapper {
 		_nativeTrainProperties->CvLimit = trainProperties->CvLimit;
         _nativeTrainProperties->SkipCvLimitFirstIterations = trainProperties->SkipCvLimitFirstIterations;
         _nativeTrainProperties->CvSlidingFactor = trainProperties->CvSlidingFactor;
+        _nativeTrainProperties->AsyncTesting = trainProperties->AsyncTesting;
+        _nativeTrainProperties->BatchTraining = trainProperties->BatchTraining;
+        _nativeTrainProperties->PersistentChainsCount = trainProperties->PersistentChainsCount;
+        _nativeTrainProperties->FreeEnergyTrainSamples = trainProperties->FreeEnergyTrainSamples;
+        _nativeTrainProperties->PackedStates = trainProperties->PackedStates;
+		switch (trainProperties->WeightsPlacement) {
+			case NeuralNet::WeightsPlacement::Interleaved:
+				_nativeTrainProperties->WeightsPlacement = NeuralNetNative::Interleaved;
+				break;
+			case NeuralNet::WeightsPlacement::PartitionedByRows:
+				_nativeTrainProperties->WeightsPlacement = NeuralNetNative::PartitionedByRows;
+				break;
+			default:
+				_nativeTrainProperties->WeightsPlacement = NeuralNetNative::LocalNode;
+				break;
+		}
+        _nativeTrainProperties->WeightReplicas = trainProperties->WeightReplicas;
+		if ((trainProperties->MaxConcurrency > 0) || (trainProperties->FirstCore >= 0) || (trainProperties->NumaNode >= 0)) {
+			_nativeTrainProperties->Context = new NeuralNetNative::ExecutionContext(trainProperties->MaxConcurrency,
+				trainProperties->FirstCore, trainProperties->NumaNode);
+		}
+		else {
+			_nativeTrainProperties->Context = 0;
+		}
 		_nativeTrainProperties->BaseLearnSpeed = trainProperties->BaseLearnSpeed;
 		_nativeTrainProperties->SpeedBonus = trainProperties->SpeedBonus;
 		_nativeTrainProperties->SpeedPenalty = trainProperties->SpeedPenalty;
@@ -126,6 +151,7 @@ namespace NeuralNetNativeWrapper {
 		if (_nativeTrainProperties != 0) {
 			delete _nativeTrainProperties->Metrics;
 			delete _nativeTrainProperties->Regularization;
+			delete _nativeTrainProperties->Context;
 			delete _nativeTrainProperties;
 			_nativeTrainProperties = 0;
 		}
@@ -16,6 +16,7 @@
 using StandardTypes;
 using StandardTypes.FactorStrategy;
 using StandardTypes.SetWeights;
+using NativeWrapper = NeuralNetNativeWrapper.ClassificationRbmNativeWrapper;
 
 namespace RbmLettersClassification {
     /// <summary>
@@ -192,7 +193,10 @@ public partial class MainWindow : Window {
 			
 			//var trainMethod = new GenerativeTrainMethod(_trainData, _testData, 1);
 			//var trainMethod = new DiscriminativeTrainMethod(_trainData, _testData);
-	        var trainMethod = new HybridTrainMethod(_trainData, _testData, 1, 0.01f);
+			//var trainMethod = new HybridTrainMethod(_trainData, _testData, 1, 0.01f);
+			//var trainMethod = new NativeWrapper.GenerativeTrainMethodNative(_trainData, _testData, 1);
+			//var trainMethod = new NativeWrapper.DiscriminativeTrainMethodNative(_trainData, _testData);
+	        var trainMethod = new NativeWrapper.HybridTrainMethodNative(_trainData, _testData, 1, 0.01f);
             trainMethod.InitilazeMethod(_neuralNet, _trainProperties);
             trainMethod.IterationCompleted += TrainingIterationCompleted;
 
@@ -0,0 +1,234 @@
+#define STANDARDTYPESAPI
+#include "ComponentStatistics.h"
+#include <tbb/tbb.h>
+#include <tbb/parallel_reduce.h>
+#include <tbb/blocked_range.h>
+#include <algorithm>
+#include <cfloat>
+
+using namespace tbb;
+
+namespace StandardTypesNative {
+	namespace {
+		// Components per task, large enough for a task to outweigh its merge.
+		const int TaskComponentsCount = 1 << 16;
+		// Components gathered at a time by AddInputs.
+		const int ChunkComponentsCount = 1 << 20;
+
+		int GetGrainSize(int length) {
+			return std::max(1, TaskComponentsCount/std::max(1, length));
+		}
+
+		class RowsStatistics {
+		private:
+			const float *_rows;
+			int _length;
+		public:
+			ComponentStatistics *Statistics;
+
+			RowsStatistics(const float *rows, int length) {
+				_rows = rows;
+				_length = length;
+				Statistics = new ComponentStatistics(length);
+			}
+
+			RowsStatistics(RowsStatistics &source, split) {
+				_rows = source._rows;
+				_length = source._length;
+				Statistics = new ComponentStatistics(_length);
+			}
+
+			~RowsStatistics(void) {
+				delete Statistics;
+			}
+
+			void operator()(const blocked_range<size_t>& r) {
+				for (size_t row = r.begin(); row < r.end(); row++) {
+					Statistics->AddVector(_rows + row*_length);
+				}
+			}
+
+			void join(const RowsStatistics &other) {
+				Statistics->Merge(*other.Statistics);
+			}
+		};
+
+		class PairsStatistics {
+		private:
+			const TrainPair *_pairs;
+			int _inputLength;
+			int _outputLength;
+		public:
+			ComponentStatistics *InputStatistics;
+			ComponentStatistics *OutputStatistics;
+
+			PairsStatistics(const TrainPair *pairs, int inputLength, int outputLength) {
+				_pairs = pairs;
+				_inputLength = inputLength;
+				_outputLength = outputLength;
+				InputStatistics = new ComponentStatistics(inputLength);
+				OutputStatistics = outputLength > 0 ? new ComponentStatistics(outputLength) : 0;
+			}
+
+			PairsStatistics(PairsStatistics &source, split) {
+				_pairs = source._pairs;
+				_inputLength = source._inputLength;
+				_outputLength = source._outputLength;
+				InputStatistics = new ComponentStatistics(_inputLength);
+				OutputStatistics = _outputLength > 0 ? new ComponentStatistics(_outputLength) : 0;
+			}
+
+			~PairsStatistics(void) {
+				delete InputStatistics;
+				delete OutputStatistics;
+			}
+
+			void operator()(const blocked_range<size_t>& r) {
+				for (size_t i = r.begin(); i < r.end(); i++) {
+					InputStatistics->AddVector(_pairs[i].Input());
+					if (OutputStatistics != 0) {
+						OutputStatistics->AddVector(_pairs[i].Output());
+					}
+				}
+			}
+
+			void join(const PairsStatistics &other) {
+				InputStatistics->Merge(*other.InputStatistics);
+				if (OutputStatistics != 0) {
+					OutputStatistics->Merge(*other.OutputStatistics);
+				}
+			}
+		};
+	}
+
+	ComponentStatistics::ComponentStatistics(int length) {
+		_length = length;
+		_mean = new double[length];
+		_squaredDeviationsSum = new double[length];
+		_min = new float[length];
+		_max = new float[length];
+		Clear();
+	}
+
+	ComponentStatistics::~ComponentStatistics(void) {
+		delete [] _mean;
+		delete [] _squaredDeviationsSum;
+		delete [] _min;
+		delete [] _max;
+	}
+
+	void ComponentStatistics::Clear(void) {
+		_count = 0;
+		std::fill(_mean, _mean + _length, 0.0);
+		std::fill(_squaredDeviationsSum, _squaredDeviationsSum + _length, 0.0);
+		std::fill(_min, _min + _length, FLT_MAX);
+		std::fill(_max, _max + _length, -FLT_MAX);
+	}
+
+	void ComponentStatistics::AddVector(const float *vector) {
+		_count++;
+		double factor = 1.0/_count;
+		for (int i = 0; i < _length; i++) {
+			double value = vector[i];
+			double delta = value - _mean[i];
+			_mean[i] += delta*factor;
+			_squaredDeviationsSum[i] += delta*(value - _mean[i]);
+		}
+		for (int i = 0; i < _length; i++) {
+			_min[i] = std::min(_min[i], vector[i]);
+			_max[i] = std::max(_max[i], vector[i]);
+		}
+	}
+
+	void ComponentStatistics::AddRows(const float *rows, int rowsCount) {
+		if (rowsCount <= GetGrainSize(_length)) {
+			for (int row = 0; row < rowsCount; row++) {
+				AddVector(rows + (size_t)row*_length);
+			}
+			return;
+		}
+		RowsStatistics body(rows, _length);
+		parallel_reduce(blocked_range<size_t>(0, rowsCount, GetGrainSize(_length)), body);
+		Merge(*body.Statistics);
+	}
+
+	void ComponentStatistics::Merge(const ComponentStatistics &other) {
+		if (other._count == 0) {
+			return;
+		}
+		long long count = _count + other._count;
+		double factor = (double)other._count/count;
+		double deviationsFactor = (double)_count*factor;
+		for (int i = 0; i < _length; i++) {
+			double delta = other._mean[i] - _mean[i];
+			_mean[i] += delta*factor;
+			_squaredDeviationsSum[i] += other._squaredDeviationsSum[i] + delta*delta*deviationsFactor;
+		}
+		for (int i = 0; i < _length; i++) {
+			_min[i] = std::min(_min[i], other._min[i]);
+			_max[i] = std::max(_max[i], other._max[i]);
+		}
+		_count = count;
+	}
+
+	void ComponentStatistics::AddPairs(const TrainPair *pairs, int pairsCount, ComponentStatistics *inputStatistics, ComponentStatistics *outputStatistics) {
+		int outputLength = outputStatistics != 0 ? outputStatistics->_length : 0;
+		PairsStatistics body(pairs, inputStatistics->_length, outputLength);
+		int grainSize = GetGrainSize(inputStatistics->_length + outputLength);
+		if (pairsCount <= grainSize) {
+			body(blocked_range<size_t>(0, pairsCount));
+		}
+		else {
+			parallel_reduce(blocked_range<size_t>(0, pairsCount, grainSize), body);
+		}
+		inputStatistics->Merge(*body.InputStatistics);
+		if (body.OutputStatistics != 0) {
+			outputStatistics->Merge(*body.OutputStatistics);
+		}
+	}
+
+	void ComponentStatistics::AddInputs(const TrainSingle *const *samples, int samplesCount, ComponentStatistics *statistics) {
+		int length = statistics->_length;
+		int chunkRowsCount = std::min(samplesCount, std::max(1, ChunkComponentsCount/std::max(1, length)));
+		if (chunkRowsCount <= 0) {
+			return;
+		}
+		float *chunk = new float[(size_t)chunkRowsCount*length];
+		for (int first = 0; first < samplesCount; first += chunkRowsCount) {
+			int rowsCount = std::min(chunkRowsCount, samplesCount - first);
+			for (int row = 0; row < rowsCount; row++) {
+				const float *input = samples[first + row]->Input();
+				std::copy(input, input + length, chunk + (size_t)row*length);
+			}
+			statistics->AddRows(chunk, rowsCount);
+		}
+		delete [] chunk;
+	}
+
+	int ComponentStatistics::GetLength(void) const {
+		return _length;
+	}
+
+	long long ComponentStatistics::GetCount(void) const {
+		return _count;
+	}
+
+	double ComponentStatistics::GetMean(int component) const {
+		return _mean[component];
+	}
+
+	double ComponentStatistics::GetVariance(int component) const {
+		if (_count < 2) {
+			return 0.0;
+		}
+		return _squaredDeviationsSum[component]/(_count - 1);
+	}
+
+	float ComponentStatistics::GetMin(int component) const {
+		return _min[component];
+	}
+
+	float ComponentStatistics::GetMax(int component) const {
+		return _max[component];
+	}
+}
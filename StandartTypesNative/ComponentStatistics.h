@@ -0,0 +1,43 @@
+#pragma once
+
+#include "ExportDll.h"
+#include "TrainSingle.h"
+#include "TrainPair.h"
+
+namespace StandardTypesNative {
+	// Per-component count, mean, sum of squared deviations, minimum and maximum of a set of vectors.
+	// Means and deviations are accumulated in double by Welford's update, and partial statistics of
+	// separate parts of the set are combined by Chan's formula, so the set may be added in any number
+	// of chunks and each chunk is split between threads.
+	class STANDARDTYPES_EXPORT ComponentStatistics {
+	private:
+		int _length;
+		long long _count;
+		double *_mean;
+		double *_squaredDeviationsSum;
+		float *_min;
+		float *_max;
+	public:
+		ComponentStatistics(int length);
+		~ComponentStatistics(void);
+		void Clear(void);
+		void AddVector(const float *vector);
+		// Adds rowsCount consecutive vectors.
+		void AddRows(const float *rows, int rowsCount);
+		void Merge(const ComponentStatistics &other);
+		// Adds the inputs and, when outputStatistics is not 0, the outputs of the pairs in one pass.
+		static void AddPairs(const TrainPair *pairs, int pairsCount, ComponentStatistics *inputStatistics, ComponentStatistics *outputStatistics);
+		// Adds the inputs of the samples, copied chunk by chunk into consecutive rows for AddRows.
+		static void AddInputs(const TrainSingle *const *samples, int samplesCount, ComponentStatistics *statistics);
+		int GetLength(void) const;
+		long long GetCount(void) const;
+		double GetMean(int component) const;
+		// Unbiased sample variance; 0 for less than two vectors.
+		double GetVariance(int component) const;
+		float GetMin(int component) const;
+		float GetMax(int component) const;
+	private:
+		ComponentStatistics(const ComponentStatistics&);
+		ComponentStatistics& operator=(const ComponentStatistics&);
+	};
+}
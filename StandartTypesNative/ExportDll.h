@@ -1,5 +1,9 @@
+#ifdef _WIN32
 #ifdef STANDARDTYPESAPI
 #define STANDARDTYPES_EXPORT __declspec(dllexport)
 #else
 #define STANDARDTYPES_EXPORT __declspec(dllimport)
+#endif
+#else
+#define STANDARDTYPES_EXPORT __attribute__((visibility("default")))
 #endif
\ No newline at end of file
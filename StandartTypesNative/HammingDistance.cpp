@@ -1,5 +1,5 @@
 #define STANDARDTYPESAPI
-#include <mathimf.h>
+#include "Platform.h"
 #include "HammingDistance.h"
 #include <cfloat>
 
@@ -2,6 +2,13 @@
 #include "ItarativeProcess.h"
 
 namespace StandardTypesNative {
+	ItarativeProcess::ItarativeProcess(void) {
+		ProcessSate = IterativeProcessState::NotStarted;
+		IterationCompleted = 0;
+		IterativeProcessFinished = 0;
+		EpochStatsCompleted = 0;
+	}
+
 	void ItarativeProcess::Start(void) {
         if ((ProcessSate == IterativeProcessState::InProgress) || (ProcessSate == IterativeProcessState::Finished)) {
             return;
@@ -28,10 +35,25 @@ namespace StandardTypesNative {
 	}
 
 	void ItarativeProcess::OnIterationCompleted(int iterationNum, float iterationValue, float addedIterationValue) {
-		IterationCompleted->Invoke(iterationNum, iterationValue, addedIterationValue);
+		if (IterationCompleted != 0) {
+			IterationCompleted->Invoke(iterationNum, iterationValue, addedIterationValue);
+		}
 	}
 
 	void ItarativeProcess::OnIterativeProcessFinished(int iterationCount) {
-		IterativeProcessFinished->Invoke(iterationCount);
+		if (IterativeProcessFinished != 0) {
+			IterativeProcessFinished->Invoke(iterationCount);
+		}
+	}
+
+	void ItarativeProcess::OnEpochStatsCompleted(void) {
+		const EpochStats &stats = Telemetry.EndEpoch();
+		if (EpochStatsCompleted != 0) {
+			EpochStatsCompleted->Invoke(stats);
+		}
+	}
+
+	const EpochStats& ItarativeProcess::GetLastEpochStats(void) const {
+		return Telemetry.GetLastEpoch();
 	}
 }
\ No newline at end of file
@@ -2,6 +2,7 @@
 
 #include "ExportDll.h"
 #include "ICallback.h"
+#include "TrainingTelemetry.h"
 
 namespace StandardTypesNative {
 	enum IterativeProcessState {
@@ -14,16 +15,21 @@ namespace StandardTypesNative {
 	class STANDARDTYPES_EXPORT ItarativeProcess {
 	protected:
 		IterativeProcessState ProcessSate;
+		TrainingTelemetry Telemetry;
 	public:
+		ItarativeProcess(void);
         void Start(void);
         virtual void Stop(void);
 		ITripleCallback *IterationCompleted;
 		ISingleCallback *IterativeProcessFinished;
+		IEpochStatsCallback *EpochStatsCompleted;
+		const EpochStats& GetLastEpochStats(void) const;
 	protected:
 		virtual void RunIterativeProcess(void) = 0;
         virtual void FirstRunInit(void);
         virtual void ApplyResults(void);
 		void OnIterationCompleted(int iterationNum, float iterationValue, float addedIterationValue);
 		void OnIterativeProcessFinished(int iterationCount);
+		void OnEpochStatsCompleted(void);
 	};
 }
\ No newline at end of file
@@ -1,5 +1,5 @@
 #define STANDARDTYPESAPI
-#include <mathimf.h>
+#include "Platform.h"
 #include "Loglikelihood.h"
 
 namespace StandardTypesNative {
@@ -1,10 +1,21 @@
 #define STANDARDTYPESAPI
 #include "MinMaxComponentAnalysis.h"
+#include "ComponentStatistics.h"
+#include <algorithm>
 
 namespace StandardTypesNative {
 	MinMaxComponentAnalysis::MinMaxComponentAnalysis(InvertibleFunction *normalizationFunction) {
 		_normalizationFunction = normalizationFunction;
+		_inputMinVector = 0;
+		_inputMaxVector = 0;
+		_inputScaleVector = 0;
+		_outputMinVector = 0;
+		_outputMaxVector = 0;
+		_inputVectorSize = 0;
+		_outputVectorSize = 0;
+		_trainingDataSize = 0;
 		_isPossibleNormalize = false;
+		_isNormalizeOutput = false;
 	}
 
 	MinMaxComponentAnalysis::~MinMaxComponentAnalysis() {
@@ -18,6 +29,15 @@ namespace StandardTypesNative {
 		_isPossibleNormalize = true;
 	}
 
+	void MinMaxComponentAnalysis::CollectInputStatistics(const TrainSingle *const *samples, int count) {
+		ClearData();
+		_trainingDataSize = count;
+		ComponentStatistics inputStatistics(samples[0]->InputLength());
+		ComponentStatistics::AddInputs(samples, count, &inputStatistics);
+		SetInputProperties(inputStatistics);
+		_isPossibleNormalize = true;
+	}
+
 	void MinMaxComponentAnalysis::NormalizeSet(TrainPair *data, bool isNormalizeOutput) {
 		_isNormalizeOutput = isNormalizeOutput;
 		if (_isPossibleNormalize) {
@@ -26,33 +46,24 @@ namespace StandardTypesNative {
 	}
 
 	void MinMaxComponentAnalysis::NormalizeInputVector(float *inputVector) {
+		CopyNormalizedInputVector(inputVector, inputVector);
+	}
+
+	void MinMaxComponentAnalysis::CopyNormalizedInputVector(const float *inputVector, float *normalizedVector) {
 		if (!_isPossibleNormalize) {
+			if (normalizedVector != inputVector) {
+				std::copy(inputVector, inputVector + _inputVectorSize, normalizedVector);
+			}
 			return;
 		}
 
-		if (_normalizationFunction != 0) {
-			for (int i = 0; i < _inputVectorSize; i++) {
-				float minValue = _inputMinVector[i];
-				float maxValue = _inputMaxVector[i];
-				float dif = maxValue - minValue;
-				if (dif == 0.0f) {
-					inputVector[i] = 0.0f;
-				}
-				else {
-					inputVector[i] = _normalizationFunction->Calculate((inputVector[i] - minValue)/dif);
-				}
-			}
+		for (int i = 0; i < _inputVectorSize; i++) {
+			normalizedVector[i] = (inputVector[i] - _inputMinVector[i])*_inputScaleVector[i];
 		}
-		else {
+		if (_normalizationFunction != 0) {
 			for (int i = 0; i < _inputVectorSize; i++) {
-				float minValue = _inputMinVector[i];
-				float maxValue = _inputMaxVector[i];
-				float dif = maxValue - minValue;
-				if (dif == 0.0f) {
-					inputVector[i] = 0.0f;
-				}
-				else {
-					inputVector[i] = (inputVector[i] - minValue)/dif;
+				if (_inputScaleVector[i] != 0.0f) {
+					normalizedVector[i] = _normalizationFunction->Calculate(normalizedVector[i]);
 				}
 			}
 		}
@@ -90,44 +101,39 @@ namespace StandardTypesNative {
 	void MinMaxComponentAnalysis::PrepareData(const TrainPair *trainingPairs, int trainingPairsCount) {
 		_trainingDataSize = trainingPairsCount;
 			
-		_inputVectorSize = trainingPairs[0].InputLength();
-		_inputMinVector = new float[_inputVectorSize];
-		_inputMaxVector = new float[_inputVectorSize];
-
 		_outputVectorSize = trainingPairs[0].OutputLength();
 		_outputMinVector = new float[_outputVectorSize];
 		_outputMaxVector = new float[_outputVectorSize];
 	}
 
 	void MinMaxComponentAnalysis::CalcProbabilisticProperties(const TrainPair *trainingPairs) {
-		for (int i = 0; i < _trainingDataSize; i++) {
-			float *inputVector = trainingPairs[i].Input();
-			for (int j = 0; j < _inputVectorSize; j++) {
-				float value = inputVector[j];
-				if (value < _inputMinVector[j]) {
-					_inputMinVector[j] = value;
-				}
-				else if (value > _inputMaxVector[j]) {
-					_inputMaxVector[j] = value;
-				}
-			}
+		ComponentStatistics inputStatistics(trainingPairs[0].InputLength());
+		ComponentStatistics outputStatistics(_outputVectorSize);
+		ComponentStatistics::AddPairs(trainingPairs, _trainingDataSize, &inputStatistics, &outputStatistics);
+
+		SetInputProperties(inputStatistics);
+		for (int i = 0; i < _outputVectorSize; i++) {
+			_outputMinVector[i] = outputStatistics.GetMin(i);
+			_outputMaxVector[i] = outputStatistics.GetMax(i);
+		}
+	}
 
-			float *outputVector = trainingPairs[i].Output();
-			for (int j = 0; j < _outputVectorSize; j++) {
-				float value = outputVector[j];
-				if (value < _outputMinVector[j]) {
-					_outputMinVector[j] = value;
-				}
-				else if (value > _outputMaxVector[j]) {
-					_outputMaxVector[j] = value;
-				}
-			}
+	void MinMaxComponentAnalysis::SetInputProperties(const ComponentStatistics &inputStatistics) {
+		_inputVectorSize = inputStatistics.GetLength();
+		_inputMinVector = new float[_inputVectorSize];
+		_inputMaxVector = new float[_inputVectorSize];
+		_inputScaleVector = new float[_inputVectorSize];
+		for (int i = 0; i < _inputVectorSize; i++) {
+			_inputMinVector[i] = inputStatistics.GetMin(i);
+			_inputMaxVector[i] = inputStatistics.GetMax(i);
+			float dif = _inputMaxVector[i] - _inputMinVector[i];
+			_inputScaleVector[i] = (dif == 0.0f) ? 0.0f : 1.0f/dif;
 		}
 	}
 
 	void MinMaxComponentAnalysis::ChangeValues(TrainPair *trainingPairs) {
 		for (int i = 0; i < _trainingDataSize; i++) {
-			DirectConversationVector(trainingPairs[i].Input(), _inputMinVector, _inputMaxVector, _inputVectorSize);
+			CopyNormalizedInputVector(trainingPairs[i].Input(), trainingPairs[i].Input());
 			if (_isNormalizeOutput) {
 				DirectConversationVector(trainingPairs[i].Output(), _outputMinVector, _outputMaxVector, _outputVectorSize);
 			}
@@ -167,11 +173,17 @@ namespace StandardTypesNative {
 		if (_inputMinVector != 0) {
 			delete [] _inputMinVector;
 			delete [] _inputMaxVector;
+			delete [] _inputScaleVector;
+			_inputMinVector = 0;
+			_inputMaxVector = 0;
+			_inputScaleVector = 0;
 			_inputVectorSize = 0;
 		}
 		if (_outputMinVector != 0) {
 			delete [] _outputMinVector;
 			delete [] _outputMaxVector;
+			_outputMinVector = 0;
+			_outputMaxVector = 0;
 			_outputVectorSize = 0;
 		}
 		_trainingDataSize = 0;
@@ -1,13 +1,20 @@
 #pragma once
 
+#include "TrainSingle.h"
 #include "TrainPair.h"
 
 namespace StandardTypesNative {
 	class NormalizeMethod {
 	public:
 		virtual void CollectStatistics(const TrainPair *data, int length) = 0;
+		// Collects the statistics of the inputs only, so that samples without outputs can be normalized;
+		// the outputs are then left as they are.
+		virtual void CollectInputStatistics(const TrainSingle *const *samples, int count) = 0;
     	virtual void NormalizeSet(TrainPair *data, bool isNormalizeOutput = true) = 0;
         virtual void NormalizeInputVector(float *inputVector) = 0;
+        // Writes the normalized input into normalizedVector and leaves inputVector as it is, so that a
+        // batch can be normalized while it is copied out of read-only data. The vectors may be the same.
+        virtual void CopyNormalizedInputVector(const float *inputVector, float *normalizedVector) = 0;
         virtual void DenormalizeOutputVector(float *outputVector) = 0;
         virtual int InputVectorSize() = 0;
 	};
@@ -0,0 +1,21 @@
+#pragma once
+
+#ifdef __INTEL_COMPILER
+#include <mathimf.h>
+#else
+#include <cmath>
+
+inline float invsqrtf(float x) {
+	return 1.0f/sqrtf(x);
+}
+
+inline int islessf(float x, float y) {
+	return std::isless(x, y);
+}
+#endif
+
+#ifdef _WIN32
+#include <malloc.h>
+#else
+#include <mm_malloc.h>
+#endif
@@ -3,9 +3,13 @@
 #include <random>
 
 namespace StandardTypesNative {
+	namespace {
+		unsigned int FixedSeed = 0;
+	}
+
 	template<typename T>
 	RandomAccessIterator<T>::RandomAccessIterator(T *list, int size) {
-		_randomDevice = new std::random_device();
+		_randomGenerator = new std::mt19937((FixedSeed != 0) ? FixedSeed : std::random_device()());
 		_uniformDistribution = new std::uniform_int_distribution<int>(0, size - 1);
 		_size = size;
 		_sourceList = list;
@@ -16,7 +20,7 @@ namespace StandardTypesNative {
 	template<typename T>
 	RandomAccessIterator<T>::~RandomAccessIterator(void) {
 		_size = 0;
-		delete _randomDevice;
+		delete _randomGenerator;
 		delete _uniformDistribution;
 		delete [] _positions;
 	}
@@ -24,7 +28,7 @@ namespace StandardTypesNative {
 	template<typename T>
 	void RandomAccessIterator<T>::RefreshRandomAccess(void) {
 		for (int i = _size - 1; i > 0; i--) {
-			int newIndex = (*_uniformDistribution)(*_randomDevice);
+			int newIndex = (*_uniformDistribution)(*_randomGenerator);
 			if (newIndex != i) {
 				int tmp = _positions[newIndex];
 				_positions[newIndex] = _positions[i];
@@ -60,4 +64,9 @@ namespace StandardTypesNative {
 	T* RandomAccessIterator<T>::Collection(void) const {
 		return _sourceList;
 	}
+
+	template<typename T>
+	void RandomAccessIterator<T>::SetSeed(unsigned int seed) {
+		FixedSeed = seed;
+	}
 }
\ No newline at end of file
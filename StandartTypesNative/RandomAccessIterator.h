@@ -12,7 +12,7 @@ namespace StandardTypesNative {
 		int _size;
 		int *_positions;
 		T *_sourceList;
-		std::random_device *_randomDevice;
+		std::mt19937 *_randomGenerator;
 		std::uniform_int_distribution<int> *_uniformDistribution;
 		int _lastRandomAccessIndex;
 	public:
@@ -22,6 +22,8 @@ namespace StandardTypesNative {
 		T& Next(void);
 		int Size(void) const;
 		T* Collection(void) const;
+		// Seeds the shuffling of iterators created afterwards; 0 seeds each one from std::random_device.
+		static void SetSeed(unsigned int seed);
 	private:
 		static int* CreateStartPositions(int size);
 	};
@@ -1,11 +1,22 @@
 #define STANDARDTYPESAPI
 #include "SigmaComponentAnalysis.h"
+#include "ComponentStatistics.h"
 #include <cmath>
+#include <algorithm>
 
 namespace StandardTypesNative {
 	SigmaComponentAnalysis::SigmaComponentAnalysis(InvertibleFunction *normalizationFunction) {
 		_normalizationFunction = normalizationFunction;
+		_inputMeanValueVector = 0;
+		_inputSigmaVector = 0;
+		_inputScaleVector = 0;
+		_outputMeanValueVector = 0;
+		_outputSigmaVector = 0;
+		_inputVectorSize = 0;
+		_outputVectorSize = 0;
+		_trainingDataSize = 0;
 		_isPossibleNormalize = false;
+		_isNormalizeOutput = false;
 	}
 
 	SigmaComponentAnalysis::~SigmaComponentAnalysis(void) {
@@ -19,6 +30,15 @@ namespace StandardTypesNative {
 		_isPossibleNormalize = true;
 	}
 
+	void SigmaComponentAnalysis::CollectInputStatistics(const TrainSingle *const *samples, int count) {
+		ClearData();
+		_trainingDataSize = count;
+		ComponentStatistics inputStatistics(samples[0]->InputLength());
+		ComponentStatistics::AddInputs(samples, count, &inputStatistics);
+		SetInputProperties(inputStatistics);
+		_isPossibleNormalize = true;
+	}
+
 	void SigmaComponentAnalysis::NormalizeSet(TrainPair *data, bool isNormalizeOutput) {
 		_isNormalizeOutput = isNormalizeOutput;
 		if (_isPossibleNormalize) {
@@ -27,29 +47,24 @@ namespace StandardTypesNative {
 	}
 
 	void SigmaComponentAnalysis::NormalizeInputVector(float *inputVector) {
+		CopyNormalizedInputVector(inputVector, inputVector);
+	}
+
+	void SigmaComponentAnalysis::CopyNormalizedInputVector(const float *inputVector, float *normalizedVector) {
 		if (!_isPossibleNormalize) {
+			if (normalizedVector != inputVector) {
+				std::copy(inputVector, inputVector + _inputVectorSize, normalizedVector);
+			}
 			return;
 		}
 
-		if (_normalizationFunction != 0) {
-			for (int i = 0; i < _inputVectorSize; i++) {
-				float sigma = _inputSigmaVector[i];
-				if (sigma == 0.0f) {
-					inputVector[i] = 0.0f;
-				}
-				else {
-					inputVector[i] = _normalizationFunction->Calculate((inputVector[i] - _inputMeanValueVector[i])/sigma);
-				}
-			}
+		for (int i = 0; i < _inputVectorSize; i++) {
+			normalizedVector[i] = (inputVector[i] - _inputMeanValueVector[i])*_inputScaleVector[i];
 		}
-		else {
+		if (_normalizationFunction != 0) {
 			for (int i = 0; i < _inputVectorSize; i++) {
-				float sigma = _inputSigmaVector[i];
-				if (sigma == 0.0f) {
-					inputVector[i] = 0.0f;
-				}
-				else {
-					inputVector[i] = (inputVector[i] - _inputMeanValueVector[i])/sigma;
+				if (_inputScaleVector[i] != 0.0f) {
+					normalizedVector[i] = _normalizationFunction->Calculate(normalizedVector[i]);
 				}
 			}
 		}
@@ -83,51 +98,38 @@ namespace StandardTypesNative {
 	void SigmaComponentAnalysis::PrepareData(const TrainPair *trainingPairs, int trainingPairsCount) {
 		_trainingDataSize = trainingPairsCount;
 			
-		_inputVectorSize = trainingPairs[0].InputLength();
-		_inputMeanValueVector = new float[_inputVectorSize];
-		_inputSigmaVector = new float[_inputVectorSize];
-
 		_outputVectorSize = trainingPairs[0].OutputLength();
 		_outputMeanValueVector = new float[_outputVectorSize];
 		_outputSigmaVector = new float[_outputVectorSize];
 	}
 
 	void SigmaComponentAnalysis::CalcProbabilisticProperties(const TrainPair *trainingPairs) {
-		for (int i = 0; i < _trainingDataSize; i++) {
-			float *inputVector = trainingPairs[i].Input();
-			for (int j = 0; j < _inputVectorSize; j++) {
-				float value = inputVector[j];
-				_inputMeanValueVector[j] += value;
-				_inputSigmaVector[j] += value*value;
-			}
+		ComponentStatistics inputStatistics(trainingPairs[0].InputLength());
+		ComponentStatistics outputStatistics(_outputVectorSize);
+		ComponentStatistics::AddPairs(trainingPairs, _trainingDataSize, &inputStatistics, &outputStatistics);
 
-			float *outputVector = trainingPairs[i].Output();
-			for (int j = 0; j < _outputVectorSize; j++) {
-				float value = outputVector[j];
-				_outputMeanValueVector[j] += value;
-				_outputSigmaVector[j] += value*value;
-			}
+		SetInputProperties(inputStatistics);
+		for (int i = 0; i < _outputVectorSize; i++) {
+			_outputMeanValueVector[i] = (float)outputStatistics.GetMean(i);
+			_outputSigmaVector[i] = (float)sqrt(outputStatistics.GetVariance(i));
 		}
+	}
 
-		float meanValueFactor = 1.0f/_trainingDataSize;
-		float sigmaFactor = _trainingDataSize/(_trainingDataSize - 1.0f);
+	void SigmaComponentAnalysis::SetInputProperties(const ComponentStatistics &inputStatistics) {
+		_inputVectorSize = inputStatistics.GetLength();
+		_inputMeanValueVector = new float[_inputVectorSize];
+		_inputSigmaVector = new float[_inputVectorSize];
+		_inputScaleVector = new float[_inputVectorSize];
 		for (int i = 0; i < _inputVectorSize; i++) {
-			_inputMeanValueVector[i] *= meanValueFactor;
-			float meanValue = _inputMeanValueVector[i];
-			float sumSqrValues = _inputSigmaVector[i];
-			_inputSigmaVector[i] = sqrt(sigmaFactor*(meanValueFactor*sumSqrValues - meanValue*meanValue));
-		}
-		for (int i = 0; i < _outputVectorSize; i++) {
-			_outputMeanValueVector[i] *= meanValueFactor;
-			float meanValue = _outputMeanValueVector[i];
-			float sumSqrValues = _outputSigmaVector[i];
-			_outputSigmaVector[i] = sqrt(sigmaFactor*(meanValueFactor*sumSqrValues - meanValue*meanValue));
+			_inputMeanValueVector[i] = (float)inputStatistics.GetMean(i);
+			_inputSigmaVector[i] = (float)sqrt(inputStatistics.GetVariance(i));
+			_inputScaleVector[i] = (_inputSigmaVector[i] == 0.0f) ? 0.0f : 1.0f/_inputSigmaVector[i];
 		}
 	}
 
 	void SigmaComponentAnalysis::ChangeValues(TrainPair *trainingPairs) {
 		for (int i = 0; i < _trainingDataSize; i++) {
-			DirectConversationVector(trainingPairs[i].Input(), _inputMeanValueVector, _inputSigmaVector, _inputVectorSize);
+			CopyNormalizedInputVector(trainingPairs[i].Input(), trainingPairs[i].Input());
 			if (_isNormalizeOutput) {
 				DirectConversationVector(trainingPairs[i].Output(), _outputMeanValueVector, _outputSigmaVector, _outputVectorSize);
 			}
@@ -163,11 +165,17 @@ namespace StandardTypesNative {
 		if (_inputMeanValueVector != 0) {
 			delete [] _inputMeanValueVector;
 			delete [] _inputSigmaVector;
+			delete [] _inputScaleVector;
+			_inputMeanValueVector = 0;
+			_inputSigmaVector = 0;
+			_inputScaleVector = 0;
 			_inputVectorSize = 0;
 		}
 		if (_outputMeanValueVector != 0) {
 			delete [] _outputMeanValueVector;
 			delete [] _outputSigmaVector;
+			_outputMeanValueVector = 0;
+			_outputSigmaVector = 0;
 			_outputVectorSize = 0;
 		}
 		_trainingDataSize = 0;
@@ -5,11 +5,15 @@
 #include "ExportDll.h"
 
 namespace StandardTypesNative {
+	class ComponentStatistics;
+
 	class STANDARDTYPES_EXPORT SigmaComponentAnalysis : public NormalizeMethod {
 	private:
 		InvertibleFunction *_normalizationFunction;
 		float *_inputMeanValueVector;
 		float *_inputSigmaVector;
+		// 1/sigma, or 0 for a constant component.
+		float *_inputScaleVector;
 		float *_outputMeanValueVector;
 		float *_outputSigmaVector;
 		int _inputVectorSize;
@@ -21,13 +25,16 @@ namespace StandardTypesNative {
 		SigmaComponentAnalysis(InvertibleFunction *normalizationFunction = 0);
 		~SigmaComponentAnalysis(void);
 		virtual void CollectStatistics(const TrainPair *data, int length);
+		virtual void CollectInputStatistics(const TrainSingle *const *samples, int count);
 		virtual void NormalizeSet(TrainPair *data, bool isNormalizeOutput);
 		virtual void NormalizeInputVector(float *inputVector);
+		virtual void CopyNormalizedInputVector(const float *inputVector, float *normalizedVector);
 		virtual void DenormalizeOutputVector(float *outputVector);
 		virtual int InputVectorSize(void);
 	private:
 		void PrepareData(const TrainPair *trainingPairs, int trainingPairsCount);
 		void CalcProbabilisticProperties(const TrainPair *trainingPairs);
+		void SetInputProperties(const ComponentStatistics &inputStatistics);
 		void ChangeValues(TrainPair *trainingPairs);
 		void DirectConversationVector(float *vector, const float *meanValueVector, const float *sigmaValueVector, int length);
 		void ClearData(void);
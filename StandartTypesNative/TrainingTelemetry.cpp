@@ -0,0 +1,96 @@
+#define STANDARDTYPESAPI
+#include "TrainingTelemetry.h"
+#include <chrono>
+#include <cstring>
+
+namespace StandardTypesNative {
+	TrainingTelemetry::TrainingTelemetry(void) {
+		memset(&_current, 0, sizeof(_current));
+		memset(&_last, 0, sizeof(_last));
+		_epochStart = 0.0;
+	}
+
+	void TrainingTelemetry::BeginEpoch(int epochNum) {
+		memset(&_current, 0, sizeof(_current));
+		_current.EpochNum = epochNum;
+		_epochStart = Now();
+	}
+
+	const EpochStats& TrainingTelemetry::EndEpoch(void) {
+		_current.Seconds = Now() - _epochStart;
+		_current.SamplesPerSecond = (_current.Seconds > 0.0) ? _current.SamplesCount/_current.Seconds : 0.0;
+		_last = _current;
+		return _last;
+	}
+
+	void TrainingTelemetry::AddTime(TrainingPhase phase, double seconds) {
+		_current.Phases[phase].Seconds += seconds;
+	}
+
+	void TrainingTelemetry::AddWork(TrainingPhase phase, double flops, double bytes) {
+		_current.Phases[phase].Flops += flops;
+		_current.Phases[phase].Bytes += bytes;
+	}
+
+	void TrainingTelemetry::AddSamples(long long samplesCount) {
+		_current.SamplesCount += samplesCount;
+	}
+
+	const EpochStats& TrainingTelemetry::GetLastEpoch(void) const {
+		return _last;
+	}
+
+	double TrainingTelemetry::Now(void) {
+		return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+	}
+
+	void TrainingTelemetry::Lap(double &seconds, double &time) {
+		double now = Now();
+		seconds += now - time;
+		time = now;
+	}
+
+	const char* TrainingTelemetry::GetPhaseName(TrainingPhase phase) {
+		static const char *names[TrainingPhasesCount] = {"shuffle", "forward", "backward", "gradient", "update", "evaluation"};
+		return names[phase];
+	}
+
+	ScopedPhaseTimer::ScopedPhaseTimer(TrainingTelemetry &telemetry, TrainingPhase phase) {
+		_telemetry = &telemetry;
+		_phase = phase;
+		_start = TrainingTelemetry::Now();
+	}
+
+	ScopedPhaseTimer::~ScopedPhaseTimer(void) {
+		_telemetry->AddTime(_phase, TrainingTelemetry::Now() - _start);
+	}
+
+	JsonLinesStatsWriter::JsonLinesStatsWriter(const char *fileName) {
+		_file = fopen(fileName, "a");
+	}
+
+	JsonLinesStatsWriter::~JsonLinesStatsWriter(void) {
+		if (_file != 0) {
+			fclose(_file);
+		}
+	}
+
+	bool JsonLinesStatsWriter::IsOpen(void) const {
+		return (_file != 0);
+	}
+
+	void JsonLinesStatsWriter::Invoke(const EpochStats &stats) {
+		if (_file == 0) {
+			return;
+		}
+		fprintf(_file, "{\"epoch\":%d,\"seconds\":%.6f,\"samples\":%lld,\"samples_per_sec\":%.3f,\"phases\":{",
+			stats.EpochNum, stats.Seconds, stats.SamplesCount, stats.SamplesPerSecond);
+		for (int phase = 0; phase < TrainingPhasesCount; phase++) {
+			const PhaseStats &phaseStats = stats.Phases[phase];
+			fprintf(_file, "%s\"%s\":{\"seconds\":%.6f,\"flops\":%.0f,\"bytes\":%.0f}", (phase > 0) ? "," : "",
+				TrainingTelemetry::GetPhaseName((TrainingPhase)phase), phaseStats.Seconds, phaseStats.Flops, phaseStats.Bytes);
+		}
+		fprintf(_file, "}}\n");
+		fflush(_file);
+	}
+}
@@ -0,0 +1,107 @@
+#pragma once
+
+#include "ExportDll.h"
+#include <cstdio>
+
+#ifndef NNETS_TELEMETRY
+#define NNETS_TELEMETRY 1
+#endif
+
+namespace StandardTypesNative {
+	enum TrainingPhase {
+		ShufflePhase,
+		ForwardPhase,
+		BackwardPhase,
+		GradientPhase,
+		UpdatePhase,
+		EvaluationPhase,
+		TrainingPhasesCount
+	};
+
+	struct PhaseStats {
+	public:
+		double Seconds;
+		double Flops;
+		double Bytes;
+	};
+
+	struct EpochStats {
+	public:
+		int EpochNum;
+		double Seconds;
+		long long SamplesCount;
+		double SamplesPerSecond;
+		PhaseStats Phases[TrainingPhasesCount];
+	};
+
+	class IEpochStatsCallback {
+	public:
+		virtual void Invoke(const EpochStats &stats) = 0;
+	};
+
+	// Accumulates per-phase time and analytic work estimates of one epoch. Not thread-safe:
+	// only the training thread reports into it.
+	class STANDARDTYPES_EXPORT TrainingTelemetry {
+	private:
+		EpochStats _current;
+		EpochStats _last;
+		double _epochStart;
+	public:
+		TrainingTelemetry(void);
+		void BeginEpoch(int epochNum);
+		const EpochStats& EndEpoch(void);
+		void AddTime(TrainingPhase phase, double seconds);
+		void AddWork(TrainingPhase phase, double flops, double bytes);
+		void AddSamples(long long samplesCount);
+		const EpochStats& GetLastEpoch(void) const;
+		static double Now(void);
+		// Adds the time elapsed since time to seconds and moves time to now, so that consecutive calls
+		// time consecutive phases of a loop without a timer object per phase.
+		static void Lap(double &seconds, double &time);
+		static const char* GetPhaseName(TrainingPhase phase);
+	};
+
+	class STANDARDTYPES_EXPORT ScopedPhaseTimer {
+	private:
+		TrainingTelemetry *_telemetry;
+		TrainingPhase _phase;
+		double _start;
+	public:
+		ScopedPhaseTimer(TrainingTelemetry &telemetry, TrainingPhase phase);
+		~ScopedPhaseTimer(void);
+	};
+
+	class STANDARDTYPES_EXPORT JsonLinesStatsWriter : public IEpochStatsCallback {
+	private:
+		FILE *_file;
+	public:
+		JsonLinesStatsWriter(const char *fileName);
+		~JsonLinesStatsWriter(void);
+		bool IsOpen(void) const;
+		virtual void Invoke(const EpochStats &stats);
+	};
+}
+
+#define TELEMETRY_CONCAT_IMPL(a, b) a##b
+#define TELEMETRY_CONCAT(a, b) TELEMETRY_CONCAT_IMPL(a, b)
+
+#if NNETS_TELEMETRY
+#define TELEMETRY_SCOPE(telemetry, phase) \
+	StandardTypesNative::ScopedPhaseTimer TELEMETRY_CONCAT(phaseTimer, __LINE__)(telemetry, phase)
+#define TELEMETRY_TIME(telemetry, phase, seconds) (telemetry).AddTime(phase, seconds)
+#define TELEMETRY_WORK(telemetry, phase, flops, bytes) (telemetry).AddWork(phase, flops, bytes)
+#define TELEMETRY_SAMPLES(telemetry, samplesCount) (telemetry).AddSamples(samplesCount)
+#define TELEMETRY_BEGIN_EPOCH(telemetry, epochNum) (telemetry).BeginEpoch(epochNum)
+#define TELEMETRY_END_EPOCH() OnEpochStatsCompleted()
+#define TELEMETRY_NOW() StandardTypesNative::TrainingTelemetry::Now()
+#define TELEMETRY_LAP(seconds, time) StandardTypesNative::TrainingTelemetry::Lap(seconds, time)
+#else
+#define TELEMETRY_SCOPE(telemetry, phase) ((void)0)
+#define TELEMETRY_TIME(telemetry, phase, seconds) ((void)0)
+#define TELEMETRY_WORK(telemetry, phase, flops, bytes) ((void)0)
+#define TELEMETRY_SAMPLES(telemetry, samplesCount) ((void)0)
+#define TELEMETRY_BEGIN_EPOCH(telemetry, epochNum) ((void)0)
+#define TELEMETRY_END_EPOCH() ((void)0)
+#define TELEMETRY_NOW() 0.0
+#define TELEMETRY_LAP(seconds, time) ((void)(seconds), (void)(time))
+#endif